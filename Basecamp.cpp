@@ -4,23 +4,169 @@
    Licensed under GPLv3. See LICENSE for details.
    */
 
+#include <algorithm>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include <iomanip>
 #include "Basecamp.hpp"
 #include "debug.hpp"
+#include "reconnectPolicy.hpp"
+#ifndef BASECAMP_NOWEB
+#include "DefaultInterface.hpp"
+#endif
 
 namespace {
-	const constexpr uint16_t defaultThreadStackSize = 3072;
-	const constexpr UBaseType_t defaultThreadPriority = 0;
 	// Default length for access point mode password
 	const constexpr unsigned defaultApSecretLength = 8;
+	// Worker of beginAsync(), building the web interface needs some stack
+	const constexpr TaskSettings beginTaskSettings{6144, 1, tskNO_AFFINITY};
+#ifdef BASECAMP_USEDNS
+	const constexpr TaskSettings dnsTaskSettings{4096, 5, 0};
+#endif
+	// Set in Basecamp::readyEvents_ once begin() or beginAsync() have finished
+	const constexpr EventBits_t readyBit = BIT0;
+
+	// Configuration needed by beginFastWake(), kept in RTC memory by begin()
+	const ConfigurationKey fastWakeConfigurationKeys[] {
+		ConfigurationKey::deviceName,
+		ConfigurationKey::wifiConfigured,
+		ConfigurationKey::wifiEssid,
+		ConfigurationKey::wifiPassword,
+		ConfigurationKey::wifiEssid2,
+		ConfigurationKey::wifiPassword2,
+		ConfigurationKey::wifiEssid3,
+		ConfigurationKey::wifiPassword3,
+		ConfigurationKey::wifiEssid4,
+		ConfigurationKey::wifiPassword4,
+		ConfigurationKey::mqttActive,
+		ConfigurationKey::mqttHost,
+		ConfigurationKey::mqttPort,
+		ConfigurationKey::mqttUser,
+		ConfigurationKey::mqttPass,
+		ConfigurationKey::mqttAckTimeout,
+		ConfigurationKey::mqttPersistentSession,
+		ConfigurationKey::reconnectBaseDelay,
+		ConfigurationKey::reconnectMaxDelay,
+		ConfigurationKey::reconnectMultiplier,
+		ConfigurationKey::reconnectStablePeriod,
+		ConfigurationKey::bootCounterWifiReset,
+		ConfigurationKey::bootCounterFactoryReset,
+		ConfigurationKey::taskCore,
+		ConfigurationKey::wakeReportInterval,
+	};
+	// Unsuccessful boots after which the WiFi configuration is reset
+	const constexpr unsigned defaultWifiResetThreshold = 3;
+	// Unsuccessful boots without WiFi configuration after which SPIFFS is formatted
+	const constexpr unsigned defaultFactoryResetThreshold = 2;
+	// Wakes after which the wake timeline statistics are published
+	const constexpr unsigned defaultWakeReportInterval = 10;
+	// Time in ms a published packet may wait for its acknowledgement if MQTTAckTimeout is not set
+	const constexpr uint32_t defaultMqttAckTimeout = 10000;
+#ifndef BASECAMP_NOOTA
+	UpdateProgressPrinter otaProgress;
+#endif
+#ifndef BASECAMP_NOMQTT
+	// Filters of the persistent MQTT session, see MqttDispatcher::resumeSession(). Kept over deep sleep.
+	RTC_DATA_ATTR uint32_t rtcMqttSessionDigest;
+#endif
+
+	// Reads the reconnect backoff from the configuration, unset or invalid values keep their defaults
+	ReconnectPolicy::Settings getReconnectSettings(const Configuration &configuration)
+	{
+		ReconnectPolicy::Settings settings;
+		const auto getPositive = [&configuration](ConfigurationKey key, uint32_t defaultValue) -> uint32_t {
+			const long value = configuration.get(key).toInt();
+			return (value > 0) ? static_cast<uint32_t>(value) : defaultValue;
+		};
+		settings.baseDelay = getPositive(ConfigurationKey::reconnectBaseDelay, settings.baseDelay);
+		settings.maxDelay = getPositive(ConfigurationKey::reconnectMaxDelay, settings.maxDelay);
+		settings.stablePeriod = getPositive(ConfigurationKey::reconnectStablePeriod, settings.stablePeriod);
+		const float multiplier = configuration.get(ConfigurationKey::reconnectMultiplier).toFloat();
+		if (multiplier >= 1.0f) {
+			settings.multiplier = multiplier;
+		}
+		return settings;
+	}
 }
 
+WakeTimeline Basecamp::wakeTimeline;
+
 Basecamp::Basecamp(SetupModeWifiEncryption setupModeWifiEncryption, ConfigurationUI configurationUi)
-	: MqttGuardInterface(mqtt)
-	, configuration(String{"/basecamp.json"})
+	:
+#ifndef BASECAMP_NOMQTT
+	MqttGuardInterface(mqtt),
+#endif
+	configuration(String{"/basecamp.json"})
+#ifndef BASECAMP_NOMQTT
+	, mqttDispatcher(mqtt)
+#endif
 	, setupModeWifiEncryption_(setupModeWifiEncryption)
 	, configurationUi_(configurationUi)
 {
+	registerComponents();
+}
+
+void Basecamp::registerComponents()
+{
+	// Components for subsystems owned by Basecamp itself, "this" outlives the registry
+	const auto makeFactory = [](std::function<bool()> start, std::function<void()> stop) {
+		return [start, stop]() {
+			return std::unique_ptr<Component>(new FunctionComponent(start, stop));
+		};
+	};
+#ifndef BASECAMP_NOWIFI
+	const std::vector<String> needsNetwork{"wifi"};
+
+	components.add("wifi", makeFactory([this]() {
+		beginWifi();
+		return true;
+	}, [this]() {
+		wifi.end();
+	}));
+#else
+	// The network is brought up by the application
+	const std::vector<String> needsNetwork;
+#endif
+#ifndef BASECAMP_NOMQTT
+	components.add("mqtt", makeFactory([this]() {
+		beginMqtt();
+		return true;
+	}, [this]() {
+		endMqtt();
+	}), needsNetwork);
+	// Health records every TelemetryInterval seconds to stat/<hostname>/telemetry
+	components.add("telemetry", [this]() {
+		const uint32_t interval = configuration.get(ConfigurationKey::telemetryInterval).toInt();
+		return std::unique_ptr<Component>(new Telemetry(*this, mqtt, tasks, eventBus,
+			"stat/" + hostname + "/telemetry", interval * 1000));
+	}, {"mqtt"});
+#endif
+#ifndef BASECAMP_NOOTA
+	components.add("ota", makeFactory([this]() {
+		beginOta();
+		return true;
+	}, [this]() {
+		endOta();
+	}), needsNetwork);
+#endif
+#ifndef BASECAMP_NOWEB
+	components.add("web", makeFactory([this]() {
+		beginWeb();
+		return true;
+	}, [this]() {
+		web.end();
+	}), needsNetwork);
+#ifdef BASECAMP_USEDNS
+#ifdef DNSServer_h
+	// Captive portal, answers every DNS request with the address of the access point
+	components.add("dns", makeFactory([this]() {
+		return beginDns();
+	}, [this]() {
+		endDns();
+	}), {"web"});
+#endif
+#endif
+#endif
 }
 
 /**
@@ -76,6 +222,83 @@ String Basecamp::getSetupModeWifiSecret(){
  */
 bool Basecamp::begin(String fixedWiFiApEncryptionPassword)
 {
+	if (!beginConnectivity(std::move(fixedWiFiApEncryptionPassword))) {
+		return false;
+	}
+	beginServices();
+	setReady();
+
+	// TODO: only return true if everything setup up correctly
+	return true;
+}
+
+/**
+ * Like begin(), but returns as soon as WiFi association and MQTT have been started.
+ * OTA and the web interface are set up by a worker task in the meantime.
+ */
+bool Basecamp::beginAsync(ReadyCallback onReady, String fixedWiFiApEncryptionPassword)
+{
+	readyCallback_ = std::move(onReady);
+	if (readyEvents_ == nullptr) {
+		readyEvents_ = xEventGroupCreate();
+	}
+
+	if (!beginConnectivity(std::move(fixedWiFiApEncryptionPassword))) {
+		return false;
+	}
+
+	if (tasks.spawn("BasecampBegin", &beginServicesTask, this, beginTaskSettings) == nullptr) {
+		// No worker, finish on the calling task instead
+		DEBUG_PRINTLN("Could not start the begin task, continuing synchronously.");
+		beginServices();
+		setReady();
+	}
+	return true;
+}
+
+bool Basecamp::isReady() const
+{
+	return ready_;
+}
+
+bool Basecamp::waitUntilReady(uint32_t timeoutMs)
+{
+	if (ready_ || readyEvents_ == nullptr) {
+		return ready_;
+	}
+
+	const TickType_t timeout = (timeoutMs == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+	return (xEventGroupWaitBits(readyEvents_, readyBit, pdFALSE, pdTRUE, timeout) & readyBit) != 0;
+}
+
+void Basecamp::beginServicesTask(void *basecamp)
+{
+	auto &self = *static_cast<Basecamp *>(basecamp);
+	self.beginServices();
+	self.setReady();
+	self.tasks.finish();
+	vTaskDelete(nullptr);
+}
+
+void Basecamp::setReady()
+{
+	ready_ = true;
+	if (readyEvents_ != nullptr) {
+		xEventGroupSetBits(readyEvents_, readyBit);
+	}
+	if (readyCallback_) {
+		readyCallback_();
+	}
+}
+
+// Everything needed to get online: configuration, WiFi and MQTT
+bool Basecamp::beginConnectivity(String fixedWiFiApEncryptionPassword)
+{
+	wakeTimeline.start();
+#ifdef BASECAMP_PROFILE_BOOT
+	bootProfiler.start();
+#endif
+
 	// Make sure we only accept valid passwords for ap
 	if (fixedWiFiApEncryptionPassword.length() != 0) {
 		if (fixedWiFiApEncryptionPassword.length() >= wifi.getMinimumSecretLength()) {
@@ -90,6 +313,7 @@ bool Basecamp::begin(String fixedWiFiApEncryptionPassword)
 	// Display a simple lifesign
 	Serial.println("");
 	Serial.println("Basecamp Startup");
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::serial);
 
 	// Load configuration from internal flash storage.
 	// If configuration.load() fails, reset the configuration
@@ -102,10 +326,18 @@ bool Basecamp::begin(String fixedWiFiApEncryptionPassword)
 	// It is used as a hostname for DHCP and ArduinoOTA.
 	hostname = _cleanHostname();
 	DEBUG_PRINTLN(hostname);
+#ifndef BASECAMP_NOMQTT
+	mqttTopics.setHostname(hostname.c_str());
+#endif
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::configuration);
 
 	// Have checkResetReason() control if the device configuration
 	// should be reset or not.
 	checkResetReason();
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::resetReason);
+
+	startEventBus();
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::eventBus);
 
 #ifndef BASECAMP_NOWIFI
 
@@ -127,6 +359,128 @@ bool Basecamp::begin(String fixedWiFiApEncryptionPassword)
 	}
 
 	DEBUG_PRINTF("Secret: %s\n", configuration.get(ConfigurationKey::accessPointSecret).c_str());
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::apSecret);
+
+	components.start("wifi");
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::wifi);
+#endif
+#ifndef BASECAMP_NOMQTT
+	// Check if MQTT has been disabled by the user
+	if (!configuration.get(ConfigurationKey::mqttActive).equalsIgnoreCase("false")) {
+		components.start("mqtt");
+	}
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::mqtt);
+#endif
+
+	// Allows the next wake from deep sleep to skip parsing the configuration, see beginFastWake()
+	if (configuration.get(ConfigurationKey::wifiConfigured).equalsIgnoreCase("true")) {
+		std::list<String> snapshotKeys(fastWakeKeys_.begin(), fastWakeKeys_.end());
+		for (const auto &key : fastWakeConfigurationKeys) {
+			snapshotKeys.push_back(getKeyName(key));
+		}
+		configuration.storeSnapshot(snapshotKeys);
+	}
+
+	return true;
+}
+
+/**
+ * Minimal startup after a wake from deep sleep: restores the configuration from the RTC snapshot
+ * taken by the last full begin(), connects WiFi with the cached access point and lease and
+ * connects MQTT as soon as there is an IP. No web interface, OTA or DNS.
+ * Falls back to begin() if there is no valid snapshot (e.g. after a power cycle).
+ */
+bool Basecamp::beginFastWake()
+{
+	if (rtc_get_reset_reason(0) != DEEPSLEEP_RESET || !configuration.loadSnapshot()) {
+		return begin();
+	}
+
+	wakeTimeline.start();
+#ifdef BASECAMP_PROFILE_BOOT
+	bootProfiler.start();
+#endif
+	Serial.begin(115200);
+	Serial.println("");
+	Serial.println("Basecamp fast wake");
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::serial);
+
+	hostname = _cleanHostname();
+#ifndef BASECAMP_NOMQTT
+	mqttTopics.setHostname(hostname.c_str());
+#endif
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::configuration);
+
+	checkResetReason();
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::resetReason);
+
+	startEventBus();
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::eventBus);
+
+#ifndef BASECAMP_NOWIFI
+	components.start("wifi");
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::wifi);
+#endif
+#ifndef BASECAMP_NOMQTT
+	if (!configuration.get(ConfigurationKey::mqttActive).equalsIgnoreCase("false")) {
+		// No time to lose, the callbacks have been registered before
+		mqttConnectOnIp_ = true;
+		components.start("mqtt");
+	}
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::mqtt);
+#endif
+
+	setReady();
+	return true;
+}
+
+void Basecamp::addFastWakeConfigurationKey(const String &key)
+{
+	fastWakeKeys_.push_back(key);
+}
+
+void Basecamp::startEventBus()
+{
+	// The first task of Basecamp, from here on tasks are created as configured
+	tasks.configure(configuration);
+	// Deliver events from WiFi, MQTT, OTA and the web server
+	eventBus.begin(tasks);
+	// Getting an IP counts as a successful boot, reset the counter of checkResetReason().
+	// Done once per connection by the dispatcher, not for every WiFi event.
+	eventBus.subscribe(SystemEventType::wifiGotIp, [this](const SystemEvent &) {
+		bootCounter_.clear();
+	});
+	// The timestamps of the events are taken when they happen, not when they are delivered
+	const std::pair<SystemEventType, WakePhase> timelineEvents[] {
+		{SystemEventType::wifiConnected, WakePhase::wifiConnected},
+		{SystemEventType::wifiGotIp, WakePhase::gotIp},
+		{SystemEventType::mqttConnected, WakePhase::mqttConnected},
+	};
+	for (const auto &event : timelineEvents) {
+		const WakePhase phase = event.second;
+		eventBus.subscribe(event.first, [phase](const SystemEvent &systemEvent) {
+			wakeTimeline.mark(phase, systemEvent.timestamp);
+		});
+	}
+}
+
+#ifndef BASECAMP_NOWIFI
+void Basecamp::beginWifi()
+{
+	// Further known networks are tried if the primary one is not in range
+	const std::pair<ConfigurationKey, ConfigurationKey> additionalNetworks[] {
+		{ConfigurationKey::wifiEssid2, ConfigurationKey::wifiPassword2},
+		{ConfigurationKey::wifiEssid3, ConfigurationKey::wifiPassword3},
+		{ConfigurationKey::wifiEssid4, ConfigurationKey::wifiPassword4},
+	};
+	for (const auto &network : additionalNetworks) {
+		if (configuration.isKeySet(network.first)) {
+			wifi.addNetwork(configuration.get(network.first), configuration.get(network.second));
+		}
+	}
+
+	wifi.setReconnectPolicy(getReconnectSettings(configuration));
+	wifi.setEventBus(eventBus);
 
 	// Initialize Wifi with the stored configuration data.
 	wifi.begin(
@@ -139,197 +493,387 @@ bool Basecamp::begin(String fixedWiFiApEncryptionPassword)
 
 	// Get WiFi MAC
 	mac = wifi.getSoftwareMacAddress(":");
+}
 #endif
+
 #ifndef BASECAMP_NOMQTT
-	// Check if MQTT has been disabled by the user
-	if (!configuration.get(ConfigurationKey::mqttActive).equalsIgnoreCase("false")) {
-		// Setting up variables for the MQTT client. This is necessary due to
-		// the nature of the library. It won't work properly with Arduino Strings.
-		const auto &mqtthost = configuration.get(ConfigurationKey::mqttHost);
-		const auto &mqttuser = configuration.get(ConfigurationKey::mqttUser);
-		const auto &mqttpass = configuration.get(ConfigurationKey::mqttPass);
-		// INFO: that library just copies the pointer to the hostname. As long as nobody
-		// modifies the config, this may work.
-		mqtt.setClientId(hostname.c_str());
-		auto mqttport = configuration.get(ConfigurationKey::mqttPort).toInt();
-		if (mqttport == 0) mqttport = 1883;
-		// INFO: that library just copies the pointer to the hostname. As long as nobody
-		// modifies the config, this may work.
-		// Define the hostname and port of the MQTT broker.
-		mqtt.setServer(mqtthost.c_str(), mqttport);
-		// If MQTT credentials are stored, set them.
-		if (mqttuser.length() != 0) {
-			mqtt.setCredentials(mqttuser.c_str(), mqttpass.c_str());
-		};
-		// Create a timer and register a "onDisconnect" callback function that manages the (re)connection of the MQTT client
-		// It will be called by the Asyc-MQTT-Client KeepAlive function if a connection loss is detected
-		// The timer is then started and will start a function to reconnect MQTT after 2 seconds 
-		mqttReconnectTimer = xTimerCreate("mqttTimer", pdMS_TO_TICKS(2000), pdFALSE, (void*)&mqtt, reinterpret_cast<TimerCallbackFunction_t>(connectToMqtt));
+void Basecamp::beginMqtt()
+{
+	// Setting up variables for the MQTT client. This is necessary due to
+	// the nature of the library. It won't work properly with Arduino Strings.
+	const auto &mqtthost = configuration.get(ConfigurationKey::mqttHost);
+	const auto &mqttuser = configuration.get(ConfigurationKey::mqttUser);
+	const auto &mqttpass = configuration.get(ConfigurationKey::mqttPass);
+	// INFO: that library just copies the pointer to the hostname. As long as nobody
+	// modifies the config, this may work.
+	mqtt.setClientId(hostname.c_str());
+	auto mqttport = configuration.get(ConfigurationKey::mqttPort).toInt();
+	if (mqttport == 0) mqttport = 1883;
+	// INFO: that library just copies the pointer to the hostname. As long as nobody
+	// modifies the config, this may work.
+	// Define the hostname and port of the MQTT broker.
+	mqtt.setServer(mqtthost.c_str(), mqttport);
+	// The client id is the hostname, so the broker finds the session again after a wake
+	if (configuration.get(ConfigurationKey::mqttPersistentSession).equalsIgnoreCase("true")) {
+		mqtt.setCleanSession(false);
+		// Resumed sessions still have all subscriptions, only subscribe again if the filters changed
+		mqttDispatcher.resumeSession(rtcMqttSessionDigest, [](uint32_t digest) {
+			rtcMqttSessionDigest = digest;
+		});
+	} else {
+		mqtt.setCleanSession(true);
+		rtcMqttSessionDigest = 0;
+	}
+	// If MQTT credentials are stored, set them.
+	if (mqttuser.length() != 0) {
+		mqtt.setCredentials(mqttuser.c_str(), mqttpass.c_str());
+	};
+	// Create a timer and register a "onDisconnect" callback function that manages the (re)connection of the MQTT client
+	// It will be called by the Asyc-MQTT-Client KeepAlive function if a connection loss is detected
+	// The timer is then restarted with a growing, randomized delay given by mqttReconnectPolicy
+	mqttReconnectPolicy.setSettings(getReconnectSettings(configuration));
+	// Lost acknowledgements must not keep mqttAllSent() or a batch callback waiting forever
+	const long ackTimeout = configuration.isKeySet(ConfigurationKey::mqttAckTimeout) ?
+		configuration.get(ConfigurationKey::mqttAckTimeout).toInt() : defaultMqttAckTimeout;
+	if (ackTimeout > 0) {
+		mqttSetAckDeadline(ackTimeout, [](uint16_t packetId, uint32_t /*waited*/) {
+			DEBUG_PRINTF("MQTT packet %u has not been acknowledged in time\n", packetId);
+		});
+		// Checked by a timer, so deadlines are kept even if the sketch never calls handle(). The timer
+		// only posts an event, the check and the callbacks it causes run on the dispatcher task.
+		// A quarter of the deadline, but at least every 100 ms and at most every second.
+		if (mqttDeadlineTimer_ == nullptr) {
+			const uint32_t checkInterval = std::min<uint32_t>(std::max<uint32_t>(ackTimeout / 4, 100), 1000);
+			mqttDeadlineTimer_ = xTimerCreate("mqttDeadline", pdMS_TO_TICKS(checkInterval), pdTRUE, this, onMqttDeadlineTimer);
+		}
+		if (mqttDeadlineSubscription_ == 0) {
+			mqttDeadlineSubscription_ = eventBus.subscribe(SystemEventType::mqttDeadlineCheck, [this](const SystemEvent &) {
+				mqttDeadlineCheckPending_ = false;
+				// Timed out batches call their callbacks from here
+				mqttCheckTimeouts();
+			});
+		}
+		if (mqttDeadlineTimer_ != nullptr) {
+			xTimerStart(mqttDeadlineTimer_, 0);
+		}
+	}
+	mqttReconnectTimer = xTimerCreate("mqttTimer", pdMS_TO_TICKS(2000), pdFALSE, (void*)&mqtt, reinterpret_cast<TimerCallbackFunction_t>(connectToMqtt));
+	// The client keeps its callbacks, only register them for the first start
+	if (!mqttCallbacksRegistered_) {
+		mqttCallbacksRegistered_ = true;
 		mqtt.onDisconnect(onMqttDisconnect);
+		mqttOnSent([](uint16_t /*packetId*/) {
+			wakeTimeline.mark(WakePhase::firstPublish);
+		});
+		mqttOnPublish([](uint16_t /*packetId*/) {
+			wakeTimeline.mark(WakePhase::lastAck);
+		});
+		mqtt.onDisconnect([this](AsyncMqttClientDisconnectReason reason) {
+			eventBus.post(SystemEventType::mqttDisconnected, static_cast<int32_t>(reason));
+		});
+		// A connection that lasts long enough resets the backoff
+		mqtt.onConnect([this](bool sessionPresent) {
+			mqttReconnectPolicy.connected(millis());
+			eventBus.post(SystemEventType::mqttConnected, sessionPresent ? 1 : 0);
+#ifdef BASECAMP_PROFILE_BOOT
+			// Once per boot, retained so it can be fetched at any time
+			if (!bootProfilePublished_) {
+				bootProfilePublished_ = true;
+				const String topic = "stat/" + hostname + "/bootprofile";
+				const String profile = bootProfiler.toJson();
+				mqtt.publish(topic.c_str(), 0, true, profile.c_str());
+			}
+#endif
+			// Past the client of MqttGuardInterface, so it does not count as the first publish
+			const unsigned reportInterval = configuration.isKeySet(ConfigurationKey::wakeReportInterval) ?
+				configuration.get(ConfigurationKey::wakeReportInterval).toInt() : defaultWakeReportInterval;
+			if (reportInterval != 0 && wakeTimeline.getWakes() >= reportInterval) {
+				const String topic = "stat/" + hostname + "/waketimeline";
+				const String report = wakeTimeline.toJson();
+				if (mqtt.publish(topic.c_str(), 0, true, report.c_str()) != 0) {
+					wakeTimeline.resetStatistics();
+				}
+			}
+		});
+	}
+	if (mqttConnectOnIp_) {
+		mqttConnectSubscription_ = eventBus.subscribe(SystemEventType::wifiGotIp, [this](const SystemEvent &) {
+			wakeTimeline.mark(WakePhase::mqttConnecting);
+			mqtt.connect();
+		});
+	} else {
 		// Do not connect MQTT directly but only start the timer to give the main setup() time to register all MQTT callbacks before 
 		// Especially a "onConnect" callback should be in place to get informed about a successful MQTT connection
 		// setup() can optionally call mqtt.connect() by itself if MQTT is needed before timer elapses
 		xTimerStart(mqttReconnectTimer, 0);
-	};
+	}
+}
+
+void Basecamp::endMqtt()
+{
+	if (mqttConnectSubscription_ != 0) {
+		eventBus.unsubscribe(mqttConnectSubscription_);
+		mqttConnectSubscription_ = 0;
+	}
+	if (mqttDeadlineTimer_ != nullptr) {
+		xTimerStop(mqttDeadlineTimer_, 0);
+	}
+	if (mqttDeadlineSubscription_ != 0) {
+		eventBus.unsubscribe(mqttDeadlineSubscription_);
+		mqttDeadlineSubscription_ = 0;
+	}
+	// Without a timer onMqttDisconnect() does not schedule a reconnect
+	if (mqttReconnectTimer != nullptr) {
+		TimerHandle_t timer = mqttReconnectTimer;
+		mqttReconnectTimer = nullptr;
+		xTimerDelete(timer, 0);
+	}
+	mqtt.disconnect(true);
+}
 #endif
 
+// Services not needed for the connection itself: OTA and the web interface
+void Basecamp::beginServices()
+{
 #ifndef BASECAMP_NOOTA
 	// Set up Over-the-Air-Updates (OTA) if it hasn't been disabled.
 	if (!configuration.get(ConfigurationKey::otaActive).equalsIgnoreCase("false")) {
+		components.start("ota");
+	}
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::ota);
+#endif
 
-		// Set OTA password
-		String otaPass = configuration.get(ConfigurationKey::otaPass);
-		if (otaPass.length() != 0) {
-			ArduinoOTA.setPassword(otaPass.c_str());
-		}
-
-		// Set OTA hostname
-		ArduinoOTA.setHostname(hostname.c_str());
-
-		// The following code is copied verbatim from the ESP32 BasicOTA.ino example
-		// This is the callback for the beginning of the OTA process
-		ArduinoOTA
-			.onStart([]() {
-					String type;
-					if (ArduinoOTA.getCommand() == U_FLASH)
-					type = "sketch";
-					else // U_SPIFFS
-					type = "filesystem";
-					SPIFFS.end();
-
-					Serial.println("Start updating " + type);
-					})
-		// When the update ends print it to serial
-		.onEnd([]() {
-				Serial.println("\nEnd");
-				})
-		// Show the progress of the update
-		.onProgress([](unsigned int progress, unsigned int total) {
-				Serial.printf("Progress: %u%%\r", (progress / (total / 100)));
-				})
-		// Error handling for the update
-		.onError([](ota_error_t error) {
-				Serial.printf("Error[%u]: ", error);
-				if (error == OTA_AUTH_ERROR) Serial.println("Auth Failed");
-				else if (error == OTA_BEGIN_ERROR) Serial.println("Begin Failed");
-				else if (error == OTA_CONNECT_ERROR) Serial.println("Connect Failed");
-				else if (error == OTA_RECEIVE_ERROR) Serial.println("Receive Failed");
-				else if (error == OTA_END_ERROR) Serial.println("End Failed");
-				});
-
-		// Start the OTA service
-		ArduinoOTA.begin();
-
+#ifndef BASECAMP_NOMQTT
+	// Only along with MQTT, starting it would start MQTT as well
+	if (configuration.get(ConfigurationKey::telemetryInterval).toInt() > 0 && components.isRunning("mqtt")) {
+		components.start("telemetry");
 	}
 #endif
 
 #ifndef BASECAMP_NOWEB
 	if (shouldEnableConfigWebserver())
 	{
-		// Add a webinterface element for the h1 that contains the device name. It is a child of the #wrapper-element.
-		web.addInterfaceElement("heading", "h1", "","#wrapper");
-		web.setInterfaceElementAttribute("heading", "class", "fat-border");
-		web.addInterfaceElement("logo", "img", "", "#heading");
-		web.setInterfaceElementAttribute("logo", "src", "/logo.svg");
-		String DeviceName = configuration.get(ConfigurationKey::deviceName);
-		if (DeviceName == "") {
-			DeviceName = "Unconfigured Basecamp Device";
-		}
-		web.addInterfaceElement("title", "title", DeviceName,"head");
-		web.addInterfaceElement("devicename", "span", DeviceName,"#heading");
-		// Set the class attribute of the element to fat-border.
-		web.setInterfaceElementAttribute("heading", "class", "fat-border");
-		// Add a paragraph with some basic information
-		web.addInterfaceElement("infotext1", "p", "Configure your device with the following options:","#wrapper");
-
-		// Add the configuration form, that will include all inputs for config data
-		web.addInterfaceElement("configform", "form", "","#wrapper");
-		web.setInterfaceElementAttribute("configform", "action", "#");
-		web.setInterfaceElementAttribute("configform", "onsubmit", "collectConfiguration()");
-
-		web.addInterfaceElement("DeviceName", "input", "Device name","#configform" , "DeviceName");
-
-		// Add an input field for the WIFI data and link it to the corresponding configuration data
-		web.addInterfaceElement("WifiEssid", "input", "WIFI SSID:","#configform" , "WifiEssid");
-		web.addInterfaceElement("WifiPassword", "input", "WIFI Password:", "#configform", "WifiPassword");
-		web.setInterfaceElementAttribute("WifiPassword", "type", "password");
-		web.addInterfaceElement("WifiConfigured", "input", "", "#configform", "WifiConfigured");
-		web.setInterfaceElementAttribute("WifiConfigured", "type", "hidden");
-		web.setInterfaceElementAttribute("WifiConfigured", "value", "true");
-
-		// Add input fields for MQTT configurations if it hasn't been disabled
-		if (!configuration.get(ConfigurationKey::mqttActive).equalsIgnoreCase("false")) {
-			web.addInterfaceElement("MQTTHost", "input", "MQTT Host:","#configform" , "MQTTHost");
-			web.addInterfaceElement("MQTTPort", "input", "MQTT Port:","#configform" , "MQTTPort");
-			web.setInterfaceElementAttribute("MQTTPort", "type", "number");
-			web.setInterfaceElementAttribute("MQTTPort", "min", "0");
-			web.setInterfaceElementAttribute("MQTTPort", "max", "65535");
-			web.addInterfaceElement("MQTTUser", "input", "MQTT Username:","#configform" , "MQTTUser");
-			web.addInterfaceElement("MQTTPass", "input", "MQTT Password:","#configform" , "MQTTPass");
-			web.setInterfaceElementAttribute("MQTTPass", "type", "password");
-		}
-		// Add a save button that calls the JavaScript function collectConfiguration() on click
-		web.addInterfaceElement("saveform", "button", "Save","#configform");
-		web.setInterfaceElementAttribute("saveform", "type", "submit");
-
-		// Show the devices MAC in the Webinterface
-		String infotext2 = "This device has the MAC-Address: " + mac;
-		web.addInterfaceElement("infotext2", "p", infotext2,"#wrapper");
-
-		web.addInterfaceElement("footer", "footer", "Powered by ", "body");
-		web.addInterfaceElement("footerlink", "a", "Basecamp", "footer");
-		web.setInterfaceElementAttribute("footerlink", "href", "https://github.com/merlinschumacher/Basecamp");
-		web.setInterfaceElementAttribute("footerlink", "target", "_blank");
-		#ifdef BASECAMP_USEDNS
-		#ifdef DNSServer_h
+		components.start("web");
+		BASECAMP_BOOT_STAGE(bootProfiler, BootStage::webServer);
+#ifdef BASECAMP_USEDNS
+#ifdef DNSServer_h
+		// The captive portal is only needed to configure the WiFi
 		if (!configuration.get(ConfigurationKey::wifiConfigured).equalsIgnoreCase("true")) {
-			dnsServer.start(53, "*", wifi.getSoftAPIP());
-			xTaskCreatePinnedToCore(&DnsHandling, "DNSTask", 4096, (void*) &dnsServer, 5, NULL,0);
+			components.start("dns");
 		}
-		#endif
-		#endif
-		// Start webserver and pass the configuration object to it
-		// Also pass a Lambda-function that restarts the device after the configuration has been saved.
-		web.begin(configuration, [](){
-			delay(2000);
-			ESP.restart();
-		});
+#endif
+#endif
 	}
-	#endif
+#endif
 	Serial.println(showSystemInfo());
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::systemInfo);
+}
 
-	// TODO: only return true if everything setup up correctly
+#ifndef BASECAMP_NOOTA
+void Basecamp::beginOta()
+{
+	// Set OTA password
+	String otaPass = configuration.get(ConfigurationKey::otaPass);
+	if (otaPass.length() != 0) {
+		ArduinoOTA.setPassword(otaPass.c_str());
+	}
+
+	// Set OTA hostname
+	ArduinoOTA.setHostname(hostname.c_str());
+
+	// The following code is based on the ESP32 BasicOTA.ino example.
+	// ArduinoOTA writes the received image straight into the Update class, so compressed
+	// images are only supported by the web server's /update endpoint.
+	// This is the callback for the beginning of the OTA process
+	ArduinoOTA
+		.onStart([this]() {
+				String type;
+				if (ArduinoOTA.getCommand() == U_FLASH)
+				type = "sketch";
+				else // U_SPIFFS
+				type = "filesystem";
+				SPIFFS.end();
+
+				Serial.println("Start updating " + type);
+				otaProgress.start();
+				eventBus.post(SystemEventType::otaStarted);
+				})
+	// When the update ends print it to serial
+	.onEnd([this]() {
+			otaProgress.finish();
+			Serial.println("End");
+			eventBus.post(SystemEventType::otaFinished);
+			})
+	// Show the progress of the update with bytes and transfer rate
+	.onProgress([](unsigned int progress, unsigned int total) {
+			otaProgress.print(progress, total);
+			})
+	// Error handling for the update
+	.onError([this](ota_error_t error) {
+			eventBus.post(SystemEventType::otaFailed, error);
+			Serial.printf("Error[%u]: ", error);
+			if (error == OTA_AUTH_ERROR) Serial.println("Auth Failed");
+			else if (error == OTA_BEGIN_ERROR) Serial.println("Begin Failed");
+			else if (error == OTA_CONNECT_ERROR) Serial.println("Connect Failed");
+			else if (error == OTA_RECEIVE_ERROR) Serial.println("Receive Failed");
+			else if (error == OTA_END_ERROR) Serial.println("End Failed");
+			});
+
+	// Start the OTA service
+	ArduinoOTA.begin();
+	otaActive_ = true;
+}
+
+void Basecamp::endOta()
+{
+	otaActive_ = false;
+	ArduinoOTA.end();
+}
+#endif
+
+#ifndef BASECAMP_NOWEB
+void Basecamp::beginWeb()
+{
+	// The static parts of the interface are served from flash (see DefaultInterface.hpp),
+	// only the elements depending on runtime data are built here.
+	web.addInterfaceElements(defaultInterface::heading);
+	String DeviceName = configuration.get(ConfigurationKey::deviceName);
+	if (DeviceName == "") {
+		DeviceName = "Unconfigured Basecamp Device";
+	}
+	web.addInterfaceElement("title", "title", DeviceName,"head");
+	web.addInterfaceElement("devicename", "span", DeviceName,"#heading");
+
+	// Add the configuration form, that will include all inputs for config data
+	web.addInterfaceElements(defaultInterface::configForm);
+
+	web.addInterfaceElements(defaultInterface::networkSettings);
+
+	// Add input fields for MQTT configurations if it hasn't been disabled
+	if (!configuration.get(ConfigurationKey::mqttActive).equalsIgnoreCase("false")) {
+		web.addInterfaceElements(defaultInterface::mqttSettings);
+	}
+	web.addInterfaceElements(defaultInterface::saveButton);
+
+	// Show the devices MAC in the Webinterface
+	String infotext2 = "This device has the MAC-Address: " + mac;
+	web.addInterfaceElement("infotext2", "p", infotext2,"#wrapper");
+
+	web.addInterfaceElements(defaultInterface::footer);
+	BASECAMP_BOOT_STAGE(bootProfiler, BootStage::interface);
+	web.setEventBus(eventBus);
+	// Start webserver and pass the configuration object to it
+	// Also pass a Lambda-function that restarts the device after the configuration has been saved.
+	web.begin(configuration, [](){
+		delay(2000);
+		ESP.restart();
+	});
+#ifdef BASECAMP_PROFILE_BOOT
+	web.getServer()->on("/profile.json", HTTP_GET, [this](AsyncWebServerRequest *request)
+	{
+			request->send(200, "application/json", bootProfiler.toJson());
+	});
+#endif
+}
+
+#ifdef BASECAMP_USEDNS
+#ifdef DNSServer_h
+bool Basecamp::beginDns()
+{
+	// Owned by the task from now on, it deletes the server when it is stopped
+	auto *dnsServer = new DNSServer();
+	dnsServer->start(53, "*", wifi.getSoftAPIP());
+	dnsTask_ = tasks.spawn("DNSTask", &DnsHandling, (void*) dnsServer, dnsTaskSettings);
+	if (dnsTask_ == nullptr) {
+		dnsServer->stop();
+		delete dnsServer;
+		return false;
+	}
 	return true;
 }
 
+void Basecamp::endDns()
+{
+	if (dnsTask_ != nullptr) {
+		// The task only ends after the notification, so its handle is still valid
+		tasks.finish(dnsTask_);
+		xTaskNotifyGive(dnsTask_);
+		dnsTask_ = nullptr;
+	}
+}
+#endif
+#endif
+#endif
+
+void Basecamp::stopProvisioning()
+{
+	// "dns" depends on "web" and is stopped along with it
+	components.stop("web");
+}
+
 /**
  * This is the background task function for the Basecamp class. To be called from Arduino loop.
  */
 void Basecamp::handle (void)
 {
 	#ifndef BASECAMP_NOOTA
-		// This call takes care of the ArduinoOTA function provided by Basecamp
-		ArduinoOTA.handle();
+		// This call takes care of the ArduinoOTA function provided by Basecamp.
+		// OTA may still be set up by beginAsync() or be skipped by beginFastWake().
+		if (otaActive_) {
+			ArduinoOTA.handle();
+		}
+	#endif
+	#ifndef BASECAMP_NOMQTT
+		// Drop packets whose acknowledgement did not arrive within MQTTAckTimeout. The timer
+		// started by beginMqtt() does this as well, calling it here only makes it more timely.
+		mqttCheckTimeouts();
+		// Send messages queued while disconnected, see mqttSetOfflineQueue()
+		mqttReplayOfflineQueue();
+		// Send chunks of streams the TCP window had no space for
+		mqttContinueStreams();
 	#endif
 }
 
 
-#ifndef BASECAMP_NOMQTT
-
 bool Basecamp::shouldEnableConfigWebserver() const
 {
+#ifndef BASECAMP_NOWIFI
 	return (configurationUi_ == ConfigurationUI::always ||
 	   (configurationUi_ == ConfigurationUI::accessPoint && wifi.getOperationMode() == WifiControl::Mode::accessPoint));
+#else
+	return (configurationUi_ == ConfigurationUI::always);
+#endif
 }
 
-// This is a task that is called if MQTT client has lost connection. After 2 seconds it automatically trys to reconnect.
+#ifndef BASECAMP_NOMQTT
+
+// This is a task that is called if MQTT client has lost connection. After a delay given by the
+// reconnect policy it automatically trys to reconnect.
 
-TimerHandle_t Basecamp::mqttReconnectTimer;
+TimerHandle_t Basecamp::mqttReconnectTimer = nullptr;
+ReconnectPolicy Basecamp::mqttReconnectPolicy{ReconnectPolicy::Settings{}, esp_random};
   
 void Basecamp::onMqttDisconnect(AsyncMqttClientDisconnectReason reason) 
 {
   Serial.print("MQTT Disconnected. Reason: "); Serial.println((int)reason, DEC); 
-  xTimerStart(mqttReconnectTimer, 0);
+  // Stopped on purpose, see endMqtt()
+  if (mqttReconnectTimer == nullptr) {
+    return;
+  }
+  const uint32_t retryDelay = mqttReconnectPolicy.nextDelay(millis());
+  DEBUG_PRINTF("Next MQTT connection attempt in %u ms\n", retryDelay);
+  // Changing the period also starts the timer, a period of 0 ticks is not allowed
+  xTimerChangePeriod(mqttReconnectTimer, std::max<TickType_t>(pdMS_TO_TICKS(retryDelay), 1), 0);
+}
+
+void Basecamp::onMqttDeadlineTimer(TimerHandle_t timer)
+{
+  auto *basecamp = static_cast<Basecamp *>(pvTimerGetTimerID(timer));
+  // One check queued at a time, a full queue is retried by the next tick
+  if (!basecamp->mqttDeadlineCheckPending_.exchange(true) &&
+      !basecamp->eventBus.post(SystemEventType::mqttDeadlineCheck)) {
+    basecamp->mqttDeadlineCheckPending_ = false;
+  }
 }
 
 void Basecamp::connectToMqtt(TimerHandle_t xTimer) 
@@ -338,6 +882,7 @@ void Basecamp::connectToMqtt(TimerHandle_t xTimer)
 
   if (WiFi.status() == WL_CONNECTED) {
     Serial.println("Trying to connect ...");
+    wakeTimeline.mark(WakePhase::mqttConnecting);
     mqtt->connect();    // has no effect if already connected ( if (_connected) return;) 
   }
   else {
@@ -350,89 +895,100 @@ void Basecamp::connectToMqtt(TimerHandle_t xTimer)
 
 #ifdef BASECAMP_USEDNS
 #ifdef DNSServer_h
-// This is a task that handles DNS requests from clients
+// This is a task that handles DNS requests from clients until it is notified by endDns()
 void Basecamp::DnsHandling(void * dnsServerPointer)
 {
 		DNSServer * dnsServer = (DNSServer *) dnsServerPointer;
-		while(1) {
+		while (ulTaskNotifyTake(pdTRUE, 1000) == 0) {
 			// handle each request
 			dnsServer->processNextRequest();
-			vTaskDelay(1000);
 		}
+		dnsServer->stop();
+		delete dnsServer;
+		vTaskDelete(nullptr);
 };
 #endif
 #endif
 
 // This function checks the reset reason returned by the ESP and resets the configuration if neccessary.
 // It counts all system reboots that occured by power cycles or button resets.
-// If the ESP32 receives an IP the boot counts as successful and the counter will be reset by Basecamps
-// WiFi management.
+// If the ESP32 receives an IP the boot counts as successful and the counter will be reset by the
+// wifiGotIp subscriber registered in begin().
+// The counter lives in RTC memory, NVS is only written if a counted boot has to survive a power cycle.
 void Basecamp::checkResetReason()
 {
-	// Instead of the internal flash it uses the somewhat limited, but sufficient preferences storage
-	preferences.begin("basecamp", false);
 	// Get the reset reason for the current boot
 	int reason = rtc_get_reset_reason(0);
 	DEBUG_PRINT("Reset reason: ");
 	DEBUG_PRINTLN(reason);
-	// If the reason is caused by a power cycle (1) or a RTC reset / button press(16) evaluate the current
-	// bootcount and act accordingly.
-	if (reason == 1 || reason == 16) {
-		// Get the current number of unsuccessful boots stored
-		unsigned int bootCounter = preferences.getUInt("bootcounter", 0);
-		// increment it
-		bootCounter++;
-		DEBUG_PRINT("Unsuccessful boots: ");
-		DEBUG_PRINTLN(bootCounter);
-
-		// If the counter is bigger than 3 it will be the fifths consecutive unsucessful reboot.
-		// This forces a reset of the WiFi configuration and the AP will be opened again
-		if (bootCounter > 3){
-			DEBUG_PRINTLN("Configuration forcibly reset.");
-			// Mark the WiFi configuration as invalid
-			configuration.set(ConfigurationKey::wifiConfigured, "False");
-			// Save the configuration immediately
-			configuration.save();
-			// Reset the boot counter
-			preferences.putUInt("bootcounter", 0);
-			// Call the destructor for preferences so that all data is safely stored befor rebooting
-			preferences.end();
-			Serial.println("Resetting the WiFi configuration.");
-			// Reboot
-			ESP.restart();
-
-			// If the WiFi is unconfigured and the device is rebooted twice format the internal flash storage
-		} else if (bootCounter > 2 && configuration.get(ConfigurationKey::wifiConfigured).equalsIgnoreCase("false")) {
-			Serial.println("Factory reset was forced.");
-			// Format the flash storage
-			SPIFFS.format();
-			// Reset the boot counter
-			preferences.putUInt("bootcounter", 0);
-			// Call the destructor for preferences so that all data is safely stored befor rebooting
-			preferences.end();
-			Serial.println("Rebooting.");
-			// Reboot
-			ESP.restart();
-
-		// In every other case: store the current boot count
-		} else {
-			preferences.putUInt("bootcounter", bootCounter);
-		};
+	// If the reason is caused by a power cycle (1) or a RTC reset / button press(16) the boot is counted,
+	// for any other reason the counter is reset.
+	const unsigned bootCounter = bootCounter_.countBoot(reason);
+	if (bootCounter == 0) {
+		return;
+	}
+	DEBUG_PRINT("Unsuccessful boots: ");
+	DEBUG_PRINTLN(bootCounter);
 
-	// if the reset has been for any other cause, reset the counter
-	} else {
-		preferences.putUInt("bootcounter", 0);
+	// A threshold of 0 disables the respective reset
+	const auto getThreshold = [this](ConfigurationKey key, unsigned defaultValue) -> unsigned {
+		return configuration.isKeySet(key) ? configuration.get(key).toInt() : defaultValue;
+	};
+	const unsigned wifiResetThreshold = getThreshold(ConfigurationKey::bootCounterWifiReset, defaultWifiResetThreshold);
+	const unsigned factoryResetThreshold = getThreshold(ConfigurationKey::bootCounterFactoryReset, defaultFactoryResetThreshold);
+
+	// By default more than 3 consecutive unsucessful reboots force a reset of the WiFi configuration
+	// and the AP will be opened again
+	if (wifiResetThreshold != 0 && bootCounter > wifiResetThreshold) {
+		DEBUG_PRINTLN("Configuration forcibly reset.");
+		// Mark the WiFi configuration as invalid
+		configuration.set(ConfigurationKey::wifiConfigured, "False");
+		// Save the configuration immediately
+		configuration.save();
+		// Reset the boot counter
+		bootCounter_.clear();
+		Serial.println("Resetting the WiFi configuration.");
+		// Reboot
+		ESP.restart();
+
+		// If the WiFi is unconfigured and the device is rebooted twice format the internal flash storage
+	} else if (factoryResetThreshold != 0 && bootCounter > factoryResetThreshold &&
+		configuration.get(ConfigurationKey::wifiConfigured).equalsIgnoreCase("false")) {
+		Serial.println("Factory reset was forced.");
+		// Format the flash storage
+		SPIFFS.format();
+		// Reset the boot counter
+		bootCounter_.clear();
+		Serial.println("Rebooting.");
+		// Reboot
+		ESP.restart();
 	};
-	// Call the destructor for preferences so that all data is safely stored
-	preferences.end();
 };
 
-// This shows basic information about the system. Currently only the mac
-// TODO: expand infos
+// This shows basic information about the system: addresses, uptime, heap, connection and stack usage
 String Basecamp::showSystemInfo() {
 	std::ostringstream info;
 	info << "MAC-Address: " << mac.c_str();
 	info << ", Hardware MAC: " << wifi.getHardwareMacAddress(":").c_str() << std::endl;
+	info << "Uptime: " << esp_timer_get_time() / 1000000 << " s, reset reason " << rtc_get_reset_reason(0) << std::endl;
+	info << "Heap: " << ESP.getFreeHeap() << " free, " << ESP.getMinFreeHeap() << " lowest, "
+		<< heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) << " largest block" << std::endl;
+#ifndef BASECAMP_NOWIFI
+	if (WiFi.status() == WL_CONNECTED) {
+		info << "RSSI: " << WiFi.RSSI() << " dBm" << std::endl;
+	}
+#endif
+#ifndef BASECAMP_NOMQTT
+	const auto statistics = mqttStatistics();
+	info << "MQTT packets: " << statistics.acknowledged << " acknowledged, " << statistics.timeouts
+		<< " timed out, " << mqttRemainingPackets() << " pending, " << mqttQueuedMessages() << " queued" << std::endl;
+#endif
+
+#ifdef BASECAMP_PROFILE_BOOT
+	info << bootProfiler.toString().c_str();
+#endif
+	info << wakeTimeline.toString().c_str();
+	info << tasks.toString().c_str();
 
 	if (configuration.isKeySet(ConfigurationKey::accessPointSecret)) {
 			info << "*******************************************" << std::endl;
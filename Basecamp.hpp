@@ -7,9 +7,19 @@
 #ifndef Basecamp_h
 #define Basecamp_h
 #include "debug.hpp"
+#include "BootCounter.hpp"
+#include "BootProfiler.hpp"
+#include "ComponentRegistry.hpp"
 #include "Configuration.hpp"
+#include "EventBus.hpp"
+#include "TaskManager.hpp"
+#include "WakeTimeline.hpp"
 #include <Preferences.h>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <rom/rtc.h>
+#include "freertos/event_groups.h"
 
 #ifndef BASECAMP_NOWIFI
 #include "WifiControl.hpp"
@@ -25,12 +35,17 @@
 
 #ifndef BASECAMP_NOMQTT
 #include <AsyncMqttClient.h>
+#include "mqttDispatcher.hpp"
 #include "mqttGuardInterface.hpp"
+#include "mqttTopics.hpp"
+#include "reconnectPolicy.hpp"
+#include "Telemetry.hpp"
 #include "freertos/timers.h"
 #endif
 
 #ifndef BASECAMP_NOOTA
 #include <ArduinoOTA.h>
+#include "FirmwareUpdate.hpp"
 #endif
 
 class Basecamp
@@ -61,6 +76,26 @@ class Basecamp
 
 		Configuration configuration;
 		Preferences preferences;
+		// WiFi, MQTT, OTA and web server events. Subscribe to it at any time, it is started by begin().
+		EventBus eventBus;
+		// Creates the tasks of Basecamp with the core, priority and stack size from the configuration
+		// and tracks their stack usage
+		TaskManager tasks;
+		// The subsystems "wifi", "mqtt", "ota", "web" and "dns", started by begin() as configured.
+		// Each one is set up when it is started and torn down when it is stopped, components
+		// depending on a stopped one are stopped before it.
+		ComponentRegistry components;
+
+#ifdef BASECAMP_PROFILE_BOOT
+		// Duration and heap usage of the stages of begin(), also served as /profile.json and
+		// published to stat/<hostname>/bootprofile
+		BootProfiler bootProfiler;
+#endif
+
+		// Time from reset to each phase of getting online, for this and the previous wakes, kept in
+		// RTC memory. Ship it with your data or let it be published to stat/<hostname>/waketimeline
+		// every WakeReportInterval wakes.
+		static WakeTimeline wakeTimeline;
 
 		/** Initialize.
 		 * Give a fixex ap secret here to override the one-time secret
@@ -68,6 +103,32 @@ class Basecamp
 		 * SetupModeWifiEncryption will be overriden to SetupModeWifiEncryption::secure.
 		*/
 		bool begin(String fixedWiFiApEncryptionPassword = {});
+
+		using ReadyCallback = std::function<void()>;
+		/** Initialize without waiting for everything.
+		 * Returns as soon as WiFi association and the MQTT connection have been started, so
+		 * setup() can continue (e.g. read sensors) while OTA and the web interface are set up
+		 * by a worker task. "onReady" is called from that task once begin() would have returned.
+		 * Do not change the web interface before isReady() returns true.
+		*/
+		bool beginAsync(ReadyCallback onReady = {}, String fixedWiFiApEncryptionPassword = {});
+		/** Initialize after a wake from deep sleep, e.g. to publish a few messages.
+		 * Restores the configuration from a snapshot in RTC memory taken by the last begin(),
+		 * skips the web interface, OTA and DNS, connects WiFi with the cached access point and
+		 * IP lease and connects MQTT as soon as there is an IP. Register the MQTT callbacks
+		 * before calling it. Falls back to begin() if there is no valid snapshot.
+		 * Telemetry is not started, see Telemetry.
+		*/
+		bool beginFastWake();
+		// Include an application specific configuration key in the snapshot for beginFastWake()
+		void addFastWakeConfigurationKey(const String &key);
+		// True once begin() or beginAsync() have finished completely
+		bool isReady() const;
+		// Blocks until isReady() or the timeout has passed. Returns isReady().
+		bool waitUntilReady(uint32_t timeoutMs = UINT32_MAX);
+		// Stops the web interface and the captive portal DNS server to reclaim their heap,
+		// e.g. once the device has been configured and only talks MQTT
+		void stopProvisioning();
 		void handle();
 
 		void checkResetReason();
@@ -84,7 +145,14 @@ class Basecamp
 
 #ifndef BASECAMP_NOMQTT
     AsyncMqttClient mqtt;
+    // Calls handlers by topic filter (with + and #) with reassembled payloads and subscribes
+    // the filters again on every connect. Use it instead of mqtt.onMessage() and mqtt.subscribe().
+    MqttDispatcher mqttDispatcher;
+    // Topics like "stat/{hostname}/status", expanded once the hostname is known
+    MqttTopicRegistry mqttTopics;
     static TimerHandle_t mqttReconnectTimer;
+    // Delay of the reconnect timer after a lost connection
+    static ReconnectPolicy mqttReconnectPolicy;
     static void onMqttDisconnect(AsyncMqttClientDisconnectReason reason); 
     static void connectToMqtt(TimerHandle_t xTimer); 
 #endif
@@ -93,7 +161,6 @@ class Basecamp
 
 #ifdef BASECAMP_USEDNS
 #ifdef DNSServer_h
-    DNSServer dnsServer;
 		static void DnsHandling(void *);
 #endif
 #endif
@@ -101,9 +168,69 @@ class Basecamp
 #endif
 
 	private:
+		// Adds the built-in subsystems to "components"
+		void registerComponents();
+		bool beginConnectivity(String fixedWiFiApEncryptionPassword);
+		void startEventBus();
+#ifndef BASECAMP_NOWIFI
+		void beginWifi();
+#endif
+#ifndef BASECAMP_NOMQTT
+		void beginMqtt();
+		void endMqtt();
+		// Hands the check for packets past MQTTAckTimeout to the dispatcher of eventBus, periodically
+		// called by mqttDeadlineTimer_. Batch callbacks may block or sleep, so they never run on the timer task.
+		static void onMqttDeadlineTimer(TimerHandle_t timer);
+#endif
+#ifndef BASECAMP_NOOTA
+		void beginOta();
+		void endOta();
+#endif
+#ifndef BASECAMP_NOWEB
+		void beginWeb();
+#ifdef BASECAMP_USEDNS
+#ifdef DNSServer_h
+		bool beginDns();
+		void endDns();
+#endif
+#endif
+#endif
+		void beginServices();
+		static void beginServicesTask(void *basecamp);
+		void setReady();
+
 		String _cleanHostname();
 		bool shouldEnableConfigWebserver() const;
 
+		BootCounter bootCounter_;
+		ReadyCallback readyCallback_;
+		EventGroupHandle_t readyEvents_ = nullptr;
+		// Set by the BasecampBegin task of beginAsync(), read by the application
+		std::atomic<bool> ready_{false};
+		// Set after ArduinoOTA.begin() has finished, so handle() sees the complete OTA state
+		std::atomic<bool> otaActive_{false};
+#ifndef BASECAMP_NOMQTT
+		// Connect right after getting an IP instead of waiting for the reconnect timer
+		bool mqttConnectOnIp_ = false;
+		bool mqttCallbacksRegistered_ = false;
+		TimerHandle_t mqttDeadlineTimer_ = nullptr;
+		// Set while a mqttDeadlineCheck event is queued, so a busy dispatcher does not pile them up
+		std::atomic<bool> mqttDeadlineCheckPending_{false};
+		EventBus::SubscriptionId mqttDeadlineSubscription_ = 0;
+		EventBus::SubscriptionId mqttConnectSubscription_ = 0;
+#endif
+#ifndef BASECAMP_NOWEB
+#ifdef BASECAMP_USEDNS
+#ifdef DNSServer_h
+		std::unique_ptr<DNSServer> dnsServer_;
+		TaskHandle_t dnsTask_ = nullptr;
+#endif
+#endif
+#endif
+		std::vector<String> fastWakeKeys_;
+#ifdef BASECAMP_PROFILE_BOOT
+		bool bootProfilePublished_ = false;
+#endif
 		SetupModeWifiEncryption setupModeWifiEncryption_;
 		ConfigurationUI configurationUi_;
 };
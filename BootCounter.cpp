@@ -0,0 +1,95 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#include "BootCounter.hpp"
+
+#include <Preferences.h>
+#include <cstddef>
+#include <rom/crc.h>
+#include <rom/rtc.h>
+
+namespace {
+	// Marks a valid counter ("BCBC")
+	const constexpr uint32_t bootCounterMagic = 0x42434243;
+	const constexpr char *bootCounterKey = "bootcounter";
+
+	struct RtcBootCounter {
+		uint32_t magic;
+		uint32_t count;
+		// CRC of everything above
+		uint32_t crc;
+	};
+
+	// Not initialized on boot, so it keeps its value over resets as well as deep sleep
+	RTC_NOINIT_ATTR RtcBootCounter rtcBootCounter;
+
+	uint32_t counterCrc(const RtcBootCounter &counter)
+	{
+		return crc32_le(0, reinterpret_cast<const uint8_t *>(&counter), offsetof(RtcBootCounter, crc));
+	}
+
+	bool isValid(const RtcBootCounter &counter)
+	{
+		return (counter.magic == bootCounterMagic && counter.crc == counterCrc(counter));
+	}
+
+	// Returns the counter from RTC memory or, after a power cycle, from NVS
+	unsigned load()
+	{
+		if (isValid(rtcBootCounter)) {
+			return rtcBootCounter.count;
+		}
+
+		Preferences preferences;
+		preferences.begin("basecamp", true);
+		const unsigned count = preferences.getUInt(bootCounterKey, 0);
+		preferences.end();
+		return count;
+	}
+}
+
+unsigned BootCounter::countBoot(int resetReason)
+{
+	const unsigned count = load();
+
+	// Power cycle (POWERON_RESET) or reset button (RTCWDT_RTC_RESET)
+	if (resetReason == POWERON_RESET || resetReason == RTCWDT_RTC_RESET) {
+		// The next boot may be a power cycle again, so this one has to be persisted
+		store(count + 1, true);
+	} else if (count != 0) {
+		store(0, true);
+	} else {
+		store(0, false);
+	}
+
+	return get();
+}
+
+void BootCounter::clear()
+{
+	if (get() != 0) {
+		store(0, true);
+	}
+}
+
+unsigned BootCounter::get() const
+{
+	return isValid(rtcBootCounter) ? rtcBootCounter.count : 0;
+}
+
+void BootCounter::store(unsigned count, bool persist)
+{
+	rtcBootCounter.magic = bootCounterMagic;
+	rtcBootCounter.count = count;
+	rtcBootCounter.crc = counterCrc(rtcBootCounter);
+
+	if (persist) {
+		Preferences preferences;
+		preferences.begin("basecamp", false);
+		preferences.putUInt(bootCounterKey, count);
+		preferences.end();
+	}
+}
@@ -0,0 +1,33 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#ifndef BootCounter_h
+#define BootCounter_h
+
+#include <Arduino.h>
+
+/**
+	Counts consecutive unsuccessful boots caused by power cycles or resets.
+	The counter is kept in RTC memory, which survives resets and deep sleep. It is mirrored to
+	NVS only for counted boots, as those have to survive a power cycle, and when a non-zero counter
+	is cleared. Deep sleep wakes and successful boots with a zero counter never touch NVS.
+*/
+class BootCounter {
+	public:
+		// Counts the current boot if "resetReason" (rtc_get_reset_reason()) is a power cycle or a
+		// reset, clears the counter for any other reason. Returns the current count.
+		unsigned countBoot(int resetReason);
+
+		// Marks the current boot as successful
+		void clear();
+
+		unsigned get() const;
+
+	private:
+		void store(unsigned count, bool persist);
+};
+
+#endif
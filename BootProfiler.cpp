@@ -0,0 +1,102 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#include "BootProfiler.hpp"
+
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <sstream>
+
+const constexpr size_t BootProfiler::maxEntries;
+
+void BootProfiler::start()
+{
+	count_ = 0;
+	last_ = 0;
+	mark(BootStage::beforeBegin);
+}
+
+void BootProfiler::mark(BootStage stage)
+{
+	const int64_t now = esp_timer_get_time();
+	if (count_ < maxEntries) {
+		entries_[count_++] = BootProfileEntry{
+			stage,
+			static_cast<uint32_t>(now - last_),
+			ESP.getFreeHeap(),
+			static_cast<uint32_t>(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT)),
+		};
+	}
+	last_ = now;
+}
+
+uint32_t BootProfiler::getBeginDurationUs() const
+{
+	uint32_t total = 0;
+	for (size_t i = 0; i < count_; i++) {
+		if (entries_[i].stage != BootStage::beforeBegin) {
+			total += entries_[i].durationUs;
+		}
+	}
+	return total;
+}
+
+String BootProfiler::toJson() const
+{
+	std::ostringstream json;
+	json << "{\"total\":" << getBeginDurationUs() << ",\"stages\":[";
+	for (size_t i = 0; i < count_; i++) {
+		const auto &entry = entries_[i];
+		json << ((i == 0) ? "" : ",")
+			<< "{\"stage\":\"" << getStageName(entry.stage) << "\",\"us\":" << entry.durationUs
+			<< ",\"heap\":" << entry.freeHeap << ",\"block\":" << entry.largestFreeBlock << "}";
+	}
+	json << "]}";
+	return {json.str().c_str()};
+}
+
+String BootProfiler::toString() const
+{
+	std::ostringstream text;
+	text << "Boot profile (begin() took " << getBeginDurationUs() / 1000 << " ms):" << std::endl;
+	for (size_t i = 0; i < count_; i++) {
+		const auto &entry = entries_[i];
+		text << "  " << getStageName(entry.stage) << ": " << entry.durationUs << " us, heap "
+			<< entry.freeHeap << " (largest block " << entry.largestFreeBlock << ")" << std::endl;
+	}
+	return {text.str().c_str()};
+}
+
+const char* BootProfiler::getStageName(BootStage stage)
+{
+	switch (stage) {
+		case BootStage::beforeBegin:
+			return "beforeBegin";
+		case BootStage::serial:
+			return "serial";
+		case BootStage::configuration:
+			return "configuration";
+		case BootStage::resetReason:
+			return "resetReason";
+		case BootStage::eventBus:
+			return "eventBus";
+		case BootStage::apSecret:
+			return "apSecret";
+		case BootStage::wifi:
+			return "wifi";
+		case BootStage::mqtt:
+			return "mqtt";
+		case BootStage::ota:
+			return "ota";
+		case BootStage::interface:
+			return "interface";
+		case BootStage::webServer:
+			return "webServer";
+		case BootStage::systemInfo:
+			return "systemInfo";
+	}
+	return "";
+}
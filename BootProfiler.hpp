@@ -0,0 +1,84 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#ifndef BootProfiler_h
+#define BootProfiler_h
+
+#include <Arduino.h>
+
+// Stages of Basecamp::begin(), in the order they are passed
+enum class BootStage : uint8_t {
+	// Everything from reset until begin() has been called
+	beforeBegin,
+	serial,
+	configuration,
+	resetReason,
+	eventBus,
+	apSecret,
+	wifi,
+	mqtt,
+	ota,
+	interface,
+	webServer,
+	systemInfo,
+};
+
+struct BootProfileEntry {
+	BootStage stage;
+	// Time spent in the stage
+	uint32_t durationUs;
+	// Heap after the stage
+	uint32_t freeHeap;
+	uint32_t largestFreeBlock;
+};
+
+/**
+	Records the duration and heap usage of the stages of Basecamp::begin().
+	Only compiled in if BASECAMP_PROFILE_BOOT is defined, use BASECAMP_BOOT_STAGE() to mark the end
+	of a stage. Entries are kept in a fixed array, recording does not allocate.
+*/
+class BootProfiler {
+	public:
+		static const constexpr size_t maxEntries = 16;
+
+		// Starts profiling, the time since reset is recorded as BootStage::beforeBegin
+		void start();
+		// Ends "stage" (and starts the next one)
+		void mark(BootStage stage);
+
+		size_t size() const
+		{
+			return count_;
+		}
+
+		const BootProfileEntry& operator[](size_t index) const
+		{
+			return entries_[index];
+		}
+
+		// Sum of all stages except beforeBegin
+		uint32_t getBeginDurationUs() const;
+
+		// {"total":<us>,"stages":[{"stage":"wifi","us":..,"heap":..,"block":..},..]}
+		String toJson() const;
+		// One line per stage for the serial console
+		String toString() const;
+
+		static const char* getStageName(BootStage stage);
+
+	private:
+		BootProfileEntry entries_[maxEntries];
+		size_t count_ = 0;
+		int64_t last_ = 0;
+};
+
+#ifdef BASECAMP_PROFILE_BOOT
+#define BASECAMP_BOOT_STAGE(profiler, stage) (profiler).mark(stage)
+#else
+#define BASECAMP_BOOT_STAGE(profiler, stage)
+#endif
+
+#endif
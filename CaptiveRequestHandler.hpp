@@ -13,7 +13,9 @@ class CaptiveRequestHandler : public AsyncWebHandler {
 					request->url() != "/basecamp.js" && 
 					request->url() != "/data.json" && 
 					request->url() != "/logo.svg" && 
-					request->url() != "/submitconfig") {
+					request->url() != "/submitconfig" &&
+					request->url() != "/update" &&
+					request->url() != "/profile.json") {
 				return true;
 			} else {
 				return false;
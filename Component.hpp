@@ -0,0 +1,53 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#ifndef Component_h
+#define Component_h
+
+#include <functional>
+
+/**
+	A subsystem that can be started and stopped at runtime, e.g. the web server.
+	Components are managed by a ComponentRegistry, which constructs them on first use and
+	destroys them when they are stopped.
+*/
+class Component {
+	public:
+		virtual ~Component() = default;
+
+		// Allocates everything needed and starts working. Returns false on failure.
+		virtual bool start() = 0;
+		// Stops working and releases everything start() has allocated
+		virtual void stop() = 0;
+};
+
+// Component made of a pair of functions, for subsystems owned by someone else
+class FunctionComponent : public Component {
+	public:
+		FunctionComponent(std::function<bool()> startFunction, std::function<void()> stopFunction)
+			: start_(std::move(startFunction))
+			, stop_(std::move(stopFunction))
+		{
+		}
+
+		bool start() override
+		{
+			return start_ ? start_() : true;
+		}
+
+		void stop() override
+		{
+			if (stop_) {
+				stop_();
+			}
+		}
+
+	private:
+		std::function<bool()> start_;
+		std::function<void()> stop_;
+};
+
+#endif
@@ -0,0 +1,116 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#include "ComponentRegistry.hpp"
+
+#include "debug.hpp"
+#include <algorithm>
+
+bool ComponentRegistry::add(const String &name, Factory factory, std::vector<String> dependencies)
+{
+	if (find(name) != nullptr) {
+		return false;
+	}
+
+	entries_.push_back(Entry{name, std::move(factory), std::move(dependencies), nullptr, false});
+	return true;
+}
+
+bool ComponentRegistry::start(const String &name)
+{
+	Entry *entry = find(name);
+	if (entry == nullptr) {
+		DEBUG_PRINTF("Unknown component %s\n", name.c_str());
+		return false;
+	}
+	if (entry->instance) {
+		return true;
+	}
+	if (entry->starting) {
+		DEBUG_PRINTF("Component %s depends on itself\n", name.c_str());
+		return false;
+	}
+
+	entry->starting = true;
+	// Copy, starting dependencies may add entries and move this one
+	const auto dependencies = entry->dependencies;
+	for (const auto &dependency : dependencies) {
+		if (!start(dependency)) {
+			find(name)->starting = false;
+			return false;
+		}
+	}
+
+	entry = find(name);
+	entry->starting = false;
+	std::unique_ptr<Component> instance = entry->factory();
+	if (!instance || !instance->start()) {
+		DEBUG_PRINTF("Component %s failed to start\n", name.c_str());
+		return false;
+	}
+
+	find(name)->instance = std::move(instance);
+	return true;
+}
+
+void ComponentRegistry::stop(const String &name)
+{
+	Entry *entry = find(name);
+	if (entry == nullptr || !entry->instance) {
+		return;
+	}
+
+	// Everything depending on this component goes first
+	for (size_t i = 0; i < entries_.size(); i++) {
+		const auto &dependencies = entries_[i].dependencies;
+		if (entries_[i].instance && std::find(dependencies.begin(), dependencies.end(), name) != dependencies.end()) {
+			stop(entries_[i].name);
+		}
+	}
+
+	// Release the instance before stopping so a stop() starting it again is not lost
+	std::unique_ptr<Component> instance = std::move(find(name)->instance);
+	instance->stop();
+}
+
+void ComponentRegistry::stopAll()
+{
+	// Started components are stopped along with their dependents, so going backwards is enough
+	for (size_t i = entries_.size(); i > 0; i--) {
+		stop(entries_[i - 1].name);
+	}
+}
+
+bool ComponentRegistry::isRunning(const String &name) const
+{
+	return (get(name) != nullptr);
+}
+
+Component* ComponentRegistry::get(const String &name) const
+{
+	const Entry *entry = find(name);
+	return (entry == nullptr) ? nullptr : entry->instance.get();
+}
+
+ComponentRegistry::Entry* ComponentRegistry::find(const String &name)
+{
+	for (auto &entry : entries_) {
+		if (entry.name == name) {
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+const ComponentRegistry::Entry* ComponentRegistry::find(const String &name) const
+{
+	for (const auto &entry : entries_) {
+		if (entry.name == name) {
+			return &entry;
+		}
+	}
+	return nullptr;
+}
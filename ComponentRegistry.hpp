@@ -0,0 +1,56 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#ifndef ComponentRegistry_h
+#define ComponentRegistry_h
+
+#include <Arduino.h>
+#include <memory>
+#include <vector>
+
+#include "Component.hpp"
+
+/**
+	Starts and stops components in the order of their dependencies.
+	A component is only constructed by its factory when it is started, and destroyed when it
+	is stopped, so registered but unused components cost nothing but their entry.
+*/
+class ComponentRegistry {
+	public:
+		using Factory = std::function<std::unique_ptr<Component>()>;
+
+		// Registers the component "name". Returns false if the name is already taken.
+		bool add(const String &name, Factory factory, std::vector<String> dependencies = {});
+
+		// Starts "name" after all of its dependencies. Returns false if any of them fails,
+		// is unknown or depends on itself.
+		bool start(const String &name);
+		// Stops "name" after all running components depending on it and destroys them
+		void stop(const String &name);
+		// Stops everything in reverse dependency order
+		void stopAll();
+
+		bool isRunning(const String &name) const;
+		// The instance of "name" if it is running, nullptr otherwise
+		Component* get(const String &name) const;
+
+	private:
+		struct Entry {
+			String name;
+			Factory factory;
+			std::vector<String> dependencies;
+			std::unique_ptr<Component> instance;
+			// Set while the dependencies are started, detects cycles
+			bool starting;
+		};
+
+		Entry* find(const String &name);
+		const Entry* find(const String &name) const;
+
+		std::vector<Entry> entries_;
+};
+
+#endif
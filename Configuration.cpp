@@ -5,6 +5,40 @@
    */
 #include "Configuration.hpp"
 
+#include <cstddef>
+#include <rom/crc.h>
+
+namespace {
+	// Marks a valid snapshot ("BCCS")
+	const constexpr uint32_t snapshotMagic = 0x42434353;
+	const constexpr size_t snapshotCapacity = 1024;
+
+	// Configuration values for wakes from deep sleep, see Configuration::storeSnapshot()
+	struct ConfigurationSnapshot {
+		uint32_t magic;
+		// CRC of the file name the snapshot belongs to
+		uint32_t file;
+		uint32_t crc;
+		uint16_t length;
+		// "key\0value\0key\0value\0..."
+		char data[snapshotCapacity];
+	};
+
+	RTC_DATA_ATTR ConfigurationSnapshot rtcSnapshot;
+
+	uint32_t snapshotCrc(const ConfigurationSnapshot &snapshot)
+	{
+		uint32_t crc = crc32_le(0, reinterpret_cast<const uint8_t *>(&snapshot.file), sizeof(snapshot.file));
+		crc = crc32_le(crc, reinterpret_cast<const uint8_t *>(&snapshot.length), sizeof(snapshot.length));
+		return crc32_le(crc, reinterpret_cast<const uint8_t *>(snapshot.data), snapshot.length);
+	}
+
+	uint32_t fileCrc(const String &filename)
+	{
+		return crc32_le(0, reinterpret_cast<const uint8_t *>(filename.c_str()), filename.length());
+	}
+}
+
 Configuration::Configuration()
 	: _memOnlyConfig( true ),
 	_jsonFile()
@@ -72,6 +106,19 @@ bool Configuration::save() {
 		return false;
 	}
 
+	// The snapshot would hide the changes on the next wake
+	rtcSnapshot.magic = 0;
+
+	// Only some keys have been restored, keep all others of the file
+	if (_fromSnapshot) {
+		const auto values = configuration;
+		load();
+		for (const auto &value : values) {
+			configuration[value.first] = value.second;
+		}
+		_fromSnapshot = false;
+	}
+
 	File configFile = SPIFFS.open(_jsonFile, "w");
 	if (!configFile) {
 		Serial.println("Failed to open config file for writing");
@@ -100,6 +147,54 @@ bool Configuration::save() {
 	return true;
 }
 
+bool Configuration::storeSnapshot(const std::list<String> &keys) const
+{
+	if (_memOnlyConfig) {
+		return false;
+	}
+
+	rtcSnapshot.magic = 0;
+	size_t length = 0;
+	for (const auto &key : keys) {
+		const String &value = get(key);
+		const size_t needed = key.length() + value.length() + 2;
+		if (length + needed > snapshotCapacity) {
+			DEBUG_PRINTLN("Configuration does not fit into the snapshot.");
+			return false;
+		}
+		memcpy(rtcSnapshot.data + length, key.c_str(), key.length() + 1);
+		length += key.length() + 1;
+		memcpy(rtcSnapshot.data + length, value.c_str(), value.length() + 1);
+		length += value.length() + 1;
+	}
+
+	rtcSnapshot.file = fileCrc(_jsonFile);
+	rtcSnapshot.length = length;
+	rtcSnapshot.crc = snapshotCrc(rtcSnapshot);
+	rtcSnapshot.magic = snapshotMagic;
+	return true;
+}
+
+bool Configuration::loadSnapshot()
+{
+	if (_memOnlyConfig || rtcSnapshot.magic != snapshotMagic || rtcSnapshot.length > snapshotCapacity ||
+		rtcSnapshot.file != fileCrc(_jsonFile) || rtcSnapshot.crc != snapshotCrc(rtcSnapshot)) {
+		return false;
+	}
+
+	const char *position = rtcSnapshot.data;
+	const char *end = rtcSnapshot.data + rtcSnapshot.length;
+	while (position < end) {
+		const char *key = position;
+		const char *value = key + strlen(key) + 1;
+		configuration[key] = value;
+		position = value + strlen(value) + 1;
+	}
+
+	_fromSnapshot = true;
+	return true;
+}
+
 void Configuration::set(String key, String value) {
 	std::ostringstream debug;
 	debug << "Settting " << key.c_str() << " to " << value.c_str() << "(was " << get(key).c_str() << ")";
@@ -22,13 +22,40 @@ enum class ConfigurationKey {
 	wifiConfigured,
 	wifiEssid,
 	wifiPassword,
+	// Further known networks, tried if the first one is not available
+	wifiEssid2,
+	wifiPassword2,
+	wifiEssid3,
+	wifiPassword3,
+	wifiEssid4,
+	wifiPassword4,
 	mqttActive,
 	mqttHost,
 	mqttPort,
 	mqttUser,
 	mqttPass,
+	// Time in ms a published packet may wait for its acknowledgement, see MqttGuard. Unset means
+	// 10000, 0 waits forever.
+	mqttAckTimeout,
+	// "true" keeps the session at the broker (cleanSession=false), so subscriptions survive deep sleep
+	mqttPersistentSession,
 	otaActive,
 	otaPass,
+	// Backoff of WiFi and MQTT reconnects, see ReconnectPolicy
+	reconnectBaseDelay,
+	reconnectMaxDelay,
+	reconnectMultiplier,
+	reconnectStablePeriod,
+	// Unsuccessful boots (power cycles, resets) after which the WiFi configuration is reset
+	// or, if WiFi is unconfigured, SPIFFS is formatted. 0 disables the reset.
+	bootCounterWifiReset,
+	bootCounterFactoryReset,
+	// Core (0 or 1) to run all tasks of Basecamp on, see TaskManager
+	taskCore,
+	// Wakes after which the WakeTimeline statistics are published, 0 disables it
+	wakeReportInterval,
+	// Seconds between the records of Telemetry, unset or 0 disables it
+	telemetryInterval,
 };
 
 // TODO: Extend with all known keys
@@ -53,6 +80,24 @@ static const String getKeyName(ConfigurationKey key)
 		case ConfigurationKey::wifiPassword:
 			return "WifiPassword";
 
+		case ConfigurationKey::wifiEssid2:
+			return "WifiEssid2";
+
+		case ConfigurationKey::wifiPassword2:
+			return "WifiPassword2";
+
+		case ConfigurationKey::wifiEssid3:
+			return "WifiEssid3";
+
+		case ConfigurationKey::wifiPassword3:
+			return "WifiPassword3";
+
+		case ConfigurationKey::wifiEssid4:
+			return "WifiEssid4";
+
+		case ConfigurationKey::wifiPassword4:
+			return "WifiPassword4";
+
 		case ConfigurationKey::mqttActive:
 			return "MQTTActive";
 
@@ -68,11 +113,44 @@ static const String getKeyName(ConfigurationKey key)
 		case ConfigurationKey::mqttPass:
 			return "MQTTPass";
 
+		case ConfigurationKey::mqttAckTimeout:
+			return "MQTTAckTimeout";
+
+		case ConfigurationKey::mqttPersistentSession:
+			return "MQTTPersistentSession";
+
 		case ConfigurationKey::otaActive:
 			return "OTAActive";
 
 		case ConfigurationKey::otaPass:
 			return "OTAPass";
+
+		case ConfigurationKey::reconnectBaseDelay:
+			return "ReconnectBaseDelay";
+
+		case ConfigurationKey::reconnectMaxDelay:
+			return "ReconnectMaxDelay";
+
+		case ConfigurationKey::reconnectMultiplier:
+			return "ReconnectMultiplier";
+
+		case ConfigurationKey::reconnectStablePeriod:
+			return "ReconnectStablePeriod";
+
+		case ConfigurationKey::bootCounterWifiReset:
+			return "BootCounterWifiReset";
+
+		case ConfigurationKey::bootCounterFactoryReset:
+			return "BootCounterFactoryReset";
+
+		case ConfigurationKey::taskCore:
+			return "TaskCore";
+
+		case ConfigurationKey::wakeReportInterval:
+			return "WakeReportInterval";
+
+		case ConfigurationKey::telemetryInterval:
+			return "TelemetryInterval";
 	}
 	return "";
 }
@@ -97,6 +175,15 @@ class Configuration {
 		// Both functions return true on successful load or save. Return false on any failure. Also return false for memory-only configurations.
 		bool load();
 		bool save();
+
+		// Copies the values of "keys" into RTC memory, which survives deep sleep but not a power cycle.
+		// Returns false if they do not fit. Any save() invalidates the snapshot.
+		bool storeSnapshot(const std::list<String> &keys) const;
+		// Restores the values of a valid snapshot of this configuration file instead of parsing it.
+		// Only the keys of the snapshot are available then. save() merges them into the file first.
+		bool loadSnapshot();
+		// True if the current values have been restored by loadSnapshot()
+		bool isFromSnapshot() const {return _fromSnapshot;}
 		
 		void dump();
 
@@ -144,6 +231,7 @@ class Configuration {
 		String noResult_ = {};
 		// Set to true if configuration is memory-only
 		bool _memOnlyConfig;
+		bool _fromSnapshot = false;
 };
 
 #endif
@@ -0,0 +1,111 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#ifndef DefaultInterface_h
+#define DefaultInterface_h
+
+#include "WebInterface.hpp"
+
+//
+// Static part of the default configuration interface. Everything in here is placed in
+// flash and served directly by the WebServer. Elements depending on runtime data
+// (device name, MAC) are added separately by Basecamp::begin().
+//
+namespace defaultInterface {
+	const constexpr InterfaceAttributeSchema headingAttributes[] {
+		{"class", "fat-border"},
+	};
+	const constexpr InterfaceAttributeSchema logoAttributes[] {
+		{"src", "/logo.svg"},
+	};
+	const constexpr InterfaceAttributeSchema configFormAttributes[] {
+		{"action", "#"},
+		{"onsubmit", "collectConfiguration()"},
+	};
+	const constexpr InterfaceAttributeSchema generalSectionAttributes[] {
+		{"data-title", "General"},
+	};
+	const constexpr InterfaceAttributeSchema networkSectionAttributes[] {
+		{"data-title", "More networks"},
+	};
+	// An emptied ESSID is submitted as well to remove the network
+	const constexpr InterfaceAttributeSchema removableEssidAttributes[] {
+		{"data-clearable", "true"},
+	};
+	const constexpr InterfaceAttributeSchema mqttSectionAttributes[] {
+		{"data-title", "MQTT"},
+	};
+	const constexpr InterfaceAttributeSchema passwordAttributes[] {
+		{"type", "password"},
+	};
+	const constexpr InterfaceAttributeSchema wifiConfiguredAttributes[] {
+		{"type", "hidden"},
+		{"value", "true"},
+	};
+	const constexpr InterfaceAttributeSchema portAttributes[] {
+		{"type", "number"},
+		{"min", "0"},
+		{"max", "65535"},
+	};
+	const constexpr InterfaceAttributeSchema submitAttributes[] {
+		{"type", "submit"},
+	};
+	const constexpr InterfaceAttributeSchema footerLinkAttributes[] {
+		{"href", "https://github.com/merlinschumacher/Basecamp"},
+		{"target", "_blank"},
+	};
+
+	// The h1 that contains the logo and the device name. It is a child of the #wrapper-element.
+	const constexpr InterfaceElementSchema heading[] {
+		{"heading", "h1", "", "#wrapper", nullptr, headingAttributes, schemaSize(headingAttributes)},
+		{"logo", "img", "", "#heading", nullptr, logoAttributes, schemaSize(logoAttributes)},
+	};
+
+	// Basic information and the configuration form with the "General" section (device name and WiFi).
+	// WifiConfigured stays outside of the sections as it has to be submitted in any case.
+	const constexpr InterfaceElementSchema configForm[] {
+		{"infotext1", "p", "Configure your device with the following options:", "#wrapper", nullptr, nullptr, 0},
+		{"configform", "form", "", "#wrapper", nullptr, configFormAttributes, schemaSize(configFormAttributes)},
+		{"general", "section", "", "#configform", nullptr, generalSectionAttributes, schemaSize(generalSectionAttributes)},
+		{"DeviceName", "input", "Device name", "#general", "DeviceName", nullptr, 0},
+		{"WifiEssid", "input", "WIFI SSID:", "#general", "WifiEssid", nullptr, 0},
+		{"WifiPassword", "input", "WIFI Password:", "#general", "WifiPassword", passwordAttributes, schemaSize(passwordAttributes)},
+		{"WifiConfigured", "input", "", "#configform", "WifiConfigured", wifiConfiguredAttributes, schemaSize(wifiConfiguredAttributes)},
+	};
+
+	// Section with further known networks. Clear an ESSID to remove the network.
+	const constexpr InterfaceElementSchema networkSettings[] {
+		{"networks", "section", "", "#configform", nullptr, networkSectionAttributes, schemaSize(networkSectionAttributes)},
+		{"networksinfo", "p", "Tried in the order of their signal strength if the first network is not available.", "#networks", nullptr, nullptr, 0},
+		{"WifiEssid2", "input", "WIFI SSID 2:", "#networks", "WifiEssid2", removableEssidAttributes, schemaSize(removableEssidAttributes)},
+		{"WifiPassword2", "input", "WIFI Password 2:", "#networks", "WifiPassword2", passwordAttributes, schemaSize(passwordAttributes)},
+		{"WifiEssid3", "input", "WIFI SSID 3:", "#networks", "WifiEssid3", removableEssidAttributes, schemaSize(removableEssidAttributes)},
+		{"WifiPassword3", "input", "WIFI Password 3:", "#networks", "WifiPassword3", passwordAttributes, schemaSize(passwordAttributes)},
+		{"WifiEssid4", "input", "WIFI SSID 4:", "#networks", "WifiEssid4", removableEssidAttributes, schemaSize(removableEssidAttributes)},
+		{"WifiPassword4", "input", "WIFI Password 4:", "#networks", "WifiPassword4", passwordAttributes, schemaSize(passwordAttributes)},
+	};
+
+	// Section with the inputs for the MQTT configuration, only shown if MQTT hasn't been disabled
+	const constexpr InterfaceElementSchema mqttSettings[] {
+		{"mqtt", "section", "", "#configform", nullptr, mqttSectionAttributes, schemaSize(mqttSectionAttributes)},
+		{"MQTTHost", "input", "MQTT Host:", "#mqtt", "MQTTHost", nullptr, 0},
+		{"MQTTPort", "input", "MQTT Port:", "#mqtt", "MQTTPort", portAttributes, schemaSize(portAttributes)},
+		{"MQTTUser", "input", "MQTT Username:", "#mqtt", "MQTTUser", nullptr, 0},
+		{"MQTTPass", "input", "MQTT Password:", "#mqtt", "MQTTPass", passwordAttributes, schemaSize(passwordAttributes)},
+	};
+
+	// The save button calls the JavaScript function collectConfiguration() on submit
+	const constexpr InterfaceElementSchema saveButton[] {
+		{"saveform", "button", "Save", "#configform", nullptr, submitAttributes, schemaSize(submitAttributes)},
+	};
+
+	const constexpr InterfaceElementSchema footer[] {
+		{"footer", "footer", "Powered by ", "body", nullptr, nullptr, 0},
+		{"footerlink", "a", "Basecamp", "footer", nullptr, footerLinkAttributes, schemaSize(footerLinkAttributes)},
+	};
+}
+
+#endif
@@ -0,0 +1,158 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#include "EventBus.hpp"
+
+#include <algorithm>
+#include <esp_timer.h>
+
+namespace {
+	// Settings of the dispatcher task if created by a TaskManager
+	const constexpr uint32_t defaultStackSize = 3072;
+	const constexpr UBaseType_t defaultPriority = 2;
+}
+
+const constexpr uint32_t EventBus::allEvents;
+
+EventBus::EventBus(size_t queueLength)
+	: queueLength_(queueLength)
+{
+	mutex_ = xSemaphoreCreateRecursiveMutex();
+}
+
+EventBus::~EventBus()
+{
+	if (task_ != nullptr) {
+		vTaskDelete(task_);
+	}
+	if (queue_ != nullptr) {
+		vQueueDelete(queue_);
+	}
+	vSemaphoreDelete(mutex_);
+}
+
+bool EventBus::begin(uint32_t stackSize, UBaseType_t priority)
+{
+	return start([this, stackSize, priority]() -> TaskHandle_t {
+		TaskHandle_t task = nullptr;
+		if (xTaskCreate(&dispatch, "EventBus", stackSize, this, priority, &task) != pdPASS) {
+			return nullptr;
+		}
+		return task;
+	});
+}
+
+bool EventBus::begin(TaskManager &taskManager)
+{
+	return start([this, &taskManager]() {
+		return taskManager.spawn("EventBus", &dispatch, this, TaskSettings{defaultStackSize, defaultPriority, tskNO_AFFINITY});
+	});
+}
+
+bool EventBus::start(std::function<TaskHandle_t()> createTask)
+{
+	if (task_ != nullptr) {
+		return true;
+	}
+
+	queue_ = xQueueCreate(queueLength_, sizeof(SystemEvent));
+	if (queue_ == nullptr) {
+		return false;
+	}
+
+	task_ = createTask();
+	if (task_ == nullptr) {
+		vQueueDelete(queue_);
+		queue_ = nullptr;
+		return false;
+	}
+	return true;
+}
+
+EventBus::SubscriptionId EventBus::subscribe(SystemEventType type, Subscriber subscriber)
+{
+	return addSubscription(1u << static_cast<uint8_t>(type), std::move(subscriber));
+}
+
+EventBus::SubscriptionId EventBus::subscribe(Subscriber subscriber)
+{
+	return addSubscription(allEvents, std::move(subscriber));
+}
+
+EventBus::SubscriptionId EventBus::addSubscription(uint32_t mask, Subscriber subscriber)
+{
+	xSemaphoreTakeRecursive(mutex_, portMAX_DELAY);
+	const SubscriptionId id = nextId_++;
+	subscriptions_.push_back(Subscription{id, mask, std::move(subscriber)});
+	xSemaphoreGiveRecursive(mutex_);
+	return id;
+}
+
+void EventBus::unsubscribe(SubscriptionId id)
+{
+	xSemaphoreTakeRecursive(mutex_, portMAX_DELAY);
+	subscriptions_.erase(std::remove_if(subscriptions_.begin(), subscriptions_.end(),
+		[id](const Subscription &subscription) { return subscription.id == id; }), subscriptions_.end());
+	xSemaphoreGiveRecursive(mutex_);
+}
+
+bool EventBus::post(SystemEventType type, int32_t value)
+{
+	const SystemEvent event{type, value, esp_timer_get_time()};
+	if (queue_ == nullptr || xQueueSend(queue_, &event, 0) != pdTRUE) {
+		dropped_++;
+		return false;
+	}
+	return true;
+}
+
+bool EventBus::postFromISR(SystemEventType type, int32_t value, BaseType_t *higherPriorityTaskWoken)
+{
+	const SystemEvent event{type, value, esp_timer_get_time()};
+	if (queue_ == nullptr || xQueueSendFromISR(queue_, &event, higherPriorityTaskWoken) != pdTRUE) {
+		dropped_++;
+		return false;
+	}
+	return true;
+}
+
+uint32_t EventBus::getDroppedCount() const
+{
+	return dropped_;
+}
+
+void EventBus::dispatch(void *eventBus)
+{
+	auto &bus = *static_cast<EventBus *>(eventBus);
+	SystemEvent event;
+	while (true) {
+		if (xQueueReceive(bus.queue_, &event, portMAX_DELAY) == pdTRUE) {
+			bus.deliver(event);
+		}
+	}
+}
+
+void EventBus::deliver(const SystemEvent &event)
+{
+	const uint32_t bit = 1u << static_cast<uint8_t>(event.type);
+
+	// The subscribers are called after releasing the mutex, so they may (un)subscribe, even
+	// themselves, and take their time without blocking other tasks. Only the dispatcher task
+	// uses delivering_.
+	delivering_.clear();
+	xSemaphoreTakeRecursive(mutex_, portMAX_DELAY);
+	for (const auto &subscription : subscriptions_) {
+		if ((subscription.mask & bit) != 0) {
+			delivering_.push_back(subscription.subscriber);
+		}
+	}
+	xSemaphoreGiveRecursive(mutex_);
+
+	for (const auto &subscriber : delivering_) {
+		subscriber(event);
+	}
+	delivering_.clear();
+}
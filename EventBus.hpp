@@ -0,0 +1,113 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#ifndef EventBus_h
+#define EventBus_h
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "TaskManager.hpp"
+
+// Events posted by Basecamp. Keep below 32 entries, they are used as bit positions of subscription masks.
+enum class SystemEventType : uint8_t {
+	wifiConnected,
+	// An IP address has been assigned, the connection is usable
+	wifiGotIp,
+	wifiDisconnected,
+	// value: 1 if the broker still had a session for us
+	mqttConnected,
+	// value: AsyncMqttClientDisconnectReason
+	mqttDisconnected,
+	otaStarted,
+	otaFinished,
+	// value: ota_error_t
+	otaFailed,
+	firmwareUploadStarted,
+	firmwareUploadFinished,
+	firmwareUploadFailed,
+	configurationSaved,
+	// A delayed reconnect attempt of WifiControl is due, handled by WifiControl itself
+	wifiRetry,
+	// The MQTT acknowledgement deadlines are due to be checked, handled by Basecamp itself
+	mqttDeadlineCheck,
+};
+
+struct SystemEvent {
+	SystemEventType type;
+	// Event specific detail, see SystemEventType
+	int32_t value;
+	// esp_timer_get_time() at the time the event has been posted
+	int64_t timestamp;
+};
+
+/**
+	Delivers system events to subscribers.
+	Events are posted into a fixed-size FreeRTOS queue without blocking, from tasks, driver
+	callbacks or interrupts. A dispatcher task calls the subscribers, so they may take their time
+	(e.g. write to NVS) without stalling the WiFi driver or the TCP stack.
+*/
+class EventBus {
+	public:
+		using Subscriber = std::function<void(const SystemEvent &event)>;
+		using SubscriptionId = uint32_t;
+		static const constexpr uint32_t allEvents = 0xFFFFFFFF;
+
+		// "queueLength" is the maximum amount of events waiting for the dispatcher
+		explicit EventBus(size_t queueLength = 16);
+		~EventBus();
+
+		// Creates the dispatcher task. Events posted before are dropped.
+		bool begin(uint32_t stackSize = 3072, UBaseType_t priority = 2);
+		// Like begin(), the dispatcher task "EventBus" is created by "taskManager"
+		bool begin(TaskManager &taskManager);
+
+		// Calls "subscriber" for every event of type "type" (or for all events).
+		// Returns an id for unsubscribe(). Subscribers are called from the dispatcher task, without
+		// any lock held. One unsubscribed while an event is delivered may still get that event.
+		SubscriptionId subscribe(SystemEventType type, Subscriber subscriber);
+		SubscriptionId subscribe(Subscriber subscriber);
+		void unsubscribe(SubscriptionId id);
+
+		// Never blocks. Returns false and counts the event as dropped if the queue is full.
+		bool post(SystemEventType type, int32_t value = 0);
+		// Variant for interrupt handlers
+		bool postFromISR(SystemEventType type, int32_t value, BaseType_t *higherPriorityTaskWoken);
+
+		// Number of events dropped because the queue was full or the bus has not been started
+		uint32_t getDroppedCount() const;
+
+	private:
+		struct Subscription {
+			SubscriptionId id;
+			uint32_t mask;
+			Subscriber subscriber;
+		};
+
+		// Creates the queue and the dispatcher task by calling "createTask"
+		bool start(std::function<TaskHandle_t()> createTask);
+		static void dispatch(void *eventBus);
+		void deliver(const SystemEvent &event);
+		SubscriptionId addSubscription(uint32_t mask, Subscriber subscriber);
+
+		size_t queueLength_;
+		QueueHandle_t queue_ = nullptr;
+		TaskHandle_t task_ = nullptr;
+		// Guards subscriptions_
+		SemaphoreHandle_t mutex_ = nullptr;
+		std::vector<Subscription> subscriptions_;
+		// Subscribers of the event being delivered, kept to reuse the memory
+		std::vector<Subscriber> delivering_;
+		SubscriptionId nextId_ = 1;
+		volatile uint32_t dropped_ = 0;
+};
+
+#endif
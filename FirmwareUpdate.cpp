@@ -0,0 +1,545 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#include "FirmwareUpdate.hpp"
+#include "debug.hpp"
+
+#include <Update.h>
+#include <algorithm>
+#include <rom/crc.h>
+
+namespace {
+	// gzip header flags (RFC 1952)
+	const constexpr uint8_t gzipFlagHeaderCrc = 0x02;
+	const constexpr uint8_t gzipFlagExtra = 0x04;
+	const constexpr uint8_t gzipFlagName = 0x08;
+	const constexpr uint8_t gzipFlagComment = 0x10;
+	const constexpr size_t gzipHeaderLength = 10;
+	const constexpr size_t gzipTrailerLength = 8;
+}
+
+bool UpdateFirmwareWriter::begin(size_t size)
+{
+	return Update.begin((size == 0) ? UPDATE_SIZE_UNKNOWN : size, U_FLASH);
+}
+
+size_t UpdateFirmwareWriter::write(const uint8_t *data, size_t length)
+{
+	// Update::write() does not modify the data, it only lacks the const
+	return Update.write(const_cast<uint8_t *>(data), length);
+}
+
+bool UpdateFirmwareWriter::end(const String &md5)
+{
+	if (md5.length() != 0 && !Update.setMD5(md5.c_str())) {
+		return false;
+	}
+
+	// Update::end() checks the MD5 before switching the boot partition
+	return Update.end(true);
+}
+
+void UpdateFirmwareWriter::abort()
+{
+	Update.abort();
+}
+
+String UpdateFirmwareWriter::getError() const
+{
+	return Update.errorString();
+}
+
+FileFirmwareWriter::FileFirmwareWriter(fs::FS &fs, const String &path)
+	: fs_(fs)
+	, path_(path)
+{
+}
+
+bool FileFirmwareWriter::begin(size_t /*size*/)
+{
+	abort();
+	error_ = "";
+	file_ = fs_.open(path_, "w");
+	if (!file_) {
+		error_ = "Could not create " + path_;
+		return false;
+	}
+	md5_.begin();
+	return true;
+}
+
+size_t FileFirmwareWriter::write(const uint8_t *data, size_t length)
+{
+	if (!file_) {
+		error_ = "No update in progress";
+		return 0;
+	}
+
+	const size_t written = file_.write(data, length);
+	// MD5Builder::add() takes at most 64 KB at once and lacks the const
+	for (size_t offset = 0; offset < written; offset += UINT16_MAX) {
+		md5_.add(const_cast<uint8_t *>(data + offset), static_cast<uint16_t>(std::min<size_t>(written - offset, UINT16_MAX)));
+	}
+	if (written != length) {
+		error_ = "Could not write " + path_;
+	}
+	return written;
+}
+
+bool FileFirmwareWriter::end(const String &md5)
+{
+	if (!file_) {
+		error_ = "No update in progress";
+		return false;
+	}
+	file_.close();
+
+	md5_.calculate();
+	if (md5.length() != 0 && !md5.equalsIgnoreCase(md5_.toString())) {
+		error_ = "MD5 check failed, image has " + md5_.toString();
+		fs_.remove(path_);
+		return false;
+	}
+	return true;
+}
+
+void FileFirmwareWriter::abort()
+{
+	if (file_) {
+		file_.close();
+		fs_.remove(path_);
+	}
+}
+
+String FileFirmwareWriter::getError() const
+{
+	return error_;
+}
+
+GzipFirmwareWriter::GzipFirmwareWriter(FirmwareWriter &writer)
+	: writer_(writer)
+{
+}
+
+GzipFirmwareWriter::~GzipFirmwareWriter()
+{
+	release();
+}
+
+bool GzipFirmwareWriter::begin(size_t /*size*/)
+{
+	release();
+	state_ = State::detect;
+	error_ = "";
+	fieldLength_ = 0;
+	flags_ = 0;
+	extraRemaining_ = 0;
+	inflatedSize_ = 0;
+	crc_ = 0;
+	windowOffset_ = 0;
+
+	// The size of the uncompressed image is not known yet
+	return writer_.begin(0);
+}
+
+size_t GzipFirmwareWriter::write(const uint8_t *data, size_t length)
+{
+	size_t used = 0;
+	while (used < length) {
+		switch (state_) {
+			case State::detect:
+				field_[fieldLength_++] = data[used++];
+				if (fieldLength_ < 2) {
+					break;
+				}
+				if (field_[0] == 0x1f && field_[1] == 0x8b) {
+					state_ = State::header;
+					break;
+				}
+				// Not compressed, hand over what has been held back and continue unchanged
+				state_ = State::raw;
+				if (writer_.write(field_, fieldLength_) != fieldLength_) {
+					fail("Writing firmware failed: " + writer_.getError());
+				}
+				break;
+
+			case State::raw:
+			{
+				const size_t written = writer_.write(data + used, length - used);
+				used += written;
+				if (used != length) {
+					fail("Writing firmware failed: " + writer_.getError());
+				}
+				break;
+			}
+
+			case State::deflate:
+				used += inflate(data + used, length - used);
+				break;
+
+			case State::trailer:
+				used += parseTrailer(data + used, length - used);
+				break;
+
+			case State::done:
+				fail("Unexpected data after compressed image");
+				break;
+
+			case State::failed:
+				return used;
+
+			default:
+				used += parseHeader(data + used, length - used);
+				break;
+		}
+
+		if (state_ == State::failed) {
+			return used;
+		}
+	}
+
+	return used;
+}
+
+size_t GzipFirmwareWriter::parseHeader(const uint8_t *data, size_t length)
+{
+	size_t used = 0;
+	auto nextState = [this](State after) {
+		if (after < State::extraLength && (flags_ & gzipFlagExtra)) {
+			return State::extraLength;
+		}
+		if (after < State::name && (flags_ & gzipFlagName)) {
+			return State::name;
+		}
+		if (after < State::comment && (flags_ & gzipFlagComment)) {
+			return State::comment;
+		}
+		if (after < State::headerCrc && (flags_ & gzipFlagHeaderCrc)) {
+			return State::headerCrc;
+		}
+		return State::deflate;
+	};
+
+	while (used < length && state_ != State::deflate && state_ != State::failed) {
+		const uint8_t byte = data[used++];
+		switch (state_) {
+			case State::header:
+				field_[fieldLength_++] = byte;
+				if (fieldLength_ < gzipHeaderLength) {
+					break;
+				}
+				// Only deflate (8) is defined as compression method
+				if (field_[2] != 8) {
+					fail("Unsupported compression method");
+					break;
+				}
+				flags_ = field_[3];
+				fieldLength_ = 0;
+				state_ = nextState(State::header);
+				break;
+
+			case State::extraLength:
+				field_[fieldLength_++] = byte;
+				if (fieldLength_ == 2) {
+					extraRemaining_ = field_[0] | (field_[1] << 8);
+					fieldLength_ = 0;
+					state_ = (extraRemaining_ == 0) ? nextState(State::extra) : State::extra;
+				}
+				break;
+
+			case State::extra:
+				if (--extraRemaining_ == 0) {
+					state_ = nextState(State::extra);
+				}
+				break;
+
+			case State::name:
+			case State::comment:
+				// Zero terminated strings
+				if (byte == 0) {
+					state_ = nextState(state_);
+				}
+				break;
+
+			case State::headerCrc:
+				if (++fieldLength_ == 2) {
+					fieldLength_ = 0;
+					state_ = nextState(State::headerCrc);
+				}
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	if (state_ == State::deflate && inflator_ == nullptr) {
+		inflator_ = static_cast<tinfl_decompressor *>(malloc(sizeof(tinfl_decompressor)));
+		window_ = static_cast<uint8_t *>(malloc(TINFL_LZ_DICT_SIZE));
+		if (inflator_ == nullptr || window_ == nullptr) {
+			fail("Not enough memory to inflate the image");
+			return used;
+		}
+		tinfl_init(inflator_);
+		DEBUG_PRINTLN("Firmware image is gzip compressed");
+	}
+
+	return used;
+}
+
+size_t GzipFirmwareWriter::inflate(const uint8_t *data, size_t length)
+{
+	size_t used = 0;
+	for (;;) {
+		size_t inBytes = length - used;
+		size_t outBytes = TINFL_LZ_DICT_SIZE - windowOffset_;
+		// The window is used as a ring buffer, so only TINFL_LZ_DICT_SIZE bytes are ever needed
+		tinfl_status status = tinfl_decompress(inflator_, data + used, &inBytes, window_,
+			window_ + windowOffset_, &outBytes, TINFL_FLAG_HAS_MORE_INPUT);
+		used += inBytes;
+
+		if (outBytes > 0) {
+			if (writer_.write(window_ + windowOffset_, outBytes) != outBytes) {
+				fail("Writing firmware failed: " + writer_.getError());
+				return used;
+			}
+			inflatedSize_ += outBytes;
+			crc_ = crc32_le(crc_, window_ + windowOffset_, outBytes);
+			windowOffset_ = (windowOffset_ + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+		}
+
+		if (status < TINFL_STATUS_DONE) {
+			fail("Compressed firmware image is corrupt");
+			return used;
+		}
+
+		if (status == TINFL_STATUS_DONE) {
+			state_ = State::trailer;
+			fieldLength_ = 0;
+			return used;
+		}
+
+		// Everything consumed and the window has been flushed: wait for the next chunk
+		if (status == TINFL_STATUS_NEEDS_MORE_INPUT && used == length) {
+			return used;
+		}
+	}
+}
+
+size_t GzipFirmwareWriter::parseTrailer(const uint8_t *data, size_t length)
+{
+	size_t used = 0;
+	while (used < length && fieldLength_ < gzipTrailerLength) {
+		field_[fieldLength_++] = data[used++];
+	}
+
+	if (fieldLength_ == gzipTrailerLength) {
+		// CRC32 of the inflated image, then ISIZE, the size modulo 2^32. Both catch a broken image
+		// even if no MD5 has been given.
+		const uint32_t crc = field_[0] | (field_[1] << 8) | (field_[2] << 16) | (static_cast<uint32_t>(field_[3]) << 24);
+		const uint32_t size = field_[4] | (field_[5] << 8) | (field_[6] << 16) | (static_cast<uint32_t>(field_[7]) << 24);
+		if (crc != crc_) {
+			fail("CRC of the inflated firmware image does not match");
+		} else if (size != inflatedSize_) {
+			fail("Size of the inflated firmware image does not match");
+		} else {
+			state_ = State::done;
+		}
+		release();
+	}
+
+	return used;
+}
+
+bool GzipFirmwareWriter::end(const String &md5)
+{
+	if (isCompressed() && state_ != State::done) {
+		if (state_ != State::failed) {
+			fail("Compressed firmware image is incomplete");
+		}
+		writer_.abort();
+		release();
+		return false;
+	}
+
+	// Less than two bytes have been received so far
+	if (state_ == State::detect && fieldLength_ > 0) {
+		writer_.write(field_, fieldLength_);
+	}
+
+	return writer_.end(md5);
+}
+
+void GzipFirmwareWriter::abort()
+{
+	release();
+	writer_.abort();
+}
+
+String GzipFirmwareWriter::getError() const
+{
+	return (error_.length() != 0) ? error_ : writer_.getError();
+}
+
+void GzipFirmwareWriter::fail(const String &reason)
+{
+	error_ = reason;
+	state_ = State::failed;
+}
+
+void GzipFirmwareWriter::release()
+{
+	free(inflator_);
+	inflator_ = nullptr;
+	free(window_);
+	window_ = nullptr;
+}
+
+UpdateProgressPrinter::UpdateProgressPrinter(uint32_t interval)
+	: interval_(interval)
+{
+}
+
+void UpdateProgressPrinter::start()
+{
+	startTime_ = millis();
+	lastPrint_ = 0;
+	progress_ = {};
+}
+
+void UpdateProgressPrinter::print(size_t written, size_t total)
+{
+	const uint32_t elapsed = millis() - startTime_;
+	const uint32_t rate = (elapsed == 0) ? 0 : static_cast<uint32_t>((static_cast<uint64_t>(written) * 1000) / elapsed);
+	print({written, total, elapsed, rate});
+}
+
+void UpdateProgressPrinter::print(const FirmwareUpdateProgress &progress)
+{
+	progress_ = progress;
+	if (lastPrint_ != 0 && millis() - lastPrint_ < interval_) {
+		return;
+	}
+	lastPrint_ = millis();
+
+	if (progress.total != 0) {
+		// 64 bit as written * 100 overflows for images above 40 MB
+		const unsigned percent = static_cast<unsigned>((static_cast<uint64_t>(progress.written) * 100) / progress.total);
+		Serial.printf("Progress: %u of %u bytes (%u%%), %u bytes/s\r", static_cast<unsigned>(progress.written),
+			static_cast<unsigned>(progress.total), percent, progress.bytesPerSecond);
+	} else {
+		Serial.printf("Progress: %u bytes, %u bytes/s\r", static_cast<unsigned>(progress.written), progress.bytesPerSecond);
+	}
+}
+
+void UpdateProgressPrinter::finish()
+{
+	Serial.printf("\nTransferred %u bytes in %u ms (%u bytes/s)\n", static_cast<unsigned>(progress_.written),
+		progress_.elapsedMs, progress_.bytesPerSecond);
+}
+
+FirmwareUpload::FirmwareUpload(FirmwareWriter &writer, ProgressCallback progressCallback)
+	: writer_(writer)
+	, progressCallback_(std::move(progressCallback))
+{
+}
+
+bool FirmwareUpload::begin(size_t total, String md5)
+{
+	if (active_) {
+		abort("Superseded by a new upload");
+	}
+
+	md5_ = std::move(md5);
+	error_ = "";
+	total_ = total;
+	written_ = 0;
+	startTime_ = millis();
+
+	if (!writer_.begin(0)) {
+		fail("Could not start update: " + writer_.getError());
+		return false;
+	}
+
+	active_ = true;
+	return true;
+}
+
+bool FirmwareUpload::write(size_t offset, const uint8_t *data, size_t length)
+{
+	if (!active_) {
+		return false;
+	}
+
+	if (offset > written_) {
+		abort("Missing data in upload");
+		return false;
+	}
+
+	// Skip the part of a retransmitted chunk that has already been written
+	const size_t alreadyWritten = written_ - offset;
+	if (alreadyWritten >= length) {
+		return true;
+	}
+	data += alreadyWritten;
+	length -= alreadyWritten;
+
+	if (writer_.write(data, length) != length) {
+		abort("Writing firmware failed: " + writer_.getError());
+		return false;
+	}
+	written_ += length;
+
+	if (progressCallback_) {
+		progressCallback_(getProgress());
+	}
+	return true;
+}
+
+bool FirmwareUpload::end()
+{
+	if (!active_) {
+		return false;
+	}
+
+	active_ = false;
+	if (written_ == 0) {
+		writer_.abort();
+		fail("Empty firmware image");
+		return false;
+	}
+
+	if (!writer_.end(md5_)) {
+		fail("Verifying firmware failed: " + writer_.getError());
+		return false;
+	}
+
+	DEBUG_PRINTLN("Firmware update finished");
+	return true;
+}
+
+void FirmwareUpload::abort(const String &reason)
+{
+	if (active_) {
+		writer_.abort();
+		active_ = false;
+	}
+	fail(reason);
+}
+
+void FirmwareUpload::fail(const String &reason)
+{
+	error_ = reason;
+	Serial.println(error_);
+}
+
+FirmwareUpdateProgress FirmwareUpload::getProgress() const
+{
+	const uint32_t elapsed = millis() - startTime_;
+	// written_ * 1000 would overflow 32 bit for images above 4 MB
+	const uint32_t rate = (elapsed == 0) ? 0 : static_cast<uint32_t>((static_cast<uint64_t>(written_) * 1000) / elapsed);
+	return {written_, total_, elapsed, rate};
+}
@@ -0,0 +1,204 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#ifndef FirmwareUpdate_h
+#define FirmwareUpdate_h
+
+#include <Arduino.h>
+#include <FS.h>
+#include <MD5Builder.h>
+#include <functional>
+#include <rom/miniz.h>
+
+/**
+	Destination of a firmware image.
+	The image is handed over in chunks as they arrive, nothing is buffered in between.
+*/
+class FirmwareWriter {
+	public:
+		virtual ~FirmwareWriter() = default;
+
+		// Prepares writing an image, "size" is 0 if it is not known in advance.
+		virtual bool begin(size_t size) = 0;
+		// Writes the next chunk, returns the number of bytes actually written.
+		virtual size_t write(const uint8_t *data, size_t length) = 0;
+		// Verifies the written image against "md5" (hex, no check if empty) and activates it.
+		virtual bool end(const String &md5) = 0;
+		// Discards everything written so far.
+		virtual void abort() = 0;
+		virtual String getError() const = 0;
+};
+
+// Writes into the next OTA partition through the Arduino Update class
+class UpdateFirmwareWriter : public FirmwareWriter {
+	public:
+		bool begin(size_t size) override;
+		size_t write(const uint8_t *data, size_t length) override;
+		bool end(const String &md5) override;
+		void abort() override;
+		String getError() const override;
+};
+
+/**
+	Writes the image into a file instead of flashing it, e.g. to keep it for later or to exercise
+	uploads without an OTA partition. The MD5 is calculated while writing, a file failing the
+	check given to end() is removed again, as is the file of an aborted update.
+*/
+class FileFirmwareWriter : public FirmwareWriter {
+	public:
+		// "fs" has to outlive the writer
+		FileFirmwareWriter(fs::FS &fs, const String &path);
+
+		bool begin(size_t size) override;
+		size_t write(const uint8_t *data, size_t length) override;
+		bool end(const String &md5) override;
+		void abort() override;
+		String getError() const override;
+
+	private:
+		fs::FS &fs_;
+		String path_;
+		File file_;
+		MD5Builder md5_;
+		String error_;
+};
+
+/**
+	Decorator that transparently inflates gzip compressed images.
+	Images not starting with the gzip magic are passed through unchanged. For compressed images
+	the deflate window (32 KB) and the decompressor state are only allocated during the update.
+	The MD5 given to end() refers to the uncompressed image.
+*/
+class GzipFirmwareWriter : public FirmwareWriter {
+	public:
+		explicit GzipFirmwareWriter(FirmwareWriter &writer);
+		~GzipFirmwareWriter() override;
+
+		bool begin(size_t size) override;
+		size_t write(const uint8_t *data, size_t length) override;
+		bool end(const String &md5) override;
+		void abort() override;
+		String getError() const override;
+
+		// True if the current image is gzip compressed (known after the first bytes)
+		bool isCompressed() const
+		{
+			return (state_ != State::detect && state_ != State::raw);
+		}
+
+	private:
+		enum class State {
+			detect,
+			raw,
+			header,
+			extraLength,
+			extra,
+			name,
+			comment,
+			headerCrc,
+			deflate,
+			trailer,
+			done,
+			failed,
+		};
+
+		// Consumes gzip header bytes, returns the number of bytes used
+		size_t parseHeader(const uint8_t *data, size_t length);
+		// Inflates deflate data, returns the number of bytes used or 0 on error
+		size_t inflate(const uint8_t *data, size_t length);
+		size_t parseTrailer(const uint8_t *data, size_t length);
+		void fail(const String &reason);
+		void release();
+
+		FirmwareWriter &writer_;
+		State state_ = State::detect;
+		String error_;
+		tinfl_decompressor *inflator_ = nullptr;
+		uint8_t *window_ = nullptr;
+		size_t windowOffset_ = 0;
+		// Scratch space for the fixed header, the trailer and length fields
+		uint8_t field_[10];
+		size_t fieldLength_ = 0;
+		uint8_t flags_ = 0;
+		size_t extraRemaining_ = 0;
+		// CRC32 of the inflated image so far, compared with the trailer
+		uint32_t crc_ = 0;
+		uint32_t inflatedSize_ = 0;
+};
+
+struct FirmwareUpdateProgress {
+	size_t written;
+	// Expected amount of bytes, 0 if unknown
+	size_t total;
+	uint32_t elapsedMs;
+	uint32_t bytesPerSecond;
+};
+
+// Prints the progress of an update with byte counts and transfer rate to the serial console
+class UpdateProgressPrinter {
+	public:
+		// Print at most once every "interval" milliseconds
+		explicit UpdateProgressPrinter(uint32_t interval = 1000);
+
+		void start();
+		// "total" may be 0 if unknown
+		void print(size_t written, size_t total);
+		void print(const FirmwareUpdateProgress &progress);
+		// Print the final transfer statistics
+		void finish();
+
+	private:
+		FirmwareUpdateProgress progress_ = {};
+		uint32_t interval_;
+		uint32_t startTime_ = 0;
+		uint32_t lastPrint_ = 0;
+};
+
+/**
+	Feeds a chunked upload into a FirmwareWriter.
+	Chunks have to arrive in order. A retransmitted chunk overlapping already written data is
+	only written from where the image left off, a gap aborts the update.
+*/
+class FirmwareUpload {
+	public:
+		using ProgressCallback = std::function<void(const FirmwareUpdateProgress &progress)>;
+
+		explicit FirmwareUpload(FirmwareWriter &writer, ProgressCallback progressCallback = {});
+
+		// Starts a new upload. "total" is only used for progress reporting.
+		bool begin(size_t total, String md5 = {});
+		// Handles a chunk starting at "offset" of the image. Returns false if the upload failed.
+		bool write(size_t offset, const uint8_t *data, size_t length);
+		// Verifies and activates the image. Returns false if the upload failed.
+		bool end();
+		void abort(const String &reason);
+
+		bool isActive() const
+		{
+			return active_;
+		}
+
+		const String& getError() const
+		{
+			return error_;
+		}
+
+		FirmwareUpdateProgress getProgress() const;
+
+	private:
+		void fail(const String &reason);
+
+		FirmwareWriter &writer_;
+		ProgressCallback progressCallback_;
+		String md5_;
+		String error_;
+		size_t total_ = 0;
+		size_t written_ = 0;
+		uint32_t startTime_ = 0;
+		bool active_ = false;
+};
+
+#endif
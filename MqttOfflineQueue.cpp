@@ -0,0 +1,433 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+#include "MqttOfflineQueue.hpp"
+
+#include "debug.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <rom/crc.h>
+
+namespace {
+	// Marks a record ("QR")
+	const constexpr uint16_t recordMagic = 0x5152;
+	// Marks the index file ("BCOQ")
+	const constexpr uint32_t indexMagic = 0x42434f51;
+	const constexpr uint8_t retainFlag = 0x01;
+
+	struct RecordHeader {
+		uint16_t magic;
+		uint8_t qos;
+		uint8_t flags;
+		uint16_t topicLength;
+		uint16_t payloadLength;
+		// Covers the fields above, the topic and the payload
+		uint32_t crc;
+	};
+
+	struct QueueIndex {
+		uint32_t magic;
+		uint32_t firstSegment;
+		uint32_t segmentCount;
+		uint32_t readOffset;
+		uint32_t crc;
+	};
+
+	uint32_t recordCrc(const RecordHeader &header, const char *topic, const char *payload)
+	{
+		uint32_t crc = crc32_le(0, reinterpret_cast<const uint8_t *>(&header), offsetof(RecordHeader, crc));
+		crc = crc32_le(crc, reinterpret_cast<const uint8_t *>(topic), header.topicLength);
+		return crc32_le(crc, reinterpret_cast<const uint8_t *>(payload), header.payloadLength);
+	}
+
+	uint32_t indexCrc(const QueueIndex &index)
+	{
+		return crc32_le(0, reinterpret_cast<const uint8_t *>(&index), offsetof(QueueIndex, crc));
+	}
+
+	size_t recordSize(const MqttOfflineQueue::Message &message)
+	{
+		return sizeof(RecordHeader) + message.topic.length() + message.payload.size();
+	}
+
+	// Reads the record at the current position of "file", returns its size or 0 if it is not valid.
+	// Records are never larger than "segmentSize".
+	size_t readRecord(File &file, MqttOfflineQueue::Message &message, size_t segmentSize)
+	{
+		RecordHeader header;
+		if (file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) != sizeof(header) ||
+			header.magic != recordMagic) {
+			return 0;
+		}
+		// A torn or garbage header must not make us allocate whatever its lengths say
+		const size_t bodySize = size_t(header.topicLength) + header.payloadLength;
+		if (sizeof(header) + bodySize > segmentSize || bodySize > file.size() - file.position()) {
+			return 0;
+		}
+
+		std::vector<char> topic(header.topicLength + 1, '\0');
+		message.payload.resize(header.payloadLength);
+		if (file.read(reinterpret_cast<uint8_t *>(topic.data()), header.topicLength) != header.topicLength ||
+			file.read(reinterpret_cast<uint8_t *>(message.payload.data()), header.payloadLength) != header.payloadLength ||
+			recordCrc(header, topic.data(), message.payload.data()) != header.crc) {
+			return 0;
+		}
+
+		message.topic = topic.data();
+		message.qos = header.qos;
+		message.retain = (header.flags & retainFlag) != 0;
+		return sizeof(header) + header.topicLength + header.payloadLength;
+	}
+}
+
+MqttOfflineQueue::MqttOfflineQueue(size_t ramCapacity, OverflowPolicy policy)
+	: policy_(policy),
+	ram_(ramCapacity)
+{
+}
+
+MqttOfflineQueue::MqttOfflineQueue(size_t ramCapacity, fs::FS &fs, String path, size_t segmentSize,
+		size_t maxSegments, OverflowPolicy policy)
+	: fs_(&fs),
+	path_(std::move(path)),
+	segmentSize_(segmentSize),
+	maxSegments_(std::max<size_t>(maxSegments, 1)),
+	policy_(policy),
+	ram_(ramCapacity)
+{
+}
+
+String MqttOfflineQueue::segmentPath(uint32_t segment) const
+{
+	return path_ + "." + String(segment);
+}
+
+bool MqttOfflineQueue::begin()
+{
+	if (!hasFiles()) {
+		return true;
+	}
+
+	firstSegment_ = 0;
+	segmentCount_ = 0;
+	readOffset_ = 0;
+	fileMessages_ = 0;
+	cacheValid_ = false;
+
+	File indexFile = fs_->open(path_ + ".idx", "r");
+	if (indexFile) {
+		QueueIndex index;
+		if (indexFile.read(reinterpret_cast<uint8_t *>(&index), sizeof(index)) == sizeof(index) &&
+			index.magic == indexMagic && index.crc == indexCrc(index)) {
+			firstSegment_ = index.firstSegment;
+			segmentCount_ = index.segmentCount;
+			readOffset_ = index.readOffset;
+		}
+		indexFile.close();
+	}
+
+	// Segments created after the index has been written last
+	while (fs_->exists(segmentPath(firstSegment_ + segmentCount_))) {
+		++segmentCount_;
+	}
+
+	for (size_t i = 0; i < segmentCount_; ++i) {
+		const uint32_t segment = firstSegment_ + i;
+		size_t end = 0;
+		fileMessages_ += countRecords(segment, (i == 0) ? readOffset_ : 0, end);
+
+		if (i + 1 == segmentCount_) {
+			File file = fs_->open(segmentPath(segment), "r");
+			// Never append behind a torn record, it would hide everything after it
+			writeOffset_ = (file && file.size() == end) ? end : segmentSize_;
+		}
+	}
+
+	if (fileMessages_ == 0) {
+		removeFiles();
+	}
+
+	DEBUG_PRINTF("Offline queue recovered %u messages\n", static_cast<unsigned>(fileMessages_));
+	return true;
+}
+
+size_t MqttOfflineQueue::countRecords(uint32_t segment, size_t offset, size_t &end)
+{
+	end = offset;
+	File file = fs_->open(segmentPath(segment), "r");
+	if (!file || !file.seek(offset)) {
+		return 0;
+	}
+
+	size_t count = 0;
+	Message message;
+	while (const size_t size = readRecord(file, message, segmentSize_)) {
+		end += size;
+		++count;
+	}
+	return count;
+}
+
+bool MqttOfflineQueue::push(const char *topic, uint8_t qos, bool retain, const char *payload, size_t length)
+{
+	if (payload != nullptr && length == 0) {
+		length = strlen(payload);
+	}
+	Message message{topic, std::vector<char>(payload, payload + length), qos, retain};
+
+	if (ram_.empty()) {
+		// Nothing is kept in RAM, write straight through
+		if (!hasFiles()) {
+			++dropped_;
+			return false;
+		}
+		File file;
+		const bool written = appendRecord(file, message);
+		if (!written) {
+			++dropped_;
+		}
+		return written;
+	}
+
+	if (ramCount_ == ram_.size() && !(hasFiles() && spill(1))) {
+		if (policy_ == OverflowPolicy::dropNewest) {
+			++dropped_;
+			return false;
+		}
+		dropRamFront();
+	}
+
+	ram_[(ramHead_ + ramCount_) % ram_.size()] = std::move(message);
+	++ramCount_;
+	return true;
+}
+
+void MqttOfflineQueue::dropRamFront()
+{
+	ram_[ramHead_] = Message{};
+	ramHead_ = (ramHead_ + 1) % ram_.size();
+	--ramCount_;
+	++dropped_;
+	if (fileMessages_ == 0) {
+		frontValid_ = false;
+	}
+}
+
+bool MqttOfflineQueue::spill(size_t count)
+{
+	File file;
+	for (size_t i = 0; i < count; ++i) {
+		if (!appendRecord(file, ram_[ramHead_])) {
+			return false;
+		}
+		ram_[ramHead_] = Message{};
+		ramHead_ = (ramHead_ + 1) % ram_.size();
+		--ramCount_;
+	}
+	return true;
+}
+
+bool MqttOfflineQueue::appendRecord(File &file, const Message &message)
+{
+	const size_t size = recordSize(message);
+	if (size > segmentSize_ || message.topic.length() > UINT16_MAX || message.payload.size() > UINT16_MAX) {
+		DEBUG_PRINTLN("Message too large for the offline queue");
+		return false;
+	}
+
+	if (segmentCount_ == 0 || writeOffset_ + size > segmentSize_) {
+		if (file) {
+			file.close();
+		}
+		if (segmentCount_ == maxSegments_) {
+			if (policy_ == OverflowPolicy::dropNewest) {
+				return false;
+			}
+			dropFirstSegment();
+		}
+		++segmentCount_;
+		writeOffset_ = 0;
+		// The new segment may be lost on a reset before the index is written, begin() looks for it
+		writeIndex();
+	}
+
+	if (!file) {
+		file = fs_->open(segmentPath(firstSegment_ + segmentCount_ - 1), "a");
+		if (!file) {
+			DEBUG_PRINTLN("Could not open offline queue segment");
+			return false;
+		}
+	}
+
+	RecordHeader header{recordMagic, message.qos, static_cast<uint8_t>(message.retain ? retainFlag : 0),
+		static_cast<uint16_t>(message.topic.length()), static_cast<uint16_t>(message.payload.size()), 0};
+	header.crc = recordCrc(header, message.topic.c_str(), message.payload.data());
+
+	const size_t written = file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header)) +
+		file.write(reinterpret_cast<const uint8_t *>(message.topic.c_str()), header.topicLength) +
+		file.write(reinterpret_cast<const uint8_t *>(message.payload.data()), header.payloadLength);
+	if (written != size) {
+		DEBUG_PRINTLN("Could not write offline queue segment");
+		// Start over with a new segment, the torn record ends this one
+		writeOffset_ = segmentSize_;
+		file.close();
+		return false;
+	}
+
+	writeOffset_ += size;
+	++fileMessages_;
+	return true;
+}
+
+void MqttOfflineQueue::dropFirstSegment()
+{
+	size_t end = 0;
+	const size_t count = countRecords(firstSegment_, readOffset_, end);
+	fs_->remove(segmentPath(firstSegment_));
+	++firstSegment_;
+	--segmentCount_;
+	readOffset_ = 0;
+	fileMessages_ -= std::min(count, fileMessages_);
+	dropped_ += count;
+	cacheValid_ = false;
+	frontValid_ = false;
+	DEBUG_PRINTF("Offline queue full, dropped %u messages\n", static_cast<unsigned>(count));
+}
+
+bool MqttOfflineQueue::readFileFront()
+{
+	while (!cacheValid_ && fileMessages_ > 0 && segmentCount_ > 0) {
+		bool corrupt = false;
+		File file = fs_->open(segmentPath(firstSegment_), "r");
+		if (file && readOffset_ < file.size() && file.seek(readOffset_)) {
+			cacheSize_ = readRecord(file, cache_, segmentSize_);
+			if (cacheSize_ > 0) {
+				cacheValid_ = true;
+				break;
+			}
+			DEBUG_PRINTLN("Corrupt record in offline queue, skipping the rest of the segment");
+			corrupt = true;
+			++dropped_;
+		}
+		file.close();
+
+		// Continue with the next segment
+		fs_->remove(segmentPath(firstSegment_));
+		++firstSegment_;
+		--segmentCount_;
+		readOffset_ = 0;
+		writeIndex();
+
+		// The records skipped are unknown, count the remaining ones
+		if (corrupt) {
+			fileMessages_ = 0;
+			for (size_t i = 0; i < segmentCount_; ++i) {
+				size_t end = 0;
+				fileMessages_ += countRecords(firstSegment_ + i, 0, end);
+			}
+		}
+	}
+
+	if (!cacheValid_ && fileMessages_ == 0) {
+		removeFiles();
+	}
+	return cacheValid_;
+}
+
+bool MqttOfflineQueue::front(Message &message)
+{
+	if (fileMessages_ > 0 && readFileFront()) {
+		message = cache_;
+	} else if (ramCount_ > 0) {
+		message = ram_[ramHead_];
+	} else {
+		return false;
+	}
+
+	frontValid_ = true;
+	return true;
+}
+
+void MqttOfflineQueue::pop()
+{
+	if (!frontValid_) {
+		return;
+	}
+	frontValid_ = false;
+
+	// A message returned from RAM may have been spilled since, it is the first record of the files then
+	if (fileMessages_ > 0) {
+		if (!readFileFront()) {
+			return;
+		}
+		readOffset_ += cacheSize_;
+		cacheValid_ = false;
+		--fileMessages_;
+		if (fileMessages_ == 0) {
+			removeFiles();
+		}
+		return;
+	}
+
+	if (ramCount_ > 0) {
+		ram_[ramHead_] = Message{};
+		ramHead_ = (ramHead_ + 1) % ram_.size();
+		--ramCount_;
+	}
+}
+
+bool MqttOfflineQueue::persist()
+{
+	if (!hasFiles()) {
+		return false;
+	}
+	if (!spill(ramCount_)) {
+		return false;
+	}
+	return (segmentCount_ == 0 || writeIndex());
+}
+
+void MqttOfflineQueue::clear()
+{
+	for (auto &message : ram_) {
+		message = Message{};
+	}
+	ramHead_ = 0;
+	ramCount_ = 0;
+	frontValid_ = false;
+	if (hasFiles()) {
+		removeFiles();
+	}
+}
+
+void MqttOfflineQueue::removeFiles()
+{
+	for (size_t i = 0; i < segmentCount_; ++i) {
+		fs_->remove(segmentPath(firstSegment_ + i));
+	}
+	fs_->remove(path_ + ".idx");
+	firstSegment_ = 0;
+	segmentCount_ = 0;
+	readOffset_ = 0;
+	writeOffset_ = 0;
+	fileMessages_ = 0;
+	cacheValid_ = false;
+}
+
+bool MqttOfflineQueue::writeIndex()
+{
+	QueueIndex index{indexMagic, firstSegment_, static_cast<uint32_t>(segmentCount_),
+		static_cast<uint32_t>(readOffset_), 0};
+	index.crc = indexCrc(index);
+
+	File indexFile = fs_->open(path_ + ".idx", "w");
+	if (!indexFile) {
+		DEBUG_PRINTLN("Could not write offline queue index");
+		return false;
+	}
+	const bool written = (indexFile.write(reinterpret_cast<const uint8_t *>(&index), sizeof(index)) == sizeof(index));
+	indexFile.close();
+	return written;
+}
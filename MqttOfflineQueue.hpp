@@ -0,0 +1,121 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#ifndef MqttOfflineQueue_h
+#define MqttOfflineQueue_h
+
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+#include <vector>
+
+/**
+	Keeps MQTT messages that could not be sent, oldest first.
+	The newest messages are kept in a ring buffer in RAM. When it is full, the oldest message of the ring
+	is moved to the end of a log of segment files "<path>.<n>", so the files always hold the older part
+	of the queue. Every record carries a CRC, a record torn by a reset ends its segment.
+	The read position is stored in "<path>.idx" whenever a segment is added or removed and by persist(),
+	so messages sent since then may be sent again after a reset.
+	Not thread-safe.
+*/
+class MqttOfflineQueue {
+	public:
+		// Which message to give up if there is no space left
+		enum class OverflowPolicy {
+			dropOldest,	///< Make space by dropping the oldest messages (a whole segment, if spilled)
+			dropNewest,	///< Reject the message being queued
+		};
+
+		struct Message {
+			String topic;
+			std::vector<char> payload;
+			uint8_t qos;
+			bool retain;
+		};
+
+		// Keeps up to "ramCapacity" messages in RAM only
+		explicit MqttOfflineQueue(size_t ramCapacity, OverflowPolicy policy = OverflowPolicy::dropOldest);
+		// Spills to at most "maxSegments" files of "segmentSize" bytes each. SPIFFS limits file names to
+		// 31 characters, keep "path" short.
+		MqttOfflineQueue(size_t ramCapacity, fs::FS &fs, String path, size_t segmentSize = 4096,
+			size_t maxSegments = 8, OverflowPolicy policy = OverflowPolicy::dropOldest);
+
+		// Recovers the messages spilled before a reset or deep sleep. Mount the file system before.
+		bool begin();
+		// Returns false if the message has been rejected
+		bool push(const char *topic, uint8_t qos, bool retain, const char *payload, size_t length);
+		// Copies the oldest message into "message", returns false if the queue is empty
+		bool front(Message &message);
+		// Removes the message returned by front(), unless it has been dropped in between
+		void pop();
+		// Moves all messages from RAM to flash and stores the read position, e.g. before deep sleep
+		bool persist();
+		void clear();
+
+		size_t size() const
+		{
+			return ramCount_ + fileMessages_;
+		}
+
+		bool empty() const
+		{
+			return size() == 0;
+		}
+
+		// Messages given up due to the overflow policy or corrupt records
+		size_t dropped() const
+		{
+			return dropped_;
+		}
+
+	private:
+		bool hasFiles() const
+		{
+			return fs_ != nullptr;
+		}
+
+		String segmentPath(uint32_t segment) const;
+		// Appends "message" to the last segment, starting a new one if needed
+		bool appendRecord(File &file, const Message &message);
+		// Moves the "count" oldest messages of the ring to the files
+		bool spill(size_t count);
+		// Reads the record at the read position into cache_, drops segments which have been read
+		bool readFileFront();
+		// Counts the valid records of "segment" from "offset" on, "end" is set behind the last one
+		size_t countRecords(uint32_t segment, size_t offset, size_t &end);
+		void dropFirstSegment();
+		void removeFiles();
+		bool writeIndex();
+		void dropRamFront();
+
+		fs::FS *fs_ = nullptr;
+		String path_;
+		size_t segmentSize_ = 0;
+		size_t maxSegments_ = 0;
+		OverflowPolicy policy_;
+
+		std::vector<Message> ram_;
+		size_t ramHead_ = 0;
+		size_t ramCount_ = 0;
+
+		uint32_t firstSegment_ = 0;
+		size_t segmentCount_ = 0;
+		// Position of the oldest record in the first segment
+		size_t readOffset_ = 0;
+		// Size of the last segment
+		size_t writeOffset_ = 0;
+		size_t fileMessages_ = 0;
+
+		// Oldest record of the files, read by front()
+		Message cache_;
+		size_t cacheSize_ = 0;
+		bool cacheValid_ = false;
+		// The message returned by front() has not been dropped since
+		bool frontValid_ = false;
+		size_t dropped_ = 0;
+};
+
+#endif
@@ -0,0 +1,158 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#include "TaskManager.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+	// Smallest stack accepted from the configuration, below that FreeRTOS itself does not fit
+	const constexpr uint32_t minimumStackSize = 1024;
+
+	// Reads an unsigned number from the configuration, returns false if it is not set or invalid
+	bool getNumber(const Configuration &configuration, const String &key, long &value)
+	{
+		const String &text = configuration.get(key);
+		if (text.length() == 0 || !isdigit(text[0])) {
+			return false;
+		}
+		value = text.toInt();
+		return true;
+	}
+
+	// Core numbers out of range fall back to no affinity
+	BaseType_t toCore(long value)
+	{
+		return (value >= 0 && value < portNUM_PROCESSORS) ? static_cast<BaseType_t>(value) : tskNO_AFFINITY;
+	}
+}
+
+TaskManager::TaskManager()
+{
+	mutex_ = xSemaphoreCreateMutex();
+}
+
+TaskManager::~TaskManager()
+{
+	vSemaphoreDelete(mutex_);
+}
+
+void TaskManager::configure(const Configuration &configuration)
+{
+	configuration_ = &configuration;
+}
+
+TaskSettings TaskManager::getSettings(const char *name, const TaskSettings &defaults) const
+{
+	TaskSettings settings = defaults;
+	if (configuration_ == nullptr) {
+		return settings;
+	}
+
+	long value = 0;
+	if (getNumber(*configuration_, getKeyName(ConfigurationKey::taskCore), value)) {
+		settings.core = toCore(value);
+	}
+
+	const String prefix = String{"Task"} + name;
+	if (getNumber(*configuration_, prefix + "Core", value)) {
+		settings.core = toCore(value);
+	}
+	if (getNumber(*configuration_, prefix + "Priority", value) && value < configMAX_PRIORITIES) {
+		settings.priority = static_cast<UBaseType_t>(value);
+	}
+	if (getNumber(*configuration_, prefix + "Stack", value) && value >= static_cast<long>(minimumStackSize)) {
+		settings.stackSize = static_cast<uint32_t>(value);
+	}
+	return settings;
+}
+
+TaskHandle_t TaskManager::spawn(const char *name, TaskFunction_t function, void *parameter, const TaskSettings &defaults)
+{
+	const TaskSettings settings = getSettings(name, defaults);
+	TaskHandle_t handle = nullptr;
+	// Held across the creation, so a task calling finish() right away waits until it has been recorded
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	if (xTaskCreatePinnedToCore(function, name, settings.stackSize, parameter, settings.priority, &handle, settings.core) != pdPASS) {
+		xSemaphoreGive(mutex_);
+		DEBUG_PRINTF("Could not create task %s\n", name);
+		return nullptr;
+	}
+
+	// A task spawned again (e.g. after a restart of its component) keeps its record and high-water mark
+	auto record = std::find_if(records_.begin(), records_.end(), [name](const TaskRecord &record) {
+		return record.name == name;
+	});
+	if (record == records_.end()) {
+		records_.push_back(TaskRecord{name, settings, handle, settings.stackSize, true});
+	} else {
+		record->settings = settings;
+		record->handle = handle;
+		record->running = true;
+	}
+	xSemaphoreGive(mutex_);
+	return handle;
+}
+
+void TaskManager::finish(TaskHandle_t handle)
+{
+	if (handle == nullptr) {
+		handle = xTaskGetCurrentTaskHandle();
+	}
+
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	for (auto &record : records_) {
+		if (record.running && record.handle == handle) {
+			record.minimumFreeStack = std::min<uint32_t>(record.minimumFreeStack, uxTaskGetStackHighWaterMark(handle));
+			record.handle = nullptr;
+			record.running = false;
+		}
+	}
+	xSemaphoreGive(mutex_);
+}
+
+void TaskManager::update()
+{
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	for (auto &record : records_) {
+		if (record.running) {
+			record.minimumFreeStack = std::min<uint32_t>(record.minimumFreeStack, uxTaskGetStackHighWaterMark(record.handle));
+		}
+	}
+	xSemaphoreGive(mutex_);
+}
+
+std::vector<TaskRecord> TaskManager::getTasks() const
+{
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	std::vector<TaskRecord> records = records_;
+	xSemaphoreGive(mutex_);
+	return records;
+}
+
+String TaskManager::toString()
+{
+	update();
+
+	std::ostringstream text;
+	text << "Tasks:" << std::endl;
+	for (const auto &record : getTasks()) {
+		text << "  " << record.name.c_str() << ": core ";
+		if (record.settings.core == tskNO_AFFINITY) {
+			text << "any";
+		} else {
+			text << record.settings.core;
+		}
+		text << ", priority " << record.settings.priority << ", stack " << record.settings.stackSize
+			<< " (" << record.settings.stackSize - record.minimumFreeStack << " used at most)";
+		if (!record.running) {
+			text << ", finished";
+		}
+		text << std::endl;
+	}
+	return {text.str().c_str()};
+}
@@ -0,0 +1,97 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#ifndef TaskManager_h
+#define TaskManager_h
+
+#include <Arduino.h>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "Configuration.hpp"
+
+// Where and how a task runs
+struct TaskSettings {
+	// In bytes
+	uint32_t stackSize;
+	UBaseType_t priority;
+	// Core to pin the task to or tskNO_AFFINITY
+	BaseType_t core;
+};
+
+struct TaskRecord {
+	String name;
+	TaskSettings settings;
+	// Only valid while "running" is true
+	TaskHandle_t handle;
+	// Smallest amount of stack that has been free so far (high-water mark), in bytes
+	uint32_t minimumFreeStack;
+	bool running;
+};
+
+/**
+	Creates the tasks of Basecamp with settings from the configuration and keeps track of
+	their stack usage.
+	"TaskCore" pins all tasks to one core (0 or 1), e.g. to keep them off the core running a
+	latency sensitive loop. "Task<name>Core", "Task<name>Priority" and "Task<name>Stack" override
+	the settings of a single task, e.g. "TaskDNSTaskStack".
+*/
+class TaskManager {
+	public:
+		TaskManager();
+		~TaskManager();
+
+		// Takes the settings from "configuration", which has to outlive the manager.
+		// Only affects tasks spawned afterwards.
+		void configure(const Configuration &configuration);
+
+		// Creates the task "name" with "defaults" unless the configuration overrides them.
+		// Returns nullptr on failure.
+		TaskHandle_t spawn(const char *name, TaskFunction_t function, void *parameter, const TaskSettings &defaults);
+
+		// Records the final stack usage of "handle" (nullptr: the calling task). Call it right
+		// before the task is deleted, the handle becomes invalid afterwards.
+		void finish(TaskHandle_t handle = nullptr);
+
+		// Updates the high-water marks of all running tasks
+		void update();
+
+		// All tasks spawned so far, including finished ones. Call update() first for current values.
+		std::vector<TaskRecord> getTasks() const;
+
+		// Calls "visit" with every running task, without copying them. The manager is locked meanwhile,
+		// so "visit" must not call it and must not keep the record.
+		template <typename Visitor>
+		void forEachRunning(Visitor visit) const;
+
+		// One line per task with its settings and high-water mark
+		String toString();
+
+	private:
+		// Settings of "name" with the configured overrides applied
+		TaskSettings getSettings(const char *name, const TaskSettings &defaults) const;
+
+		const Configuration *configuration_ = nullptr;
+		// Guards records_, tasks may be spawned and finished from any task
+		SemaphoreHandle_t mutex_ = nullptr;
+		std::vector<TaskRecord> records_;
+};
+
+template <typename Visitor>
+void TaskManager::forEachRunning(Visitor visit) const
+{
+	xSemaphoreTake(mutex_, portMAX_DELAY);
+	for (const auto &record : records_) {
+		if (record.running) {
+			visit(record);
+		}
+	}
+	xSemaphoreGive(mutex_);
+}
+
+#endif
@@ -0,0 +1,234 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#include "Telemetry.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <mutex>
+#include <rom/crc.h>
+#include <rom/rtc.h>
+#include <string>
+#ifndef BASECAMP_NOWIFI
+#include <WiFi.h>
+#endif
+
+#include "debug.hpp"
+#include "mqttPayload.hpp"
+
+const constexpr uint32_t Telemetry::maxSuppressed;
+
+namespace {
+	// Publishes the records, the JSON and the task list need some stack
+	const constexpr TaskSettings telemetryTaskSettings{4096, 1, tskNO_AFFINITY};
+	// Tasks in "<topic>/stacks", Basecamp itself runs less than half of them
+	const constexpr size_t maxStackFields = 16;
+}
+
+struct Telemetry::State {
+	State(MqttGuardInterface &mqttGuard, AsyncMqttClient &mqttClient, TaskManager &taskManager, EventBus &bus,
+		const String &topicName, uint32_t interval)
+		: guard(mqttGuard)
+		, client(mqttClient)
+		, tasks(taskManager)
+		, eventBus(bus)
+		, topic(topicName.c_str())
+		, stacksTopic(topic + "/stacks")
+		, intervalMs(interval)
+	{
+	}
+
+	// With "stackCount" set, the names and high-water marks of the running tasks are copied to
+	// stackFields as well, the caller has to hold "mutex"
+	TelemetryRecord collect(size_t *stackCount = nullptr)
+	{
+		TelemetryRecord record;
+		record.uptime = static_cast<uint32_t>(esp_timer_get_time() / 1000000);
+		record.freeHeap = ESP.getFreeHeap();
+		record.minFreeHeap = ESP.getMinFreeHeap();
+		record.largestFreeBlock = static_cast<uint32_t>(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+#ifndef BASECAMP_NOWIFI
+		record.rssi = (WiFi.status() == WL_CONNECTED) ? WiFi.RSSI() : 0;
+#else
+		record.rssi = 0;
+#endif
+		record.resetReason = static_cast<uint32_t>(rtc_get_reset_reason(0));
+		record.wifiDisconnects = wifiDisconnects;
+		record.mqttDisconnects = mqttDisconnects;
+		record.mqtt = guard.mqttStatistics();
+		record.pendingPackets = static_cast<uint32_t>(guard.mqttRemainingPackets());
+
+		// Finished tasks keep their last high-water mark, which says nothing about the device now
+		record.minFreeStack = 0;
+		size_t running = 0;
+		size_t count = 0;
+		tasks.update();
+		tasks.forEachRunning([&](const TaskRecord &task) {
+			record.minFreeStack = (running++ == 0) ? task.minimumFreeStack : std::min(record.minFreeStack, task.minimumFreeStack);
+			if (stackCount != nullptr && count < maxStackFields) {
+				// The record may move once the manager is unlocked, so the name is copied
+				strncpy(stackNames[count].data(), task.name.c_str(), stackNames[count].size() - 1);
+				stackFields[count] = {stackNames[count].data(), task.minimumFreeStack};
+				count++;
+			}
+		});
+		if (stackCount != nullptr) {
+			*stackCount = count;
+		}
+		return record;
+	}
+
+	bool publish(bool force)
+	{
+		// Old values are of no use, so nothing is queued
+		if (!client.connected()) {
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		size_t stackCount = 0;
+		const TelemetryRecord record = collect(&stackCount);
+		if (!filter.shouldPublish(record, force)) {
+			return false;
+		}
+
+		const char *payload = mqttPayload::json({
+			{"up", record.uptime},
+			{"heap", record.freeHeap},
+			{"minHeap", record.minFreeHeap},
+			{"block", record.largestFreeBlock},
+			{"rssi", record.rssi},
+			{"reset", record.resetReason},
+			{"wifiDrops", record.wifiDisconnects},
+			{"mqttDrops", record.mqttDisconnects},
+			{"stack", record.minFreeStack},
+			{"acked", record.mqtt.acknowledged},
+			{"timeouts", record.mqtt.timeouts},
+			{"resets", record.mqtt.resets},
+			{"pending", record.pendingPackets},
+		});
+		// Past MqttGuardInterface, so it is never put into the offline queue
+		if (payload == nullptr || client.publish(topic.c_str(), 0, true, payload) == 0) {
+			DEBUG_PRINTLN("Could not publish telemetry");
+			return false;
+		}
+		filter.published(record);
+
+		// High-water marks only go down, so this is rarely sent
+		const char *stacks = mqttPayload::json(stackFields.data(), stackCount);
+		if (stacks == nullptr) {
+			DEBUG_PRINTLN("Task stacks do not fit into a payload");
+			return true;
+		}
+		const uint32_t digest = crc32_le(0, reinterpret_cast<const uint8_t *>(stacks), strlen(stacks));
+		if ((force || !stacksPublished || digest != stacksDigest) &&
+			client.publish(stacksTopic.c_str(), 0, true, stacks) != 0) {
+			stacksDigest = digest;
+			stacksPublished = true;
+		}
+		return true;
+	}
+
+	MqttGuardInterface &guard;
+	AsyncMqttClient &client;
+	TaskManager &tasks;
+	EventBus &eventBus;
+	const std::string topic;
+	const std::string stacksTopic;
+	const uint32_t intervalMs;
+	// Counted by the event subscribers
+	std::atomic<uint32_t> wifiDisconnects{0};
+	std::atomic<uint32_t> mqttDisconnects{0};
+
+	// Guards everything below, the application may publish as well
+	std::mutex mutex;
+	TelemetryFilter filter;
+	// Reused for every "<topic>/stacks", the fields point to the names
+	std::array<std::array<char, configMAX_TASK_NAME_LEN>, maxStackFields> stackNames = {};
+	std::array<mqttPayload::JsonField, maxStackFields> stackFields;
+	// CRC of the last published "<topic>/stacks"
+	uint32_t stacksDigest = 0;
+	bool stacksPublished = false;
+};
+
+Telemetry::Telemetry(MqttGuardInterface &guard, AsyncMqttClient &client, TaskManager &tasks, EventBus &eventBus,
+	const String &topic, uint32_t intervalMs)
+	: state_(std::make_shared<State>(guard, client, tasks, eventBus, topic, intervalMs))
+{
+}
+
+Telemetry::~Telemetry()
+{
+	stop();
+}
+
+bool Telemetry::start()
+{
+	if (task_ != nullptr) {
+		return true;
+	}
+
+	// The subscribers and the task keep the state alive until they are gone
+	auto state = state_;
+	wifiSubscription_ = state_->eventBus.subscribe(SystemEventType::wifiDisconnected, [state](const SystemEvent &) {
+		state->wifiDisconnects++;
+	});
+	mqttSubscription_ = state_->eventBus.subscribe(SystemEventType::mqttDisconnected, [state](const SystemEvent &) {
+		state->mqttDisconnects++;
+	});
+
+	auto *taskState = new std::shared_ptr<State>(state_);
+	task_ = state_->tasks.spawn("TelemetryTask", &Telemetry::run, taskState, telemetryTaskSettings);
+	if (task_ == nullptr) {
+		delete taskState;
+		stop();
+		return false;
+	}
+	return true;
+}
+
+void Telemetry::stop()
+{
+	if (wifiSubscription_ != 0) {
+		state_->eventBus.unsubscribe(wifiSubscription_);
+		wifiSubscription_ = 0;
+	}
+	if (mqttSubscription_ != 0) {
+		state_->eventBus.unsubscribe(mqttSubscription_);
+		mqttSubscription_ = 0;
+	}
+	if (task_ != nullptr) {
+		// The task only ends after the notification, so its handle is still valid
+		state_->tasks.finish(task_);
+		xTaskNotifyGive(task_);
+		task_ = nullptr;
+	}
+}
+
+TelemetryRecord Telemetry::collect()
+{
+	return state_->collect();
+}
+
+bool Telemetry::publish(bool force)
+{
+	return state_->publish(force);
+}
+
+// Publishes a record every interval until it is notified by stop()
+void Telemetry::run(void *taskState)
+{
+	auto *state = static_cast<std::shared_ptr<State> *>(taskState);
+	while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((*state)->intervalMs)) == 0) {
+		(*state)->publish(false);
+	}
+	delete state;
+	vTaskDelete(nullptr);
+}
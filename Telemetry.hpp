@@ -0,0 +1,64 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#ifndef Telemetry_h
+#define Telemetry_h
+
+#include <Arduino.h>
+#include <memory>
+
+#include "Component.hpp"
+#include "EventBus.hpp"
+#include "TaskManager.hpp"
+#include "mqttGuardInterface.hpp"
+#include "telemetryFilter.hpp"
+
+/**
+	Publishes the health of the device periodically, started by Basecamp as component "telemetry".
+	Every interval a TelemetryRecord is collected and published as compact JSON to "<topic>", e.g.
+	{"up":3600,"heap":123456,"minHeap":98765,"block":65536,"rssi":-61,"reset":1,"wifiDrops":0,
+	"mqttDrops":1,"stack":812,"acked":240,"timeouts":0,"resets":1,"pending":0}, formatted without
+	heap allocations. The high-water marks of the single running tasks (up to 16) go to
+	"<topic>/stacks" whenever they change, finished tasks are left out.
+	Records which differ only slightly from the last published one are suppressed, but at most
+	maxSuppressed times in a row, see TelemetryFilter. Nothing is published or queued while MQTT
+	is not connected.
+	Basecamp::begin() and beginAsync() start it if "TelemetryInterval" is set. beginFastWake() does
+	not, a device awake for a moment would hardly ever reach the interval. Start the component
+	"telemetry" or call publish() after a fast wake if it is needed.
+*/
+class Telemetry : public Component {
+	public:
+		// Records suppressed in a row before one is published anyway
+		static const constexpr uint32_t maxSuppressed = TelemetryFilter::maxSuppressed;
+
+		// All references have to outlive the telemetry
+		Telemetry(MqttGuardInterface &guard, AsyncMqttClient &client, TaskManager &tasks, EventBus &eventBus,
+			const String &topic, uint32_t intervalMs);
+		~Telemetry() override;
+
+		bool start() override;
+		void stop() override;
+
+		// The current values
+		TelemetryRecord collect();
+		// Publishes the current values unless they are close to the last published ones.
+		// Returns true if they have been published.
+		bool publish(bool force = false);
+
+	private:
+		// Values and counters shared with the task and the event subscribers, which may outlive this instance
+		struct State;
+
+		static void run(void *state);
+
+		std::shared_ptr<State> state_;
+		TaskHandle_t task_ = nullptr;
+		EventBus::SubscriptionId wifiSubscription_ = 0;
+		EventBus::SubscriptionId mqttSubscription_ = 0;
+};
+
+#endif
@@ -0,0 +1,222 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#include "WakeTimeline.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <esp_timer.h>
+#include <rom/crc.h>
+#include <sstream>
+
+const constexpr size_t WakeTimeline::phaseCount;
+
+namespace {
+	// Marks a valid timeline ("WTWT")
+	const constexpr uint32_t wakeTimelineMagic = 0x57545754;
+
+	struct PhaseAggregate {
+		uint32_t count;
+		uint32_t minUs;
+		uint32_t maxUs;
+		uint64_t sumUs;
+	};
+
+	struct RtcWakeTimeline {
+		uint32_t magic;
+		WakeTimeline::Record previous;
+		PhaseAggregate aggregates[WakeTimeline::phaseCount];
+		uint32_t wakes;
+		// CRC of everything above
+		uint32_t crc;
+		// Written throughout the wake, so it is not covered by the CRC
+		WakeTimeline::Record current;
+	};
+
+	// Not initialized on boot, so it keeps its value over resets as well as deep sleep
+	RTC_NOINIT_ATTR RtcWakeTimeline rtcWakeTimeline;
+
+	const WakeTimeline::Record emptyRecord = {};
+
+	uint32_t timelineCrc(const RtcWakeTimeline &timeline)
+	{
+		return crc32_le(0, reinterpret_cast<const uint8_t *>(&timeline), offsetof(RtcWakeTimeline, crc));
+	}
+
+	bool isValid(const RtcWakeTimeline &timeline)
+	{
+		return (timeline.magic == wakeTimelineMagic && timeline.crc == timelineCrc(timeline));
+	}
+
+	void writeRecord(std::ostringstream &json, const WakeTimeline::Record &record)
+	{
+		json << "{";
+		bool first = true;
+		for (size_t i = 0; i < WakeTimeline::phaseCount; i++) {
+			if (record.us[i] == 0) {
+				continue;
+			}
+			json << (first ? "" : ",") << "\"" << WakeTimeline::getPhaseName(static_cast<WakePhase>(i)) << "\":" << record.us[i];
+			first = false;
+		}
+		json << "}";
+	}
+}
+
+void WakeTimeline::start()
+{
+	auto &timeline = rtcWakeTimeline;
+	if (!isValid(timeline)) {
+		// Power cycle, nothing to keep
+		memset(&timeline, 0, sizeof(timeline));
+		timeline.magic = wakeTimelineMagic;
+	} else if (timeline.current.us[static_cast<size_t>(WakePhase::begin)] != 0) {
+		timeline.previous = timeline.current;
+		for (size_t i = 0; i < phaseCount; i++) {
+			const uint32_t us = timeline.previous.us[i];
+			if (us == 0) {
+				continue;
+			}
+			auto &aggregate = timeline.aggregates[i];
+			aggregate.minUs = (aggregate.count == 0) ? us : std::min(aggregate.minUs, us);
+			aggregate.maxUs = std::max(aggregate.maxUs, us);
+			aggregate.sumUs += us;
+			aggregate.count++;
+		}
+		timeline.wakes++;
+	}
+	timeline.crc = timelineCrc(timeline);
+
+	timeline.current = Record{};
+	mark(WakePhase::begin);
+}
+
+void WakeTimeline::mark(WakePhase phase, int64_t timestamp)
+{
+	auto &current = rtcWakeTimeline.current;
+	const size_t index = static_cast<size_t>(phase);
+	// Not started yet or reached before
+	if (rtcWakeTimeline.magic != wakeTimelineMagic || index >= phaseCount ||
+		(phase != WakePhase::lastAck && current.us[index] != 0)) {
+		return;
+	}
+
+	if (timestamp < 0) {
+		timestamp = esp_timer_get_time();
+	}
+	// 0 means not reached
+	current.us[index] = static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(timestamp, 1), UINT32_MAX));
+}
+
+const WakeTimeline::Record& WakeTimeline::getCurrent() const
+{
+	return isValid(rtcWakeTimeline) ? rtcWakeTimeline.current : emptyRecord;
+}
+
+const WakeTimeline::Record& WakeTimeline::getPrevious() const
+{
+	return isValid(rtcWakeTimeline) ? rtcWakeTimeline.previous : emptyRecord;
+}
+
+WakeTimeline::PhaseStatistics WakeTimeline::getStatistics(WakePhase phase) const
+{
+	const size_t index = static_cast<size_t>(phase);
+	if (!isValid(rtcWakeTimeline) || index >= phaseCount || rtcWakeTimeline.aggregates[index].count == 0) {
+		return PhaseStatistics{0, 0, 0, 0};
+	}
+
+	const auto &aggregate = rtcWakeTimeline.aggregates[index];
+	return PhaseStatistics{
+		aggregate.count,
+		aggregate.minUs,
+		static_cast<uint32_t>(aggregate.sumUs / aggregate.count),
+		aggregate.maxUs,
+	};
+}
+
+uint32_t WakeTimeline::getWakes() const
+{
+	return isValid(rtcWakeTimeline) ? rtcWakeTimeline.wakes : 0;
+}
+
+void WakeTimeline::resetStatistics()
+{
+	auto &timeline = rtcWakeTimeline;
+	if (!isValid(timeline)) {
+		return;
+	}
+	memset(timeline.aggregates, 0, sizeof(timeline.aggregates));
+	timeline.wakes = 0;
+	timeline.crc = timelineCrc(timeline);
+}
+
+String WakeTimeline::toJson() const
+{
+	std::ostringstream json;
+	json << "{\"current\":";
+	writeRecord(json, getCurrent());
+	json << ",\"previous\":";
+	writeRecord(json, getPrevious());
+	json << ",\"wakes\":" << getWakes() << ",\"statistics\":{";
+	bool first = true;
+	for (size_t i = 0; i < phaseCount; i++) {
+		const auto phase = static_cast<WakePhase>(i);
+		const auto statistics = getStatistics(phase);
+		if (statistics.count == 0) {
+			continue;
+		}
+		json << (first ? "" : ",") << "\"" << getPhaseName(phase) << "\":{\"count\":" << statistics.count
+			<< ",\"min\":" << statistics.minUs << ",\"avg\":" << statistics.averageUs
+			<< ",\"max\":" << statistics.maxUs << "}";
+		first = false;
+	}
+	json << "}}";
+	return {json.str().c_str()};
+}
+
+String WakeTimeline::toString() const
+{
+	std::ostringstream text;
+	text << "Wake timeline (us since reset, min/avg/max of " << getWakes() << " wakes):" << std::endl;
+	const auto &current = getCurrent();
+	for (size_t i = 0; i < phaseCount; i++) {
+		const auto phase = static_cast<WakePhase>(i);
+		const auto statistics = getStatistics(phase);
+		text << "  " << getPhaseName(phase) << ": ";
+		if (current.us[i] == 0) {
+			text << "-";
+		} else {
+			text << current.us[i];
+		}
+		if (statistics.count != 0) {
+			text << " (" << statistics.minUs << "/" << statistics.averageUs << "/" << statistics.maxUs << ")";
+		}
+		text << std::endl;
+	}
+	return {text.str().c_str()};
+}
+
+const char* WakeTimeline::getPhaseName(WakePhase phase)
+{
+	switch (phase) {
+		case WakePhase::begin:
+			return "begin";
+		case WakePhase::wifiConnected:
+			return "wifiConnected";
+		case WakePhase::gotIp:
+			return "gotIp";
+		case WakePhase::mqttConnecting:
+			return "mqttConnecting";
+		case WakePhase::mqttConnected:
+			return "mqttConnected";
+		case WakePhase::firstPublish:
+			return "firstPublish";
+		case WakePhase::lastAck:
+			return "lastAck";
+	}
+	return "";
+}
@@ -0,0 +1,77 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#ifndef WakeTimeline_h
+#define WakeTimeline_h
+
+#include <Arduino.h>
+
+// Phases of getting online after a reset or a wake from deep sleep, in the order they are passed
+enum class WakePhase : uint8_t {
+	// begin(), beginAsync() or beginFastWake() has been called
+	begin,
+	// Associated with an access point (WifiControl)
+	wifiConnected,
+	// Got an IP
+	gotIp,
+	// First MQTT connection attempt
+	mqttConnecting,
+	// CONNACK received
+	mqttConnected,
+	// First message published through MqttGuardInterface
+	firstPublish,
+	// Latest acknowledgement of a published message
+	lastAck,
+};
+
+/**
+	Records when each WakePhase has been reached, in us since reset (esp_timer_get_time()).
+	The record of the current wake is kept in RTC memory, so it survives deep sleep. start() moves
+	it to getPrevious(), where it is complete, and adds it to the min/avg/max statistics of all
+	wakes since the last resetStatistics(). Recording does not allocate and may happen from any task.
+*/
+class WakeTimeline {
+	public:
+		static const constexpr size_t phaseCount = static_cast<size_t>(WakePhase::lastAck) + 1;
+
+		struct Record {
+			// Time since reset in us, 0 if the phase has not been reached
+			uint32_t us[phaseCount];
+		};
+
+		struct PhaseStatistics {
+			// Wakes which reached the phase
+			uint32_t count;
+			uint32_t minUs;
+			uint32_t averageUs;
+			uint32_t maxUs;
+		};
+
+		// Adds the record of the previous wake to the statistics and starts a new one with WakePhase::begin
+		void start();
+		// Records "phase" at "timestamp" (esp_timer_get_time(), now if negative). Only the first time
+		// a phase is reached counts, except for WakePhase::lastAck.
+		void mark(WakePhase phase, int64_t timestamp = -1);
+
+		// This wake so far
+		const Record& getCurrent() const;
+		// The last complete wake, all zero if there was none
+		const Record& getPrevious() const;
+		PhaseStatistics getStatistics(WakePhase phase) const;
+		// Wakes in the statistics
+		uint32_t getWakes() const;
+		void resetStatistics();
+
+		// {"current":{"begin":..,..},"previous":{..},"wakes":10,"statistics":{"gotIp":{"min":..,"avg":..,"max":..},..}}
+		// in us, phases not reached are left out
+		String toJson() const;
+		// Current wake and statistics for the serial console
+		String toString() const;
+
+		static const char* getPhaseName(WakePhase phase);
+};
+
+#endif
@@ -0,0 +1,224 @@
+/*
+   Basecamp - ESP32 library to simplify the basics of IoT projects
+   Written by Merlin Schumacher (mls@ct.de) for c't magazin für computer technik (https://www.ct.de)
+   Licensed under GPLv3. See LICENSE for details.
+   */
+
+#include "WebInterface.hpp"
+
+namespace {
+	// Initial amount of hash slots, enough for the default interface without growing
+	const constexpr size_t initialTableSize = 64;
+}
+
+const constexpr InterfaceElement::Index InterfaceElement::npos;
+const constexpr InterfaceElementRegistry::Index InterfaceElementRegistry::npos;
+
+InterfaceElementRegistry::Index InterfaceElementRegistry::add(String id, String element, String content, String parent)
+{
+	elements_.emplace_back(std::move(id), std::move(element), std::move(content), std::move(parent));
+	return insert(static_cast<Index>(elements_.size() - 1));
+}
+
+InterfaceElementRegistry::Index InterfaceElementRegistry::add(const InterfaceElementSchema &schema)
+{
+	elements_.emplace_back(schema);
+	return insert(static_cast<Index>(elements_.size() - 1));
+}
+
+InterfaceElementRegistry::Index InterfaceElementRegistry::insert(Index index)
+{
+	// Keep the load factor below 1/2 so probe sequences stay short
+	if ((elements_.size() * 2) > table_.size()) {
+		growTable();
+	} else {
+		insertIntoTable(index);
+	}
+
+	linkIntoTree(index);
+
+	if (strcmp(elements_[index].getElement(), "section") == 0) {
+		elements_[index].isSection = true;
+		sections_.push_back(index);
+	}
+	return index;
+}
+
+InterfaceElementRegistry::Index InterfaceElementRegistry::find(const String &id) const
+{
+	return find(id.c_str(), id.length());
+}
+
+InterfaceElementRegistry::Index InterfaceElementRegistry::find(const char *id, size_t length) const
+{
+	if (table_.empty()) {
+		return npos;
+	}
+
+	const size_t mask = table_.size() - 1;
+	for (size_t slot = hash(id, length) & mask; table_[slot] != npos; slot = (slot + 1) & mask) {
+		const char *candidate = elements_[table_[slot]].getId();
+		if (strncmp(candidate, id, length) == 0 && candidate[length] == '\0') {
+			return table_[slot];
+		}
+	}
+
+	return npos;
+}
+
+bool InterfaceElementRegistry::setAttribute(Index index, const String &key, String value)
+{
+	if (index < 0 || static_cast<size_t>(index) >= elements_.size()) {
+		return false;
+	}
+
+	Index attribute = findOwnAttribute(index, key.c_str());
+	if (attribute != npos) {
+		attributes_[attribute].value = std::move(value);
+		return true;
+	}
+
+	auto &element = elements_[index];
+	attribute = static_cast<Index>(attributes_.size());
+	attributes_.emplace_back(key, std::move(value));
+	if (element.lastAttribute == npos) {
+		element.firstAttribute = attribute;
+	} else {
+		attributes_[element.lastAttribute].next = attribute;
+	}
+	element.lastAttribute = attribute;
+	return true;
+}
+
+const char* InterfaceElementRegistry::getAttribute(Index index, const String &key) const
+{
+	if (index < 0 || static_cast<size_t>(index) >= elements_.size()) {
+		return "";
+	}
+
+	Index attribute = findOwnAttribute(index, key.c_str());
+	if (attribute != npos) {
+		return attributes_[attribute].value.c_str();
+	}
+
+	const InterfaceElementSchema *schema = elements_[index].schema;
+	if (schema != nullptr) {
+		if (schema->configVariable != nullptr && key == "data-config") {
+			return schema->configVariable;
+		}
+		for (size_t i = 0; i < schema->attributeCount; i++) {
+			if (key == schema->attributes[i].key) {
+				return schema->attributes[i].value;
+			}
+		}
+	}
+
+	return "";
+}
+
+InterfaceElementRegistry::Index InterfaceElementRegistry::findOwnAttribute(Index index, const char *key) const
+{
+	for (Index attribute = elements_[index].firstAttribute; attribute != npos; attribute = attributes_[attribute].next) {
+		if (strcmp(attributes_[attribute].key.c_str(), key) == 0) {
+			return attribute;
+		}
+	}
+
+	return npos;
+}
+
+void InterfaceElementRegistry::clear()
+{
+	elements_.clear();
+	attributes_.clear();
+	table_.clear();
+	sections_.clear();
+	firstRoot_ = npos;
+	lastRoot_ = npos;
+}
+
+InterfaceElementRegistry::Index InterfaceElementRegistry::nextInPreorder(Index current, Index root, bool descend) const
+{
+	if (descend && elements_[current].firstChild != npos) {
+		return elements_[current].firstChild;
+	}
+
+	// Climb up until there is an unvisited sibling
+	while (current != npos && current != root && elements_[current].nextSibling == npos) {
+		current = elements_[current].parentIndex;
+	}
+
+	return (current == npos || current == root) ? npos : elements_[current].nextSibling;
+}
+
+void InterfaceElementRegistry::insertIntoTable(Index index)
+{
+	const char *id = elements_[index].getId();
+	const size_t length = strlen(id);
+	// Only the first element with a given id is reachable by find()
+	if (find(id, length) != npos) {
+		return;
+	}
+
+	const size_t mask = table_.size() - 1;
+	size_t slot = hash(id, length) & mask;
+	while (table_[slot] != npos) {
+		slot = (slot + 1) & mask;
+	}
+	table_[slot] = index;
+}
+
+void InterfaceElementRegistry::growTable()
+{
+	size_t newSize = (table_.empty()) ? initialTableSize : (table_.size() * 2);
+	table_.assign(newSize, npos);
+
+	for (Index index = 0; static_cast<size_t>(index) < elements_.size(); index++) {
+		insertIntoTable(index);
+	}
+}
+
+void InterfaceElementRegistry::linkIntoTree(Index index)
+{
+	auto &element = elements_[index];
+	const char *selector = element.getParent();
+
+	// Only "#id" selectors can be resolved, everything else (e.g. "head", "body") is a root
+	if (selector[0] == '#' && selector[1] != '\0') {
+		element.parentIndex = find(selector + 1, strlen(selector + 1));
+	}
+
+	// An element may not become its own parent by referencing its own id
+	if (element.parentIndex == index) {
+		element.parentIndex = npos;
+	}
+
+	if (element.parentIndex == npos) {
+		if (lastRoot_ == npos) {
+			firstRoot_ = index;
+		} else {
+			elements_[lastRoot_].nextSibling = index;
+		}
+		lastRoot_ = index;
+		return;
+	}
+
+	auto &parent = elements_[element.parentIndex];
+	if (parent.lastChild == npos) {
+		parent.firstChild = index;
+	} else {
+		elements_[parent.lastChild].nextSibling = index;
+	}
+	parent.lastChild = index;
+}
+
+// 32 bit FNV-1a
+uint32_t InterfaceElementRegistry::hash(const char *data, size_t length)
+{
+	uint32_t value = 2166136261u;
+	for (size_t i = 0; i < length; i++) {
+		value ^= static_cast<uint8_t>(data[i]);
+		value *= 16777619u;
+	}
+	return value;
+}
@@ -6,12 +6,47 @@
 
 #ifndef WebInterface_h
 #define WebInterface_h
-#include <map>
 
-// TODO: Discuss if this could not be modified to a struct as there is no
-// real programatically-wise logic inside this clas.
+#include <Arduino.h>
+#include <vector>
+
+// Attribute of a flash-resident interface element
+struct InterfaceAttributeSchema {
+	const char *key;
+	const char *value;
+};
+
+/**
+	Description of a static interface element.
+	Declare arrays of these as `const constexpr` so that they are placed in flash (.rodata)
+	and served from there. No string of such an element is ever copied to the heap.
+*/
+struct InterfaceElementSchema {
+	const char *id;
+	const char *element;
+	const char *content;
+	const char *parent;
+	// Configuration key linked to the element ("data-config"), nullptr if none
+	const char *configVariable;
+	const InterfaceAttributeSchema *attributes;
+	size_t attributeCount;
+};
+
+// Number of entries of a (schema) array, usable within constant expressions
+template<typename T, size_t N>
+constexpr size_t schemaSize(const T (&)[N])
+{
+	return N;
+}
+
+// A single element of the web interface. The tree links and the attribute chain
+// are maintained by InterfaceElementRegistry and are indices into its storage.
+// Elements either own their strings or refer to an InterfaceElementSchema in flash.
 class InterfaceElement {
 	public:
+		using Index = int;
+		static const constexpr Index npos = -1;
+
 		InterfaceElement(String p_id, String p_element, String p_content, String p_parent) {
 			element = std::move(p_element);
 			id = std::move(p_id);
@@ -19,40 +54,193 @@ class InterfaceElement {
 			parent = std::move(p_parent);
 		};
 
-		struct cmp_str
+		explicit InterfaceElement(const InterfaceElementSchema &p_schema)
+			: schema(&p_schema)
 		{
-			bool operator()(const String &a, const String &b) const
-			{
-				return strcmp(a.c_str(), b.c_str()) < 0;
-			}
 		};
 
-		const String& getId() const
+		const char* getId() const
 		{
-			return id;
+			return (schema != nullptr) ? schema->id : id.c_str();
 		}
 
+		const char* getElement() const
+		{
+			return (schema != nullptr) ? schema->element : element.c_str();
+		}
+
+		const char* getContent() const
+		{
+			return (schema != nullptr) ? schema->content : content.c_str();
+		}
+
+		const char* getParent() const
+		{
+			return (schema != nullptr) ? schema->parent : parent.c_str();
+		}
+
+		// Only used if schema is nullptr, empty Strings do not allocate
 		String element;
 		String id;
 		String content;
 		String parent;
-		std::map<String, String, cmp_str> attributes;
+		const InterfaceElementSchema *schema = nullptr;
 
-		void setAttribute(String key, String value) {
-			attributes[key] = value;
-		};
+		// Index of the parent element if "parent" is an "#id" selector of a known element
+		Index parentIndex = npos;
+		Index firstChild = npos;
+		Index lastChild = npos;
+		Index nextSibling = npos;
+		// Head and tail of this element's chain in the shared attribute storage
+		Index firstAttribute = npos;
+		Index lastAttribute = npos;
+		// True for "section" elements, see InterfaceElementRegistry::sections()
+		bool isSection = false;
+};
+
+// Attributes of all elements are kept in one contiguous vector and chained per element.
+struct InterfaceAttribute {
+	InterfaceAttribute(String p_key, String p_value)
+		: key(std::move(p_key))
+		, value(std::move(p_value))
+	{
+	}
+
+	String key;
+	String value;
+	InterfaceElement::Index next = InterfaceElement::npos;
+};
+
+/**
+	Storage for all interface elements.
+	Elements are found by id through an open-addressing hash table of slot indices,
+	so adding, looking up and changing elements does not depend on the number of elements.
+	The parent selectors are resolved into a tree once on insertion, walk() then visits
+	every element exactly once with parents before their children.
+*/
+class InterfaceElementRegistry {
+	public:
+		using Index = InterfaceElement::Index;
+		static const constexpr Index npos = InterfaceElement::npos;
+
+		// Adds a new element. Duplicate ids are stored, but find() only returns the first one.
+		Index add(String id, String element, String content, String parent);
+
+		// Adds a flash-resident element. "schema" has to outlive the registry.
+		Index add(const InterfaceElementSchema &schema);
+
+		// Returns the slot of the element with id "id" or npos if there is none.
+		Index find(const String &id) const;
+		Index find(const char *id, size_t length) const;
+
+		// Sets "key" to "value" for the element in slot "index". Returns false for invalid slots.
+		// For flash-resident elements this adds an override, the schema itself stays untouched.
+		bool setAttribute(Index index, const String &key, String value);
 
 		// Return value for `key` or "" if `key` is not found.
-		String getAttribute(const String &key) const {
-			auto found = attributes.find(key);
-			if (found != attributes.end()) {
-				return found->second;
+		const char* getAttribute(Index index, const String &key) const;
+
+		const InterfaceElement& operator[](Index index) const
+		{
+			return elements_[index];
+		}
+
+		size_t size() const
+		{
+			return elements_.size();
+		}
+
+		// Removes all elements and attributes
+		void clear();
+
+		// Slots of all "section" elements in insertion order. A section is served on its own
+		// together with its subtree, see walkSubtree() and walkExceptSections().
+		const std::vector<Index>& sections() const
+		{
+			return sections_;
+		}
+
+		// Calls function(const char *key, const char *value, bool inFlash) for every attribute
+		// of the element in slot "index". inFlash is true if the strings are part of a schema.
+		template<typename FUNCTION>
+		void forEachAttribute(Index index, FUNCTION function) const
+		{
+			const InterfaceElementSchema *schema = elements_[index].schema;
+			if (schema != nullptr) {
+				if (schema->configVariable != nullptr && !hasOwnAttribute(index, "data-config")) {
+					function("data-config", schema->configVariable, true);
+				}
+				for (size_t i = 0; i < schema->attributeCount; i++) {
+					if (!hasOwnAttribute(index, schema->attributes[i].key)) {
+						function(schema->attributes[i].key, schema->attributes[i].value, true);
+					}
+				}
 			}
 
-			// TODO: What shall we really return if not found?
-			// As we are not allowed to throw, maybe we shall change this function
-			// to something like `getOr(const String &key, String default = "")`?
-			return {""};
+			for (Index attribute = elements_[index].firstAttribute; attribute != npos;
+				attribute = attributes_[attribute].next) {
+				function(attributes_[attribute].key.c_str(), attributes_[attribute].value.c_str(), false);
+			}
 		}
+
+		// Calls function(const InterfaceElement &, Index) for every element, parents before children
+		template<typename FUNCTION>
+		void walk(FUNCTION function) const
+		{
+			Index current = firstRoot_;
+			while (current != npos) {
+				function(elements_[current], current);
+				current = nextInPreorder(current);
+			}
+		}
+
+		// Like walk(), but only for "root" and its descendants
+		template<typename FUNCTION>
+		void walkSubtree(Index root, FUNCTION function) const
+		{
+			Index current = root;
+			while (current != npos) {
+				function(elements_[current], current);
+				current = nextInPreorder(current, root);
+			}
+		}
+
+		// Like walk(), but skips all sections and their descendants except "section"
+		template<typename FUNCTION>
+		void walkExceptSections(Index section, FUNCTION function) const
+		{
+			Index current = firstRoot_;
+			while (current != npos) {
+				const bool skip = (elements_[current].isSection && current != section);
+				if (!skip) {
+					function(elements_[current], current);
+				}
+				current = nextInPreorder(current, npos, !skip);
+			}
+		}
+
+	private:
+		Index insert(Index index);
+		Index findOwnAttribute(Index index, const char *key) const;
+		bool hasOwnAttribute(Index index, const char *key) const
+		{
+			return (findOwnAttribute(index, key) != npos);
+		}
+		// Next slot in preorder. Does not leave the subtree of "root" and skips the
+		// children of "current" if "descend" is false.
+		Index nextInPreorder(Index current, Index root = npos, bool descend = true) const;
+		void insertIntoTable(Index index);
+		void growTable();
+		void linkIntoTree(Index index);
+
+		static uint32_t hash(const char *data, size_t length);
+
+		std::vector<InterfaceElement> elements_;
+		std::vector<InterfaceAttribute> attributes_;
+		// Slot indices, size is always a power of two (or zero)
+		std::vector<Index> table_;
+		std::vector<Index> sections_;
+		Index firstRoot_ = npos;
+		Index lastRoot_ = npos;
 };
 #endif
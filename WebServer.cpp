@@ -7,6 +7,11 @@
 #include "WebServer.hpp"
 
 namespace {
+	// User name for the firmware upload, the password is the OTA password
+	const constexpr char *updateUser = "admin";
+	// Minimum time between two progress events of a firmware upload
+	const constexpr uint32_t updateEventInterval = 500;
+
 	template<typename NAMEVALUETYPE>
 	void debugPrint(std::ostream &stream, NAMEVALUETYPE &nameAndValue)
 	{
@@ -15,20 +20,46 @@ namespace {
 }
 
 WebServer::WebServer()
-	: events("/events")
-	, server(80)
+	: gzipFirmwareWriter_(firmwareWriter_)
+	, firmwareUpload_(gzipFirmwareWriter_, [this](const FirmwareUpdateProgress &progress)
+	{
+		firmwareUpdateProgress_.print(progress);
+
+		// Limit the rate of events, the upload calls this for every single chunk
+		if (millis() - lastFirmwareUpdateEvent_ < updateEventInterval) {
+			return;
+		}
+		lastFirmwareUpdateEvent_ = millis();
+
+		char message[96];
+		snprintf(message, sizeof(message), "{\"state\":\"progress\",\"written\":%u,\"total\":%u,\"rate\":%u}",
+			static_cast<unsigned>(progress.written), static_cast<unsigned>(progress.total),
+			static_cast<unsigned>(progress.bytesPerSecond));
+		if (events_ != nullptr) {
+			events_->send(message, "update", millis());
+		}
+	})
 {
-	server.addHandler(&events);
+}
+
+void WebServer::begin(Configuration &configuration, std::function<void()> submitFunc) {
+	if (server_) {
+		return;
+	}
+
+	SPIFFS.begin();
+
+	// Nothing of the server is allocated before it is actually needed
+	server_.reset(new AsyncWebServer(80));
+	AsyncWebServer &server = *server_;
+	events_ = new AsyncEventSource("/events");
+	server.addHandler(events_);
 #ifdef BASECAMP_USEDNS
 #ifdef DNSServer_h
 	server.addHandler(new CaptiveRequestHandler()).setFilter(ON_AP_FILTER);
 #endif
 #endif
-}
 
-void WebServer::begin(Configuration &configuration, std::function<void()> submitFunc) {
-	SPIFFS.begin();
-	
 	server.on("/" , HTTP_GET, [](AsyncWebServerRequest * request)
 	{
 			AsyncWebServerResponse *response = request->beginResponse_P(200, "text/html", index_htm_gz, index_htm_gz_len);
@@ -56,38 +87,39 @@ void WebServer::begin(Configuration &configuration, std::function<void()> submit
 			request->send(response);
 	});
 
+	// Only the list of sections and the first section are sent initially. Further sections
+	// are requested on demand by "/data.json?section=<id>" to keep every response small.
 	server.on("/data.json" , HTTP_GET, [&configuration, this](AsyncWebServerRequest * request)
 	{
+			const auto &sections = interfaceElements.sections();
+			InterfaceElementRegistry::Index section = InterfaceElementRegistry::npos;
+			if (request->hasParam("section")) {
+				section = interfaceElements.find(request->getParam("section")->value());
+				if (section == InterfaceElementRegistry::npos || !interfaceElements[section].isSection) {
+					request->send(404);
+					return;
+				}
+			}
+
 			AsyncJsonResponse *response = new AsyncJsonResponse();
-			DynamicJsonBuffer _jsonBuffer;
 
 			JsonObject &_jsonData = response->getRoot();
 			JsonArray &elements = _jsonData.createNestedArray("elements");
-
-			for (const auto &interfaceElement : interfaceElements)
+			auto addElement = [&](const InterfaceElement &, InterfaceElementRegistry::Index index)
 			{
-				JsonObject &element = elements.createNestedObject();
-				JsonObject &attributes = element.createNestedObject("attributes");
-				element["element"] = _jsonBuffer.strdup(interfaceElement.element);
-				element["id"] = _jsonBuffer.strdup(interfaceElement.id);
-				element["content"] = _jsonBuffer.strdup(interfaceElement.content);
-				element["parent"] = _jsonBuffer.strdup(interfaceElement.parent);
-
-				for (const auto &attribute : interfaceElement.attributes)
-				{
-					attributes[attribute.first] = String{attribute.second};
-				}
+				serializeInterfaceElement(elements, index, configuration);
+			};
 
-				if (interfaceElement.getAttribute("data-config").length() != 0)
-				{
-					if (interfaceElement.getAttribute("type")=="password")
-					{
-						attributes["placeholder"] = "Password unchanged";
-						attributes["value"] = "";
-					} else {
-						attributes["value"] = String{configuration.get(interfaceElement.getAttribute("data-config"))};
-					}
+			if (section != InterfaceElementRegistry::npos) {
+				interfaceElements.walkSubtree(section, addElement);
+			} else {
+				JsonArray &sectionList = _jsonData.createNestedArray("sections");
+				for (const auto &index : sections) {
+					JsonObject &entry = sectionList.createNestedObject();
+					entry["id"] = String{interfaceElements[index].getId()};
+					entry["title"] = String{interfaceElements.getAttribute(index, "data-title")};
 				}
+				interfaceElements.walkExceptSections(sections.empty() ? InterfaceElementRegistry::npos : sections.front(), addElement);
 			}
 #ifdef DEBUG
 			_jsonData.prettyPrintTo(Serial);
@@ -110,7 +142,9 @@ void WebServer::begin(Configuration &configuration, std::function<void()> submit
 			for (int i = 0; i < request->params(); i++)
 			{
 				AsyncWebParameter *webParameter = request->getParam(i);
-				if (webParameter->isPost() && webParameter->value().length() != 0)
+				// Empty values are ignored (e.g. unchanged passwords), unless the input allows clearing it
+				if (webParameter->isPost() &&
+					(webParameter->value().length() != 0 || isClearableConfigVariable(webParameter->name())))
 				{
 						configuration.set(webParameter->name().c_str(), webParameter->value().c_str());
 				}
@@ -118,11 +152,48 @@ void WebServer::begin(Configuration &configuration, std::function<void()> submit
 
 			configuration.save();
 			request->send(201);
+			if (eventBus_ != nullptr) {
+				eventBus_->post(SystemEventType::configurationSaved);
+			}
 
 			// Only call submitFunc when it has been set to something useful
 			if( submitFunc ) submitFunc();
 	});
 
+	// Firmware upload as an alternative to ArduinoOTA, protected by the OTA password.
+	// Send the image as multipart/form-data, optionally with its MD5 in the "X-Update-MD5" header.
+	// gzip compressed images (e.g. "gzip -9 firmware.bin") are inflated while being written, the
+	// MD5 always refers to the uncompressed image.
+	if (!configuration.get(ConfigurationKey::otaActive).equalsIgnoreCase("false")) {
+		server.on("/update", HTTP_POST, [&configuration, this](AsyncWebServerRequest *request)
+		{
+				if (request != firmwareUpdateRequest_) {
+					// Either unauthorized (the upload has been dropped) or no file has been uploaded at all.
+					// This is the only response, the upload handler never sends one.
+					if (authorizeFirmwareUpdate(configuration, request)) {
+						request->send(400, "text/plain", "No firmware image received");
+					}
+					return;
+				}
+				firmwareUpdateRequest_ = nullptr;
+
+				if (!firmwareUpdateSucceeded_) {
+					request->send(500, "text/plain", firmwareUpload_.getError());
+					return;
+				}
+
+				request->send(200, "text/plain", "Update successful. Rebooting.");
+				// Restart as soon as the response has been delivered
+				request->onDisconnect([]()
+				{
+					ESP.restart();
+				});
+		}, [&configuration, this](AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data, size_t len, bool final)
+		{
+				handleFirmwareUpload(configuration, request, index, data, len, final);
+		});
+	}
+
 	server.onNotFound([this](AsyncWebServerRequest *request)
 	{
 #ifdef DEBUG
@@ -135,6 +206,144 @@ void WebServer::begin(Configuration &configuration, std::function<void()> submit
 	server.begin();
 }
 
+void WebServer::end()
+{
+	if (!server_) {
+		return;
+	}
+
+	if (firmwareUpload_.isActive()) {
+		firmwareUpload_.abort("Web server stopped");
+	}
+	firmwareUpdateRequest_ = nullptr;
+
+	// Deleting the server closes all connections and deletes all handlers, "events_" included
+	events_ = nullptr;
+	server_.reset();
+	interfaceElements.clear();
+}
+
+bool WebServer::isFirmwareUpdateAuthorized(Configuration &configuration, AsyncWebServerRequest *request)
+{
+	const String &otaPass = configuration.get(ConfigurationKey::otaPass);
+	return (otaPass.length() != 0 && request->authenticate(updateUser, otaPass.c_str()));
+}
+
+bool WebServer::authorizeFirmwareUpdate(Configuration &configuration, AsyncWebServerRequest *request)
+{
+	const String &otaPass = configuration.get(ConfigurationKey::otaPass);
+	if (otaPass.length() == 0) {
+		request->send(403, "text/plain", "Set an OTA password to enable firmware uploads");
+		return false;
+	}
+
+	if (!request->authenticate(updateUser, otaPass.c_str())) {
+		request->requestAuthentication();
+		return false;
+	}
+
+	return true;
+}
+
+void WebServer::handleFirmwareUpload(Configuration &configuration, AsyncWebServerRequest *request, size_t index, uint8_t *data, size_t len, bool final)
+{
+	if (index == 0) {
+		if (firmwareUpdateRequest_ != nullptr && firmwareUpdateRequest_ != request) {
+			DEBUG_PRINTLN("Refusing concurrent firmware upload.");
+			return;
+		}
+
+		// Still uploading, the request handler responds once the upload is over
+		if (!isFirmwareUpdateAuthorized(configuration, request)) {
+			return;
+		}
+
+		String md5;
+		if (request->hasHeader("X-Update-MD5")) {
+			md5 = request->getHeader("X-Update-MD5")->value();
+		}
+
+		firmwareUpdateRequest_ = request;
+		firmwareUpdateSucceeded_ = false;
+		// Abort the update if the client goes away in the middle of the upload
+		request->onDisconnect([this]()
+		{
+			if (firmwareUpload_.isActive()) {
+				firmwareUpload_.abort("Connection lost during firmware upload");
+				sendFirmwareUpdateEvent("error", firmwareUpload_.getError());
+			}
+			firmwareUpdateRequest_ = nullptr;
+		});
+
+		Serial.println("Start updating sketch");
+		lastFirmwareUpdateEvent_ = 0;
+		firmwareUpdateProgress_.start();
+		if (!firmwareUpload_.begin(request->contentLength(), std::move(md5))) {
+			sendFirmwareUpdateEvent("error", firmwareUpload_.getError());
+			return;
+		}
+		sendFirmwareUpdateEvent("start");
+	}
+
+	// Chunks of unauthorized or failed uploads are dropped
+	if (request != firmwareUpdateRequest_ || !firmwareUpload_.isActive()) {
+		return;
+	}
+
+	if (!firmwareUpload_.write(index, data, len)) {
+		sendFirmwareUpdateEvent("error", firmwareUpload_.getError());
+		return;
+	}
+
+	if (final) {
+		firmwareUpdateSucceeded_ = firmwareUpload_.end();
+		firmwareUpdateProgress_.finish();
+		// The connection is still needed for the response, do not abort on disconnect anymore
+		request->onDisconnect(nullptr);
+		if (firmwareUpdateSucceeded_) {
+			sendFirmwareUpdateEvent("end");
+		} else {
+			sendFirmwareUpdateEvent("error", firmwareUpload_.getError());
+		}
+	}
+}
+
+void WebServer::sendFirmwareUpdateEvent(const char *state, const String &detail)
+{
+	const auto progress = firmwareUpload_.getProgress();
+	DynamicJsonBuffer jsonBuffer;
+	JsonObject &message = jsonBuffer.createObject();
+	message["state"] = state;
+	message["written"] = progress.written;
+	message["total"] = progress.total;
+	message["rate"] = progress.bytesPerSecond;
+	message["elapsed"] = progress.elapsedMs;
+	if (detail.length() != 0) {
+		message["detail"] = detail;
+	}
+
+	String text;
+	message.printTo(text);
+	if (events_ != nullptr) {
+		events_->send(text.c_str(), "update", millis());
+	}
+
+	if (eventBus_ != nullptr) {
+		if (strcmp(state, "start") == 0) {
+			eventBus_->post(SystemEventType::firmwareUploadStarted);
+		} else if (strcmp(state, "end") == 0) {
+			eventBus_->post(SystemEventType::firmwareUploadFinished);
+		} else if (strcmp(state, "error") == 0) {
+			eventBus_->post(SystemEventType::firmwareUploadFailed);
+		}
+	}
+}
+
+void WebServer::setEventBus(EventBus &eventBus)
+{
+	eventBus_ = &eventBus;
+}
+
 void WebServer::debugPrintRequest(AsyncWebServerRequest *request)
 {
 #ifdef DEBUG
@@ -191,32 +400,93 @@ void WebServer::debugPrintRequest(AsyncWebServerRequest *request)
 #endif
 }
 
+void WebServer::serializeInterfaceElement(JsonArray &elements, InterfaceElementRegistry::Index index, const Configuration &configuration)
+{
+	const InterfaceElement &interfaceElement = interfaceElements[index];
+	JsonObject &element = elements.createNestedObject();
+	JsonObject &attributes = element.createNestedObject("attributes");
+	// Strings of flash-resident elements are referenced, owned ones are copied into the
+	// response as it is serialized after the request handler returned.
+	if (interfaceElement.schema != nullptr) {
+		element["element"] = interfaceElement.getElement();
+		element["id"] = interfaceElement.getId();
+		element["content"] = interfaceElement.getContent();
+		element["parent"] = interfaceElement.getParent();
+	} else {
+		element["element"] = interfaceElement.element;
+		element["id"] = interfaceElement.id;
+		element["content"] = interfaceElement.content;
+		element["parent"] = interfaceElement.parent;
+	}
+
+	const char *configVariable = nullptr;
+	bool isPassword = false;
+	interfaceElements.forEachAttribute(index, [&](const char *key, const char *value, bool inFlash)
+	{
+		if (inFlash) {
+			attributes[key] = value;
+		} else {
+			attributes[String{key}] = String{value};
+		}
+
+		if (strcmp(key, "data-config") == 0) {
+			configVariable = value;
+		} else if (strcmp(key, "type") == 0 && strcmp(value, "password") == 0) {
+			isPassword = true;
+		}
+	});
+
+	if (configVariable != nullptr && configVariable[0] != '\0')
+	{
+		if (isPassword)
+		{
+			attributes["placeholder"] = "Password unchanged";
+			attributes["value"] = "";
+		} else {
+			attributes["value"] = String{configuration.get(configVariable)};
+		}
+	}
+}
+
+bool WebServer::isClearableConfigVariable(const String &configVariable) const
+{
+	bool clearable = false;
+	interfaceElements.walk([&](const InterfaceElement &, InterfaceElementRegistry::Index index)
+	{
+		if (!clearable && configVariable == interfaceElements.getAttribute(index, "data-config")) {
+			clearable = (interfaceElements.getAttribute(index, "data-clearable")[0] != '\0');
+		}
+	});
+	return clearable;
+}
+
 void WebServer::addInterfaceElement(const String &id, String element, String content, String parent, String configvariable) {
-	interfaceElements.emplace_back(id, std::move(element), std::move(content), std::move(parent));
+	auto index = interfaceElements.add(id, std::move(element), std::move(content), std::move(parent));
 	if (configvariable.length() != 0) {
-		setInterfaceElementAttribute(id, "data-config", std::move(configvariable));
+		interfaceElements.setAttribute(index, "data-config", std::move(configvariable));
 	}
 }
 
-void WebServer::setInterfaceElementAttribute(const String &id, const String &key, String value)
+void WebServer::addInterfaceElements(const InterfaceElementSchema *schema, size_t count)
 {
-	for (auto &element : interfaceElements) {
-		if (element.getId() == id) {
-			element.setAttribute(key, std::move(value));
-			return;
-		}
+	for (size_t i = 0; i < count; i++) {
+		interfaceElements.add(schema[i]);
 	}
 }
 
+void WebServer::addInterfaceSection(const String &id, const String &title, String parent)
+{
+	auto index = interfaceElements.add(id, "section", "", std::move(parent));
+	interfaceElements.setAttribute(index, "data-title", title);
+}
+
+void WebServer::setInterfaceElementAttribute(const String &id, const String &key, String value)
+{
+	interfaceElements.setAttribute(interfaceElements.find(id), key, std::move(value));
+}
+
 void WebServer::reset() {
 	interfaceElements.clear();
-	// We should also reset the server itself, according to documentation, but it will cause a crash.
-	// It works without reset, if you only configure one server after a reboot. Not sure what happens if you want to reconfigure during runtime.
-	//server.reset();
-	//server.addHandler(&events);
-//#ifdef BASECAMP_USEDNS
-//#ifdef DNSServer_h
-	//server.addHandler(new CaptiveRequestHandler()).setFilter(ON_AP_FILTER);
-//#endif
-//#endif
+	// Resetting the handlers of a running server crashes it. To reconfigure the server at runtime,
+	// call end() and begin() again instead.
 }
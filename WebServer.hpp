@@ -10,13 +10,15 @@
 #include "debug.hpp"
 
 #include <map>
-#include <vector>
+#include <memory>
 #include <SPIFFS.h>
 #include <ESPAsyncWebServer.h>
 #include <AsyncJson.h>
 
 #include "data.hpp"
 #include "Configuration.hpp"
+#include "EventBus.hpp"
+#include "FirmwareUpdate.hpp"
 #include "WebInterface.hpp"
 
 #ifdef BASECAMP_USEDNS
@@ -30,19 +32,42 @@ class WebServer {
 		WebServer();
 		~WebServer() = default;
 
+		// Allocates the server and starts listening on port 80
 		void begin(Configuration &configuration, std::function<void()> submitFunc = 0);
+		// Stops listening, closes all connections and releases the server and all interface elements
+		void end();
+		bool isRunning() const
+		{
+			return (server_ != nullptr);
+		}
 		bool addURL(const char* url, const char* content, const char* mimetype);
 		
 		// Remark: The server should be stopped before any changes to the interface elements are done to avoid inconsistent results if a request comes in at that very moment.
-		// However, ESPAsyncWebServer does not support any kind of end() function or something like that in the moment.
 		void addInterfaceElement(const String &id, String element, String content, String parent = "#configform", String configvariable = "");
 
+		// Adds static interface elements that are served directly from flash. "schema" has to be
+		// `const constexpr` (or at least outlive the server), its strings are never copied.
+		void addInterfaceElements(const InterfaceElementSchema *schema, size_t count);
+		template<size_t N>
+		void addInterfaceElements(const InterfaceElementSchema (&schema)[N])
+		{
+			addInterfaceElements(schema, N);
+		}
+
+		// Adds a section (shown as a tab) with the given title. Add elements with "#id" as parent to it.
+		// Only the first section is sent to the browser initially, the others are fetched when selected.
+		// Any element of type "section" with a "data-title" attribute is treated the same way.
+		void addInterfaceSection(const String &id, const String &title, String parent = "#configform");
+
 		// Sets "key" to "value" in element with id "id" if exists.
 		void setInterfaceElementAttribute(const String &id, const String &key, String value);
 		
 		// Removes all interface elements
 		void reset();
 
+		// Post saved configurations and firmware uploads to "eventBus"
+		void setEventBus(EventBus &eventBus);
+
 		struct cmp_str
 		{
 			bool operator()(String a, String b)
@@ -51,13 +76,34 @@ class WebServer {
 			}
 		};
 
-		AsyncWebServer server;
+		// The underlying server to add own handlers to, nullptr unless the server is running
+		AsyncWebServer* getServer()
+		{
+			return server_.get();
+		}
+
 	private:
 		static void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len);
 		std::map<const char*, const char* > _URLList;
 		bool handleFileRead(char* path);
 		char* getContentType(char* filename);
 
+		// True if an input linked to "configVariable" has the "data-clearable" attribute, i.e. an empty
+		// submission shall clear the value instead of keeping it
+		bool isClearableConfigVariable(const String &configVariable) const;
+
+		// Appends the JSON representation of the element in slot "index" to "elements"
+		void serializeInterfaceElement(JsonArray &elements, InterfaceElementRegistry::Index index, const Configuration &configuration);
+
+		// Upload handler for POST /update, streams the image into the update partition
+		void handleFirmwareUpload(Configuration &configuration, AsyncWebServerRequest *request, size_t index, uint8_t *data, size_t len, bool final);
+		// Check credentials for /update against the OTA password without responding
+		static bool isFirmwareUpdateAuthorized(Configuration &configuration, AsyncWebServerRequest *request);
+		// Like isFirmwareUpdateAuthorized(), sends the 401/403 response on failure
+		static bool authorizeFirmwareUpdate(Configuration &configuration, AsyncWebServerRequest *request);
+		// Send a firmware update state via /events
+		void sendFirmwareUpdateEvent(const char *state, const String &detail = {});
+
 		// Print "request" to serial console for debugging purposes.
 		void debugPrintRequest(AsyncWebServerRequest *request);
 
@@ -67,8 +113,22 @@ class WebServer {
 		int _typeof(int a){ return 1; };
 		int _typeof(std::map<String, String, cmp_str> a){ return 2; };
 
-		AsyncEventSource events;
-		std::vector<InterfaceElement> interfaceElements;
+		// Both only exist between begin() and end(). The server owns its handlers, so "events_"
+		// is deleted along with it.
+		std::unique_ptr<AsyncWebServer> server_;
+		AsyncEventSource *events_ = nullptr;
+		InterfaceElementRegistry interfaceElements;
+		EventBus *eventBus_ = nullptr;
+
+		UpdateFirmwareWriter firmwareWriter_;
+		// Accepts gzip compressed images as well as raw ones
+		GzipFirmwareWriter gzipFirmwareWriter_;
+		FirmwareUpload firmwareUpload_;
+		UpdateProgressPrinter firmwareUpdateProgress_;
+		// Request currently streaming a firmware image, only one update at a time
+		AsyncWebServerRequest *firmwareUpdateRequest_ = nullptr;
+		bool firmwareUpdateSucceeded_ = false;
+		uint32_t lastFirmwareUpdateEvent_ = 0;
 };
 
 #endif
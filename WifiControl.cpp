@@ -6,9 +6,91 @@
 
 #include "WifiControl.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <esp_timer.h>
+#include <rom/crc.h>
+
 namespace {
 	// Minumum access point secret length to be generated (8 is min for ESP32)
 	const constexpr unsigned minApSecretLength = 8;
+
+	// Maximum amount of known networks including the one given to begin()
+	const constexpr size_t maxNetworks = 4;
+	// Scan results are reused for connection attempts within this time (ms)
+	const constexpr uint32_t scanCacheTtl = 30000;
+	// RSSI bonus (dB) for the network of the last successful connection
+	const constexpr int32_t lastSuccessBonus = 10;
+
+	// Marks a valid connection cache ("BCWC")
+	const constexpr uint32_t connectionCacheMagic = 0x42435743;
+	// NVS key of the connection cache, used if the RTC memory has been lost (power cycle)
+	const constexpr char *connectionCacheKey = "wificache";
+
+	// Everything needed to connect to the last access point without a scan and DHCP
+	struct ConnectionCache {
+		uint32_t magic;
+		// CRC of ESSID and password the cache belongs to
+		uint32_t credentials;
+		uint8_t bssid[6];
+		uint8_t channel;
+		uint32_t ip;
+		uint32_t gateway;
+		uint32_t subnet;
+		uint32_t dns1;
+		uint32_t dns2;
+		// CRC of everything above
+		uint32_t crc;
+	};
+
+	// Survives deep sleep, but not a power cycle
+	RTC_DATA_ATTR ConnectionCache rtcConnectionCache;
+
+	// WiFi events are delivered to a static function, this is the instance they belong to
+	WifiControl *activeInstance = nullptr;
+
+	uint32_t cacheCrc(const ConnectionCache &cache)
+	{
+		return crc32_le(0, reinterpret_cast<const uint8_t *>(&cache), offsetof(ConnectionCache, crc));
+	}
+
+	uint32_t credentialsCrc(const String &essid, const String &password)
+	{
+		uint32_t crc = crc32_le(0, reinterpret_cast<const uint8_t *>(essid.c_str()), essid.length());
+		return crc32_le(crc, reinterpret_cast<const uint8_t *>(password.c_str()), password.length());
+	}
+
+	bool isValid(const ConnectionCache &cache)
+	{
+		return (cache.magic == connectionCacheMagic && cache.crc == cacheCrc(cache));
+	}
+
+	// Returns true if "cache" could be restored from RTC memory or NVS
+	bool loadConnectionCache(ConnectionCache &cache)
+	{
+		if (isValid(rtcConnectionCache)) {
+			cache = rtcConnectionCache;
+			return true;
+		}
+
+		Preferences preferences;
+		preferences.begin("basecamp", true);
+		const size_t length = preferences.getBytes(connectionCacheKey, &cache, sizeof(cache));
+		preferences.end();
+		if (length != sizeof(cache) || !isValid(cache)) {
+			return false;
+		}
+
+		rtcConnectionCache = cache;
+		return true;
+	}
+
+	void invalidateConnectionCache()
+	{
+		rtcConnectionCache.magic = 0;
+		// The NVS copy is kept and overwritten on the next successful connection. A broken one
+		// only costs one more failed fast connect after a power cycle.
+	}
 }
 
 void WifiControl::begin(String essid, String password, String configured,
@@ -17,20 +99,33 @@ void WifiControl::begin(String essid, String password, String configured,
 	DEBUG_PRINTLN("Connecting to Wifi");
 
 	String _wifiConfigured = std::move(configured);
-	_wifiEssid = std::move(essid);
-	_wifiPassword = std::move(password);
+	if (essid.length() != 0) {
+		networks_.insert(networks_.begin(), Network{std::move(essid), std::move(password)});
+		if (networks_.size() > maxNetworks) {
+			networks_.pop_back();
+		}
+	}
 	if (_wifiAPName.length() == 0) {
 		_wifiAPName = "ESP32_" + getHardwareMacAddress();
 	}
 
+	activeInstance = this;
+	if (retryTimer_ == nullptr) {
+		// The period is set for every retry by scheduleRetry()
+		retryTimer_ = xTimerCreate("wifiRetry", 1, pdFALSE, this, onRetryTimer);
+	}
 	WiFi.onEvent(WiFiEvent);
 	if (_wifiConfigured.equalsIgnoreCase("true")) {
+		// Events of the attempt started here may already come in
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
 		operationMode_ = Mode::client;
 		DEBUG_PRINTLN("Wifi is configured");
-		DEBUG_PRINT("Connecting to ");
-		DEBUG_PRINTLN(_wifiEssid);
-
-		WiFi.begin(_wifiEssid.c_str(), _wifiPassword.c_str());
+		connectTiming_ = {};
+		connectTiming_.start = esp_timer_get_time();
+		connecting_ = true;
+		if (!connectFromCache()) {
+			connectNext();
+		}
 		WiFi.setHostname(hostname.c_str());
 		//WiFi.setAutoConnect ( true );
 		//WiFi.setAutoReconnect ( true );
@@ -51,6 +146,290 @@ void WifiControl::begin(String essid, String password, String configured,
 	}
 }
 
+void WifiControl::end()
+{
+	DEBUG_PRINTLN("Stopping Wifi");
+	// The events caused by switching off must not trigger a reconnect
+	if (activeInstance == this) {
+		activeInstance = nullptr;
+	}
+	WiFi.removeEvent(WiFiEvent);
+	if (retryTimer_ != nullptr) {
+		xTimerStop(retryTimer_, 0);
+	}
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		connecting_ = false;
+		scanning_ = false;
+		fastConnectPending_ = false;
+		retryPending_ = false;
+		networks_.clear();
+		candidates_.clear();
+	}
+
+	WiFi.disconnect(true);
+	WiFi.mode(WIFI_OFF);
+	operationMode_ = Mode::unconfigured;
+}
+
+bool WifiControl::addNetwork(String essid, String password)
+{
+	// One slot is kept for the network given to begin(), which goes first
+	if (essid.length() == 0 || networks_.size() >= maxNetworks - 1) {
+		return false;
+	}
+
+	networks_.push_back(Network{std::move(essid), std::move(password)});
+	return true;
+}
+
+const std::vector<WifiControl::Network>& WifiControl::getNetworks() const
+{
+	return networks_;
+}
+
+size_t WifiControl::getMaximumNetworkCount() const
+{
+	return maxNetworks;
+}
+
+void WifiControl::setReconnectPolicy(const ReconnectPolicy::Settings &settings)
+{
+	reconnectPolicy_.setSettings(settings);
+}
+
+bool WifiControl::connectFromCache()
+{
+	ConnectionCache cache;
+	if (!loadConnectionCache(cache)) {
+		return false;
+	}
+
+	// The cache may belong to any of the known networks
+	for (size_t network = 0; network < networks_.size(); network++) {
+		const auto &credentials = networks_[network];
+		if (cache.credentials != credentialsCrc(credentials.essid, credentials.password)) {
+			continue;
+		}
+
+		DEBUG_PRINT("Connecting with cached BSSID, channel and IP lease to ");
+		DEBUG_PRINTLN(credentials.essid);
+		// Use the last lease as static configuration to skip DHCP
+		WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet),
+			IPAddress(cache.dns1), IPAddress(cache.dns2));
+		WiFi.begin(credentials.essid.c_str(), credentials.password.c_str(), cache.channel, cache.bssid);
+		currentNetwork_ = network;
+		fastConnectPending_ = true;
+		connectTiming_.fastConnect = true;
+		return true;
+	}
+
+	return false;
+}
+
+void WifiControl::connectWithScan(size_t network)
+{
+	DEBUG_PRINT("Connecting to ");
+	DEBUG_PRINTLN(networks_[network].essid);
+
+	fastConnectPending_ = false;
+	connectTiming_.fastConnect = false;
+	currentNetwork_ = network;
+	// Back to DHCP in case a static lease has been configured before
+	WiFi.config(IPAddress(0u), IPAddress(0u), IPAddress(0u));
+	WiFi.begin(networks_[network].essid.c_str(), networks_[network].password.c_str());
+}
+
+void WifiControl::connectNext()
+{
+	if (networks_.empty()) {
+		DEBUG_PRINTLN("No WiFi network configured");
+		return;
+	}
+
+	// With a single network WiFi.begin() does the scan itself
+	if (networks_.size() == 1) {
+		connectWithScan(0);
+		return;
+	}
+
+	if (scanning_) {
+		return;
+	}
+
+	if (candidates_.empty() || (millis() - scanTime_) > scanCacheTtl) {
+		startScan();
+		return;
+	}
+
+	// All candidates have been tried within the scan TTL, start over without scanning again
+	if (nextCandidate_ >= candidates_.size()) {
+		nextCandidate_ = 0;
+	}
+	connectToCandidate(candidates_[nextCandidate_++]);
+}
+
+void WifiControl::connectToCandidate(const Candidate &candidate)
+{
+	const auto &network = networks_[candidate.network];
+	std::ostringstream debug;
+	debug << "Connecting to " << network.essid.c_str() << " on channel " << candidate.channel
+		<< " (RSSI " << candidate.rssi << ")";
+	DEBUG_PRINTLN(debug.str().c_str());
+
+	fastConnectPending_ = false;
+	connectTiming_.fastConnect = false;
+	currentNetwork_ = candidate.network;
+	WiFi.config(IPAddress(0u), IPAddress(0u), IPAddress(0u));
+	WiFi.begin(network.essid.c_str(), network.password.c_str(), candidate.channel, candidate.bssid);
+}
+
+void WifiControl::startScan()
+{
+	DEBUG_PRINTLN("Scanning for known WiFi networks");
+	scanning_ = true;
+	WiFi.disconnect();
+	// Asynchronous, SYSTEM_EVENT_SCAN_DONE continues with evaluateScan()
+	if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) {
+		scanning_ = false;
+		connectWithScan(0);
+	}
+}
+
+void WifiControl::evaluateScan()
+{
+	scanning_ = false;
+	scanTime_ = millis();
+	candidates_.clear();
+	nextCandidate_ = 0;
+
+	ConnectionCache cache;
+	const bool hasLastSuccess = loadConnectionCache(cache);
+
+	const int16_t found = WiFi.scanComplete();
+	for (int16_t i = 0; i < found; i++) {
+		const String essid = WiFi.SSID(i);
+		for (size_t network = 0; network < networks_.size(); network++) {
+			if (networks_[network].essid != essid) {
+				continue;
+			}
+			Candidate candidate;
+			candidate.network = network;
+			candidate.rssi = WiFi.RSSI(i);
+			candidate.channel = WiFi.channel(i);
+			memcpy(candidate.bssid, WiFi.BSSID(i), sizeof(candidate.bssid));
+			if (hasLastSuccess && cache.credentials == credentialsCrc(essid, networks_[network].password)) {
+				candidate.rssi += lastSuccessBonus;
+			}
+			candidates_.push_back(candidate);
+		}
+	}
+	WiFi.scanDelete();
+
+	std::sort(candidates_.begin(), candidates_.end(), [](const Candidate &a, const Candidate &b) {
+		return a.rssi > b.rssi;
+	});
+
+	if (candidates_.empty()) {
+		// Nothing known in range, let WiFi.begin() keep looking for the first network
+		DEBUG_PRINTLN("No known WiFi network found");
+		connectWithScan(0);
+		return;
+	}
+
+	connectToCandidate(candidates_[nextCandidate_++]);
+}
+
+void WifiControl::storeConnectionCache()
+{
+	ConnectionCache cache = {};
+	cache.magic = connectionCacheMagic;
+	cache.credentials = credentialsCrc(networks_[currentNetwork_].essid, networks_[currentNetwork_].password);
+	memcpy(cache.bssid, WiFi.BSSID(), sizeof(cache.bssid));
+	cache.channel = WiFi.channel();
+	cache.ip = WiFi.localIP();
+	cache.gateway = WiFi.gatewayIP();
+	cache.subnet = WiFi.subnetMask();
+	cache.dns1 = WiFi.dnsIP(0);
+	cache.dns2 = WiFi.dnsIP(1);
+	cache.crc = cacheCrc(cache);
+	rtcConnectionCache = cache;
+
+	// Only write the NVS copy if something changed, it has to survive power cycles only
+	Preferences preferences;
+	preferences.begin("basecamp", false);
+	ConnectionCache stored;
+	if (preferences.getBytes(connectionCacheKey, &stored, sizeof(stored)) != sizeof(stored) ||
+		memcmp(&stored, &cache, sizeof(cache)) != 0) {
+		preferences.putBytes(connectionCacheKey, &cache, sizeof(cache));
+	}
+	preferences.end();
+}
+
+void WifiControl::setEventBus(EventBus &eventBus)
+{
+	eventBus_ = &eventBus;
+	// Writing NVS takes a while, keep it out of the WiFi event handler
+	eventBus.subscribe(SystemEventType::wifiGotIp, [this](const SystemEvent &) {
+		std::lock_guard<std::recursive_mutex> lock(mutex_);
+		storeConnectionCache();
+	});
+	eventBus.subscribe(SystemEventType::wifiRetry, [this](const SystemEvent &) {
+		retry();
+	});
+}
+
+void WifiControl::scheduleRetry()
+{
+	const uint32_t retryDelay = reconnectPolicy_.nextDelay(millis());
+	DEBUG_PRINTF("Next WiFi connection attempt in %u ms\n", retryDelay);
+
+	retryPending_ = true;
+	const TickType_t ticks = pdMS_TO_TICKS(retryDelay);
+	if (retryTimer_ == nullptr || ticks == 0) {
+		retry();
+		return;
+	}
+	// Changing the period also starts the timer
+	xTimerChangePeriod(retryTimer_, ticks, 0);
+}
+
+void WifiControl::retry()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	retryPending_ = false;
+	// Connected in the meantime (e.g. by the WiFi driver itself)
+	if (!connecting_ || scanning_) {
+		return;
+	}
+
+	if (retrySameAccessPoint_) {
+		retrySameAccessPoint_ = false;
+		WiFi.reconnect();
+	} else {
+		connectNext();
+	}
+}
+
+void WifiControl::onRetryTimer(TimerHandle_t timer)
+{
+	auto *wifi = static_cast<WifiControl *>(pvTimerGetTimerID(timer));
+	if (wifi->eventBus_ == nullptr) {
+		// Nothing to hand the retry over to
+		wifi->retry();
+		return;
+	}
+	if (!wifi->eventBus_->post(SystemEventType::wifiRetry)) {
+		// Queue full, try again shortly instead of losing the retry
+		xTimerChangePeriod(timer, pdMS_TO_TICKS(100), 0);
+	}
+}
+
+const WifiControl::ConnectTiming& WifiControl::getConnectTiming() const
+{
+	return connectTiming_;
+}
+
 WifiControl::Mode WifiControl::getOperationMode() const
 {
 	return operationMode_;
@@ -77,21 +456,81 @@ String WifiControl::getAPName() {
 
 void WifiControl::WiFiEvent(WiFiEvent_t event)
 {
-	Preferences preferences;
-	preferences.begin("basecamp", false);
-	unsigned int bootCounter = preferences.getUInt("bootcounter", 0);
-	// In case somebody wants to know this..
-	DEBUG_PRINTF("[WiFi-event] event. Bootcounter is %d\n", bootCounter);
+	if (activeInstance != nullptr) {
+		activeInstance->handleEvent(event);
+	}
+}
+
+void WifiControl::handleEvent(WiFiEvent_t event)
+{
 	DEBUG_PRINTF("[WiFi-event] event: %d\n", event);
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
 	switch(event) {
+		case SYSTEM_EVENT_STA_CONNECTED:
+			connectTiming_.associated = esp_timer_get_time();
+			if (eventBus_ != nullptr) {
+				eventBus_->post(SystemEventType::wifiConnected);
+			}
+			break;
 		case SYSTEM_EVENT_STA_GOT_IP:
+		{
 			DEBUG_PRINT("Wifi IP address: ");
 			DEBUG_PRINTLN(WiFi.localIP());
-			preferences.putUInt("bootcounter", 0);
+
+			connectTiming_.gotIp = esp_timer_get_time();
+			fastConnectPending_ = false;
+			connecting_ = false;
+			retrySameAccessPoint_ = false;
+			reconnectPolicy_.connected(millis());
+			if (eventBus_ != nullptr) {
+				// The cache is stored by the subscriber registered in setEventBus()
+				eventBus_->post(SystemEventType::wifiGotIp);
+			} else {
+				storeConnectionCache();
+			}
+
+#ifdef DEBUG
+			std::ostringstream timing;
+			timing << "WiFi associated after " << (connectTiming_.associated - connectTiming_.start) / 1000 << " ms, "
+				<< "got IP after " << (connectTiming_.gotIp - connectTiming_.start) / 1000 << " ms"
+				<< (connectTiming_.fastConnect ? " (cached connection)" : "");
+			DEBUG_PRINTLN(timing.str().c_str());
+#endif
 			break;
+		}
 		case SYSTEM_EVENT_STA_DISCONNECTED:
 			DEBUG_PRINTLN("WiFi lost connection");
-			WiFi.reconnect();
+			if (eventBus_ != nullptr) {
+				eventBus_->post(SystemEventType::wifiDisconnected);
+			}
+			if (scanning_ || operationMode_ != Mode::client) {
+				// Caused by startScan() itself
+				break;
+			}
+			if (fastConnectPending_) {
+				// The cached access point or lease did not work out, fall back to scan and DHCP
+				// right away, the network itself has not been tried yet.
+				DEBUG_PRINTLN("Cached connection failed, scanning");
+				invalidateConnectionCache();
+				fastConnectPending_ = false;
+				connectNext();
+			} else if (connecting_) {
+				// Disconnects keep coming in while an attempt fails, only the first one schedules
+				if (!retryPending_) {
+					scheduleRetry();
+				}
+			} else {
+				// Try the same access point again first. The delay keeps a whole fleet of
+				// devices from reconnecting in lockstep after an access point restarted.
+				connecting_ = true;
+				retrySameAccessPoint_ = true;
+				scheduleRetry();
+			}
+			break;
+		case SYSTEM_EVENT_SCAN_DONE:
+			if (scanning_) {
+				evaluateScan();
+			}
 			break;
 		default:
 			// INFO: Default = do nothing
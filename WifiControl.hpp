@@ -8,11 +8,16 @@
 #define WifiControl_h
 
 #include "debug.hpp"
+#include "EventBus.hpp"
+#include "reconnectPolicy.hpp"
 #include <iomanip>
+#include <mutex>
 #include <sstream>
 #include <WiFi.h>
 #include <WiFiClient.h>
 #include <Preferences.h>
+#include <vector>
+#include "freertos/timers.h"
 
 class WifiControl {
 	public:
@@ -22,6 +27,21 @@ class WifiControl {
 			client,
 		};
 
+		// Timestamps (esp_timer_get_time(), microseconds since boot) of the last connection attempt
+		struct ConnectTiming {
+			int64_t start;
+			int64_t associated;
+			int64_t gotIp;
+			// True if the cached BSSID, channel and IP lease have been used
+			bool fastConnect;
+		};
+
+		// Credentials of a known network
+		struct Network {
+			String essid;
+			String password;
+		};
+
 		WifiControl(){};
 		bool connect();
 		bool disconnect();
@@ -30,6 +50,23 @@ class WifiControl {
 
 		void begin(String essid, String password = "", String configured = "False",
 							 String hostname = "BasecampDevice", String apSecret="");
+		// Disconnects, switches the radio off and forgets all networks. begin() starts over.
+		void end();
+
+		// Adds a further known network, tried if the one given to begin() is not available.
+		// Call before begin(). Returns false if the list is full, one of getMaximumNetworkCount()
+		// is reserved for the network given to begin().
+		bool addNetwork(String essid, String password);
+		const std::vector<Network>& getNetworks() const;
+		size_t getMaximumNetworkCount() const;
+
+		// Backoff between reconnect attempts after the connection has been lost. Call before begin().
+		void setReconnectPolicy(const ReconnectPolicy::Settings &settings);
+
+		// Post connection changes to "eventBus". The connection cache is then stored and delayed
+		// reconnect attempts are started by the dispatcher task instead of within the WiFi event
+		// handler or the timer service task. Call before begin().
+		void setEventBus(EventBus &eventBus);
 		IPAddress getIP();
 		IPAddress getSoftAPIP();
 		void setAPName(const String &name);
@@ -37,6 +74,9 @@ class WifiControl {
 		int status();
 		static void WiFiEvent(WiFiEvent_t event);
 
+		// Timing of the phases of the last connection attempt, values are 0 if not reached yet
+		const ConnectTiming& getConnectTiming() const;
+
 		unsigned getMinimumSecretLength() const;
 		String generateRandomSecret(unsigned length) const;
 
@@ -48,12 +88,60 @@ class WifiControl {
 		String getHardwareMacAddress(const String& delimiter = {});
 		String getSoftwareMacAddress(const String& delimiter = {});
 	private:
-		String _wifiEssid;
-		String _wifiPassword;
+		// An access point of a known network found by a scan
+		struct Candidate {
+			size_t network;
+			int32_t rssi;
+			int32_t channel;
+			uint8_t bssid[6];
+		};
+
+		// Connect directly to the cached access point with the cached IP lease if possible
+		bool connectFromCache();
+		// Full scan and DHCP
+		void connectWithScan(size_t network);
+		// Continue with the next candidate after a failed attempt
+		void connectNext();
+		void connectToCandidate(const Candidate &candidate);
+		void startScan();
+		// Rank the access points of known networks by RSSI and last success
+		void evaluateScan();
+		void handleEvent(WiFiEvent_t event);
+		void storeConnectionCache();
+		// Start the next attempt after the delay given by the reconnect policy
+		void scheduleRetry();
+		void retry();
+		// Only hands the retry over to the event bus, the timer service task is shared by all timers
+		static void onRetryTimer(TimerHandle_t timer);
+
+		std::vector<Network> networks_;
+		// Network of the current connection attempt
+		size_t currentNetwork_ = 0;
+		std::vector<Candidate> candidates_;
+		size_t nextCandidate_ = 0;
+		// millis() of the last completed scan, candidates_ are reused until it is too old
+		uint32_t scanTime_ = 0;
+		bool scanning_ = false;
+		// Set from the start of a connection attempt until an IP has been assigned
+		bool connecting_ = false;
 		String _ap;
 		String _wifiAPName;
 
 		Mode operationMode_ = Mode::unconfigured;
+		ConnectTiming connectTiming_ = {};
+		// Set while a connection attempt from the cache has not got an IP yet
+		bool fastConnectPending_ = false;
+
+		EventBus *eventBus_ = nullptr;
+		ReconnectPolicy reconnectPolicy_{ReconnectPolicy::Settings{}, esp_random};
+		TimerHandle_t retryTimer_ = nullptr;
+		// Set from scheduleRetry() until retry() has run
+		bool retryPending_ = false;
+		// The pending retry reconnects to the same access point instead of the next candidate
+		bool retrySameAccessPoint_ = false;
+		// Guards the connection state, changed by the WiFi event task, by retries on the event bus
+		// dispatcher and by begin()/end(). Recursive, as retries may start right away.
+		std::recursive_mutex mutex_;
 };
 
 #endif
@@ -10,149 +10,205 @@
 //
 
 
-#define basecamp_css_gz_len 632
+#define basecamp_css_gz_len 711
 const uint8_t basecamp_css_gz[] PROGMEM {
-  0x1f, 0x8b, 0x08, 0x08, 0xb3, 0x56, 0xa1, 0x5b, 0x00, 0x03, 0x62, 0x61,
-  0x73, 0x65, 0x63, 0x61, 0x6d, 0x70, 0x2e, 0x63, 0x73, 0x73, 0x00, 0xbd,
-  0x54, 0xcb, 0x8e, 0x9b, 0x30, 0x14, 0xfd, 0x15, 0x24, 0x34, 0x52, 0xa8,
-  0x00, 0x19, 0x32, 0x99, 0x87, 0x51, 0xab, 0x76, 0x53, 0x75, 0xdd, 0x6d,
-  0x35, 0x0b, 0x1b, 0x0c, 0x58, 0xe3, 0x07, 0xb2, 0x4d, 0x48, 0x8a, 0xf8,
-  0xf7, 0xda, 0x18, 0x32, 0x61, 0x32, 0xaa, 0xd4, 0x4d, 0x15, 0xd9, 0x22,
-  0xf7, 0x5c, 0xfb, 0x1e, 0x9f, 0xfb, 0x68, 0x0d, 0x67, 0x63, 0x2d, 0x85,
-  0x49, 0x6a, 0xc4, 0x29, 0x3b, 0xc3, 0x9f, 0x12, 0x4b, 0x23, 0xe3, 0x1f,
-  0x84, 0x1d, 0x89, 0xa1, 0x25, 0x8a, 0xbf, 0x29, 0x8a, 0x58, 0xac, 0x91,
-  0xd0, 0x89, 0x26, 0x8a, 0xd6, 0x05, 0xa3, 0x82, 0x24, 0x2d, 0xa1, 0x4d,
-  0x6b, 0x60, 0x96, 0x1e, 0xa6, 0xaf, 0x9c, 0x54, 0x14, 0xed, 0x38, 0x15,
-  0x49, 0x45, 0x8e, 0xb4, 0x24, 0xc9, 0x40, 0x2b, 0xd3, 0xc2, 0x7b, 0x00,
-  0xba, 0x53, 0x34, 0x86, 0x83, 0x42, 0x5d, 0x47, 0x54, 0x5c, 0x4b, 0x69,
-  0x88, 0x1a, 0x3d, 0xf8, 0x04, 0xee, 0x0a, 0x8e, 0x4e, 0x8b, 0x6b, 0x06,
-  0x9c, 0xaf, 0x35, 0xa8, 0x86, 0x0a, 0x08, 0x02, 0xd4, 0x1b, 0x39, 0x4d,
-  0x6d, 0xe6, 0x99, 0x0d, 0x3e, 0xd6, 0x1e, 0x80, 0x6d, 0xec, 0x0c, 0xdc,
-  0x4d, 0x6d, 0x1e, 0xb7, 0xfb, 0xb8, 0xbd, 0xdf, 0x78, 0x0a, 0xa9, 0x38,
-  0x62, 0xb7, 0xce, 0xdd, 0xca, 0xa1, 0x94, 0x4c, 0x2a, 0xa8, 0x1a, 0x8c,
-  0x76, 0x20, 0x9e, 0x7f, 0xe9, 0x63, 0x16, 0x4d, 0x0c, 0x61, 0xc2, 0xc6,
-  0x8a, 0xea, 0x8e, 0xa1, 0x33, 0xc4, 0x4c, 0x96, 0xaf, 0xd3, 0x72, 0x62,
-  0xbe, 0x5e, 0xd3, 0xdf, 0x04, 0xa6, 0x4f, 0x84, 0x4f, 0x54, 0x74, 0xbd,
-  0xf9, 0x65, 0xce, 0x1d, 0xf9, 0x6c, 0xc8, 0xc9, 0xbc, 0xc4, 0x57, 0x86,
-  0x0e, 0x69, 0x3d, 0x48, 0x55, 0x6d, 0x8c, 0xa2, 0xe7, 0x98, 0xa8, 0xc5,
-  0x64, 0x09, 0x9a, 0xdd, 0x6c, 0x7f, 0x89, 0xb6, 0xe1, 0x16, 0x09, 0x12,
-  0x9b, 0x03, 0x23, 0x39, 0xcc, 0x08, 0x2f, 0x2e, 0x0a, 0xdd, 0x15, 0x58,
-  0x9e, 0x1c, 0x07, 0x2a, 0x1a, 0x88, 0x6d, 0x00, 0xa2, 0xac, 0xdf, 0xe9,
-  0x9a, 0x0b, 0xee, 0xed, 0x31, 0xb1, 0x09, 0xac, 0x7b, 0xcc, 0xa9, 0x25,
-  0xe8, 0xa1, 0x18, 0xa5, 0xfe, 0x63, 0xf4, 0x17, 0x40, 0x50, 0x2c, 0x37,
-  0x29, 0x54, 0xd1, 0x5e, 0xc3, 0xdc, 0xa6, 0x01, 0xa3, 0xf2, 0xb5, 0x51,
-  0xb2, 0x17, 0x15, 0x0c, 0xf3, 0x07, 0xf4, 0xf0, 0x8c, 0x0a, 0x2f, 0xd8,
-  0xd0, 0x52, 0x43, 0x8a, 0xb2, 0x57, 0xda, 0xfe, 0xe9, 0x24, 0x15, 0x56,
-  0x99, 0xe2, 0x4d, 0x99, 0x2c, 0xcd, 0x0f, 0x96, 0xf0, 0x46, 0xf6, 0xc3,
-  0x4a, 0xbb, 0x45, 0x95, 0x1c, 0xb6, 0x92, 0x67, 0xf7, 0x51, 0x00, 0x02,
-  0x1b, 0x71, 0x5e, 0x20, 0xde, 0x82, 0xb9, 0x03, 0x33, 0x0b, 0x1c, 0x6e,
-  0xc1, 0x19, 0xdb, 0x5b, 0xbb, 0xc3, 0x13, 0xc7, 0xf9, 0x9f, 0x4a, 0xf8,
-  0x03, 0xc9, 0x60, 0x2b, 0x8f, 0xb6, 0x46, 0x6f, 0x85, 0x5b, 0x80, 0x77,
-  0xf2, 0x79, 0xeb, 0xf8, 0xa6, 0x54, 0xe2, 0x15, 0x0a, 0x73, 0x8c, 0x31,
-  0xaa, 0xae, 0x9f, 0xec, 0x89, 0xba, 0x05, 0x82, 0xf7, 0xcf, 0x8f, 0xfd,
-  0x0b, 0x1f, 0x3f, 0x00, 0x73, 0x07, 0x5e, 0x9e, 0xe8, 0xb6, 0x77, 0x0a,
-  0x4c, 0xa9, 0x66, 0x94, 0x27, 0x3e, 0x7d, 0xe3, 0xa5, 0x1e, 0x5c, 0xdd,
-  0xac, 0x5d, 0xe5, 0x72, 0xb9, 0xb1, 0x6b, 0x73, 0x66, 0x04, 0x6a, 0xc9,
-  0x68, 0xb5, 0x22, 0x94, 0xa3, 0x86, 0x40, 0x97, 0x33, 0xa4, 0x92, 0xc6,
-  0x55, 0x01, 0x11, 0x66, 0x67, 0x64, 0xa0, 0x5c, 0x02, 0xbd, 0xec, 0xd9,
-  0x73, 0x1e, 0x5f, 0x56, 0xb4, 0x49, 0x45, 0x14, 0x05, 0x19, 0x98, 0xd2,
-  0x1a, 0x99, 0xbf, 0x31, 0xd9, 0xff, 0x3f, 0x26, 0x03, 0x52, 0xc2, 0x36,
-  0xc8, 0xd2, 0xe2, 0xe1, 0x77, 0x3b, 0x34, 0xae, 0x47, 0x03, 0x96, 0xac,
-  0x9a, 0xc2, 0x52, 0x8a, 0x9a, 0x36, 0xb5, 0x1d, 0x13, 0x97, 0xf6, 0xab,
-  0x19, 0xb1, 0x55, 0x64, 0xb7, 0xc4, 0xcd, 0x2b, 0xe8, 0xb6, 0x6b, 0xbf,
-  0x2f, 0x9f, 0x46, 0x07, 0xc2, 0x2c, 0x70, 0x9d, 0x38, 0x85, 0x1a, 0x1d,
-  0xc9, 0x7c, 0xde, 0xb7, 0x91, 0x35, 0xae, 0xad, 0x6b, 0x64, 0x37, 0xf7,
-  0xed, 0xec, 0xbe, 0x8c, 0xb2, 0x90, 0xc9, 0x46, 0x8e, 0x6b, 0x4f, 0x5c,
-  0x9a, 0xda, 0x61, 0xeb, 0xb1, 0xf9, 0x91, 0x70, 0xee, 0xa0, 0xe9, 0x0f,
-  0x1d, 0x82, 0x27, 0x7a, 0x95, 0x05, 0x00, 0x00
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xc5, 0x54,
+  0x4d, 0x8f, 0x9b, 0x30, 0x10, 0xbd, 0xe7, 0x57, 0x58, 0x8a, 0x2a, 0x25,
+  0x15, 0x20, 0x20, 0x9b, 0xfd, 0x70, 0xd4, 0xaa, 0xbd, 0x54, 0x3d, 0xf7,
+  0x5a, 0xed, 0xc1, 0x06, 0x03, 0xd6, 0x1a, 0x1b, 0xd9, 0x26, 0x24, 0xad,
+  0xf6, 0xbf, 0x77, 0x06, 0x08, 0x09, 0xc9, 0xae, 0x2a, 0xf5, 0x52, 0x11,
+  0x23, 0xe2, 0x99, 0xb1, 0xdf, 0xbc, 0x99, 0x79, 0x95, 0xaf, 0x15, 0xf9,
+  0xbd, 0x28, 0x8c, 0xf6, 0x61, 0xc1, 0x6a, 0xa9, 0x8e, 0x94, 0xfc, 0x30,
+  0xdc, 0x78, 0x13, 0x90, 0xef, 0x42, 0xed, 0x85, 0x97, 0x19, 0x0b, 0xc8,
+  0x57, 0x2b, 0x99, 0x0a, 0x88, 0x63, 0xda, 0x85, 0x4e, 0x58, 0x59, 0xec,
+  0x16, 0x4a, 0x6a, 0x11, 0x56, 0x42, 0x96, 0x95, 0xa7, 0x24, 0x89, 0xb6,
+  0xbb, 0xc5, 0xeb, 0xe2, 0x4b, 0x2d, 0x72, 0xc9, 0xc8, 0xaa, 0x96, 0x3a,
+  0xcc, 0xc5, 0x5e, 0x66, 0x22, 0xec, 0x64, 0xee, 0x2b, 0x4a, 0xee, 0xe2,
+  0xb8, 0x39, 0xac, 0xe1, 0xa6, 0x65, 0x67, 0x59, 0xd3, 0x08, 0x1b, 0x90,
+  0xc2, 0x18, 0x2f, 0x2c, 0x6c, 0x0d, 0x2e, 0x8f, 0xf1, 0x87, 0xdd, 0xa2,
+  0x66, 0x87, 0x53, 0x44, 0x12, 0x63, 0x08, 0x6e, 0xd9, 0x52, 0x6a, 0x4a,
+  0x62, 0xc2, 0x5a, 0x6f, 0xf0, 0x96, 0xd7, 0x45, 0x95, 0x9c, 0x30, 0x77,
+  0x23, 0x80, 0x4d, 0x1c, 0xcf, 0x21, 0x25, 0x09, 0x9e, 0x07, 0xae, 0x69,
+  0x40, 0xaa, 0x0d, 0xac, 0xbb, 0xeb, 0x10, 0x6d, 0x6c, 0xcd, 0xd4, 0xdb,
+  0x51, 0x4d, 0x30, 0xa1, 0xcb, 0x8c, 0x32, 0x96, 0x12, 0x5b, 0x72, 0xb6,
+  0x8a, 0x83, 0xfe, 0x89, 0x1e, 0x92, 0x35, 0x7a, 0x29, 0xc6, 0x05, 0xb2,
+  0x97, 0x4b, 0xd7, 0x28, 0x76, 0xa4, 0x5c, 0x99, 0xec, 0x05, 0x0d, 0x53,
+  0x70, 0x7f, 0xa1, 0x93, 0xbf, 0x04, 0x25, 0xd1, 0xa3, 0xa8, 0xd1, 0x26,
+  0x75, 0xd3, 0xfa, 0x9f, 0xfe, 0xd8, 0x88, 0x4f, 0x5e, 0x1c, 0xfc, 0x73,
+  0x40, 0x2e, 0x76, 0x1a, 0xe6, 0x5c, 0x67, 0x6c, 0x3e, 0xdf, 0xd5, 0x6d,
+  0xcd, 0x85, 0x3d, 0xed, 0x51, 0x6d, 0xfc, 0xaa, 0x37, 0x3c, 0xaf, 0x6f,
+  0x2f, 0x1f, 0xe8, 0x0a, 0xa1, 0x82, 0xde, 0xd4, 0x34, 0xc1, 0x3b, 0x07,
+  0x42, 0x81, 0x4f, 0x48, 0x8d, 0x9b, 0x03, 0xe2, 0x91, 0xba, 0xa4, 0x84,
+  0xc3, 0x45, 0xc2, 0x82, 0xeb, 0xe1, 0x0a, 0x17, 0x6f, 0x21, 0x58, 0xcf,
+  0x31, 0xb8, 0x96, 0xd7, 0x12, 0xd1, 0x0e, 0xc6, 0x80, 0xb0, 0x68, 0xf8,
+  0x02, 0x08, 0xc3, 0x41, 0xc8, 0xa8, 0x16, 0xbb, 0xf1, 0x5f, 0x68, 0x59,
+  0x2e, 0x5b, 0x47, 0x49, 0x8a, 0x45, 0xe4, 0x2c, 0x7b, 0x29, 0xad, 0x69,
+  0x75, 0x4e, 0xc9, 0x32, 0xbd, 0x67, 0xf7, 0x4f, 0x6c, 0x77, 0x62, 0xb6,
+  0xab, 0xa4, 0x87, 0xb0, 0xac, 0xb5, 0x0e, 0xff, 0x36, 0x46, 0x6a, 0x20,
+  0x6f, 0x77, 0xc9, 0x5d, 0x12, 0xa5, 0x5b, 0xcc, 0x64, 0xde, 0x73, 0xdb,
+  0x29, 0xa1, 0x8a, 0xe5, 0xa6, 0x9b, 0x6a, 0x44, 0xc6, 0x5f, 0x94, 0xdc,
+  0xad, 0x09, 0xf4, 0x10, 0x42, 0xe8, 0x17, 0x7c, 0x07, 0xb7, 0x4e, 0xe9,
+  0xe0, 0x94, 0xc0, 0xda, 0xbe, 0xe7, 0x34, 0xfa, 0x6c, 0x46, 0xbf, 0xb0,
+  0x4f, 0xea, 0x1f, 0x86, 0xe6, 0x2d, 0x9a, 0x69, 0x65, 0xf6, 0x38, 0x0f,
+  0xb7, 0x64, 0x9f, 0x2c, 0xd7, 0x94, 0x0f, 0xfb, 0x48, 0xfc, 0x44, 0x6b,
+  0x38, 0x92, 0xb9, 0x4c, 0x39, 0xe7, 0x2c, 0x9f, 0xf3, 0x12, 0xf7, 0xc0,
+  0x71, 0xc5, 0xf3, 0x3e, 0x06, 0x82, 0x82, 0xb8, 0xcf, 0xe8, 0xe1, 0x0d,
+  0x63, 0x8a, 0xc6, 0x29, 0x65, 0x7c, 0xcd, 0xec, 0x69, 0x3f, 0x03, 0x91,
+  0x53, 0xb2, 0x0e, 0x87, 0x9a, 0x4f, 0xad, 0x30, 0xb6, 0xdf, 0x34, 0xca,
+  0x7d, 0x0b, 0xcc, 0x2c, 0xce, 0x1f, 0x95, 0xa0, 0xce, 0x28, 0x99, 0x4f,
+  0x26, 0x59, 0xb3, 0x12, 0x8a, 0x8d, 0x45, 0x66, 0x36, 0x2c, 0xb1, 0x81,
+  0x84, 0xf6, 0x2b, 0x6f, 0x88, 0xc5, 0x8a, 0x8f, 0x55, 0x49, 0x9e, 0xd2,
+  0x60, 0x5a, 0xeb, 0x9b, 0x52, 0xad, 0xd7, 0xa0, 0x1c, 0x3d, 0xb0, 0x82,
+  0xf9, 0xbf, 0xe0, 0xda, 0xfc, 0x17, 0x5c, 0x1d, 0xb3, 0x1a, 0xe6, 0xef,
+  0x2c, 0x2d, 0xcb, 0x6f, 0x28, 0x5e, 0x97, 0xda, 0xc4, 0x8d, 0xca, 0xd1,
+  0x77, 0x99, 0x19, 0x5d, 0xc8, 0xb2, 0x00, 0xa5, 0xba, 0x98, 0xf4, 0x42,
+  0x09, 0xec, 0x3e, 0x78, 0x87, 0x28, 0xa6, 0x30, 0x41, 0xf0, 0xbe, 0x76,
+  0xff, 0x4c, 0x3e, 0xa2, 0xfe, 0x80, 0x13, 0xf0, 0x4f, 0x86, 0xe1, 0x07,
+  0x0f, 0x27, 0x32, 0x2f, 0xe1, 0x26, 0xc6, 0x1d, 0x99, 0xe6, 0xf7, 0x2c,
+  0xb1, 0xfd, 0x9c, 0x11, 0x50, 0x0d, 0x12, 0x5f, 0x0d, 0xed, 0x93, 0xc0,
+  0xe7, 0x9d, 0x33, 0x22, 0x06, 0x3b, 0x7b, 0x31, 0xeb, 0xc8, 0x8b, 0x41,
+  0xc7, 0x18, 0xb6, 0x17, 0x63, 0x1a, 0xa3, 0x58, 0x24, 0x98, 0xf4, 0xa8,
+  0x56, 0xde, 0x40, 0x16, 0xbd, 0x56, 0x0d, 0x80, 0xcf, 0x5a, 0xbf, 0x54,
+  0xa6, 0x34, 0x10, 0x34, 0x0d, 0xfd, 0x59, 0xd0, 0x46, 0x9f, 0xf1, 0x08,
+  0x3b, 0xd8, 0x47, 0xa1, 0x78, 0xfd, 0x03, 0xca, 0xb2, 0xd6, 0x86, 0xd8,
+  0x06, 0x00, 0x00
 };
-#define basecamp_js_gz_len 1020
+#define basecamp_js_gz_len 1599
 const uint8_t basecamp_js_gz[] PROGMEM {
-  0x1f, 0x8b, 0x08, 0x08, 0xb3, 0x56, 0xa1, 0x5b, 0x00, 0x03, 0x62, 0x61,
-  0x73, 0x65, 0x63, 0x61, 0x6d, 0x70, 0x2e, 0x6a, 0x73, 0x00, 0xa5, 0x56,
-  0xdf, 0x6f, 0xdb, 0x36, 0x10, 0xfe, 0x57, 0x58, 0x16, 0x08, 0xa4, 0x45,
-  0xd1, 0x12, 0x74, 0x4f, 0xd6, 0xd4, 0x21, 0x4d, 0xbb, 0xad, 0x45, 0xb6,
-  0x16, 0x75, 0x80, 0x0d, 0x30, 0xfc, 0x40, 0x91, 0x27, 0x99, 0x09, 0x23,
-  0x6a, 0x24, 0x15, 0xcf, 0x30, 0xf4, 0xbf, 0xef, 0x48, 0x49, 0x96, 0x9c,
-  0xc4, 0x4f, 0x7b, 0xb1, 0xac, 0xe3, 0xf1, 0xbb, 0xef, 0x7e, 0xeb, 0xde,
-  0xea, 0xfa, 0x23, 0x73, 0x2c, 0xa7, 0x02, 0x7f, 0xd3, 0x7b, 0x7c, 0xa5,
-  0x59, 0xd9, 0xd6, 0xdc, 0x49, 0x5d, 0x13, 0xa5, 0x99, 0x88, 0xe2, 0x3d,
-  0xd7, 0xb5, 0xd5, 0x0a, 0x52, 0xa5, 0xab, 0x88, 0x7e, 0x60, 0x16, 0x38,
-  0x7b, 0x6c, 0xc2, 0x21, 0x08, 0x1a, 0x67, 0x4f, 0xcc, 0x90, 0x22, 0xaf,
-  0x61, 0x4b, 0xfe, 0xfe, 0xe3, 0xf6, 0x77, 0xe7, 0x9a, 0xef, 0xf0, 0x4f,
-  0x0b, 0xd6, 0x45, 0xf1, 0x84, 0xc4, 0x11, 0xc6, 0xeb, 0x89, 0xfc, 0xcb,
-  0xf2, 0xeb, 0x9f, 0x69, 0xc3, 0x8c, 0x85, 0xc8, 0x6d, 0xa4, 0x4d, 0x0d,
-  0xd8, 0x06, 0xf1, 0xe1, 0x0e, 0xfe, 0x75, 0x71, 0x56, 0xb4, 0x52, 0x89,
-  0xa5, 0x74, 0x10, 0x89, 0x14, 0x14, 0x3c, 0x42, 0xed, 0x6c, 0xdc, 0x1d,
-  0x60, 0x58, 0x24, 0x9e, 0xd1, 0xb9, 0xd5, 0xfa, 0xc1, 0x12, 0x25, 0x1f,
-  0x80, 0xb8, 0x0d, 0x18, 0x20, 0x5b, 0x66, 0x09, 0x23, 0x8d, 0xd1, 0x05,
-  0x5e, 0x4f, 0xc9, 0xd2, 0x31, 0xd7, 0x5a, 0x72, 0xa3, 0x05, 0x2c, 0x08,
-  0x3d, 0x2f, 0x52, 0x1b, 0x04, 0x71, 0xc6, 0x84, 0xf8, 0xd4, 0x1b, 0xb8,
-  0xd3, 0x1f, 0xf5, 0x63, 0x44, 0x37, 0x57, 0x34, 0xa1, 0x60, 0x8c, 0x36,
-  0xf8, 0xbc, 0xd1, 0xad, 0x12, 0xa4, 0xd6, 0x2e, 0xb8, 0x49, 0xd0, 0x64,
-  0x29, 0xab, 0xd6, 0x30, 0xcf, 0x62, 0x8e, 0x93, 0xec, 0xad, 0xdb, 0x29,
-  0x58, 0x50, 0xae, 0x95, 0x36, 0x0b, 0x83, 0x01, 0xe9, 0xe2, 0xcc, 0x80,
-  0x6b, 0x4d, 0xdd, 0x15, 0xa9, 0x37, 0xf2, 0x84, 0x26, 0x6e, 0xa5, 0x75,
-  0x50, 0x83, 0x89, 0xa8, 0x87, 0xa3, 0x09, 0x47, 0x4f, 0x5f, 0x39, 0x1c,
-  0xac, 0x33, 0x7f, 0xaa, 0x1b, 0xa8, 0x23, 0xfa, 0xdb, 0xa7, 0x3b, 0x9a,
-  0xdc, 0x0f, 0x49, 0xf2, 0x62, 0x0b, 0x35, 0xa6, 0x64, 0x8a, 0xc8, 0xc8,
-  0x0c, 0x06, 0x67, 0x22, 0x16, 0xef, 0xed, 0x56, 0x3a, 0xbe, 0x89, 0xd8,
-  0x18, 0x41, 0x0c, 0x19, 0x26, 0x8d, 0xca, 0xba, 0x69, 0x1d, 0x5d, 0xc8,
-  0x12, 0x4f, 0xf0, 0x9a, 0x0b, 0x27, 0x8a, 0x15, 0xa0, 0x3e, 0x8b, 0x9c,
-  0x86, 0x3f, 0x25, 0x9a, 0x3f, 0x67, 0xa9, 0x14, 0x59, 0x78, 0xbd, 0x76,
-  0xce, 0xe4, 0x7b, 0xea, 0xa5, 0x0b, 0x2f, 0xed, 0x5e, 0x46, 0x2d, 0xe8,
-  0xd1, 0x64, 0x80, 0x49, 0x0e, 0xc8, 0xc9, 0x01, 0x00, 0x65, 0x98, 0x6e,
-  0x6f, 0xec, 0xe5, 0xed, 0x9e, 0x52, 0xe2, 0xb1, 0x13, 0xea, 0x9f, 0x0c,
-  0x2f, 0xc8, 0xa2, 0x75, 0x60, 0x13, 0xfa, 0x96, 0x9e, 0x0f, 0xb0, 0x71,
-  0x07, 0xca, 0xc2, 0xfe, 0xf9, 0xf5, 0x83, 0x83, 0x3d, 0xc0, 0x64, 0xfb,
-  0x08, 0xe7, 0x60, 0xbe, 0x2b, 0x0c, 0xb0, 0x87, 0x4c, 0x40, 0xc9, 0x5a,
-  0xe5, 0x16, 0xff, 0x13, 0x2d, 0x0b, 0x68, 0xdd, 0xac, 0x36, 0x9f, 0xe1,
-  0x15, 0x09, 0x4b, 0xa0, 0xaf, 0xfa, 0x32, 0x67, 0xa6, 0x6a, 0x43, 0x31,
-  0xa7, 0x0a, 0xea, 0xca, 0x6d, 0xde, 0xbf, 0x3b, 0x3b, 0x3b, 0xc8, 0x56,
-  0xef, 0xd6, 0x6f, 0xf2, 0xbc, 0xad, 0x91, 0x99, 0xac, 0x41, 0xfc, 0x32,
-  0x3f, 0x58, 0xec, 0xbb, 0xd0, 0x60, 0xd5, 0x04, 0xb1, 0xfa, 0x69, 0x1d,
-  0x44, 0x3c, 0x17, 0x9a, 0x07, 0x51, 0x5a, 0x81, 0x1b, 0x6c, 0x7f, 0xd8,
-  0x7d, 0x16, 0x58, 0x03, 0x19, 0x66, 0xf9, 0x0d, 0xc7, 0xc4, 0x4f, 0x3a,
-  0x1c, 0xf9, 0xba, 0x43, 0x99, 0x14, 0x71, 0x87, 0x2a, 0xc8, 0x8f, 0xa7,
-  0x0e, 0x3b, 0xef, 0xa6, 0xf7, 0x35, 0x07, 0x2f, 0x65, 0x5e, 0x6a, 0xc1,
-  0x5d, 0x8f, 0x6e, 0x63, 0xa2, 0x84, 0x2f, 0xcb, 0x6e, 0x2e, 0xb4, 0x11,
-  0x4f, 0xca, 0xbe, 0xfb, 0xc5, 0x64, 0x05, 0x3b, 0xdf, 0xec, 0x96, 0x18,
-  0x49, 0xee, 0xb4, 0x89, 0xaa, 0x9e, 0x08, 0x36, 0xed, 0x49, 0x15, 0xfa,
-  0x76, 0x6b, 0x58, 0xd3, 0x80, 0xa1, 0x71, 0x27, 0x52, 0xff, 0xaf, 0x16,
-  0x37, 0x1b, 0x9c, 0x02, 0x11, 0x9f, 0x95, 0xf9, 0x73, 0xc3, 0x48, 0x11,
-  0xab, 0x32, 0x0a, 0xa3, 0x87, 0x48, 0x0c, 0x7e, 0xbc, 0xf7, 0xc4, 0x57,
-  0xc5, 0xfa, 0x05, 0x77, 0xcc, 0x83, 0x17, 0x77, 0xb3, 0x54, 0x4d, 0x53,
-  0x86, 0xf7, 0x09, 0x2a, 0xf2, 0x89, 0x46, 0x36, 0x9f, 0x2f, 0xd8, 0xa8,
-  0x5b, 0x24, 0x83, 0x8a, 0x63, 0xe2, 0x2e, 0xc7, 0x41, 0xb6, 0x5a, 0x67,
-  0x23, 0x05, 0x96, 0x5f, 0x66, 0xec, 0xe7, 0x51, 0x25, 0x63, 0xe7, 0xe7,
-  0x81, 0x0e, 0x5f, 0xb1, 0xf5, 0x50, 0x2e, 0x79, 0x5e, 0x60, 0x0c, 0xd2,
-  0xa6, 0xb5, 0x9b, 0x20, 0x8e, 0x33, 0x64, 0xd9, 0x28, 0xc9, 0x21, 0x62,
-  0xc9, 0xd5, 0x54, 0x4c, 0x47, 0x80, 0xe2, 0x08, 0xf0, 0x45, 0xa7, 0x0b,
-  0x8f, 0xe3, 0xf3, 0x35, 0xe7, 0x56, 0xe4, 0x7c, 0x75, 0x39, 0x5a, 0x9d,
-  0xfb, 0x8c, 0x03, 0xca, 0x47, 0xfc, 0x66, 0x3e, 0xc9, 0x70, 0x28, 0x9f,
-  0x2a, 0x21, 0xfa, 0x97, 0x2c, 0xe5, 0xa8, 0xec, 0xc7, 0x7c, 0xfa, 0xc4,
-  0x54, 0x0b, 0x39, 0xbd, 0x33, 0x2d, 0xd0, 0xa1, 0xfe, 0xfc, 0xcc, 0xff,
-  0x55, 0x9b, 0x47, 0x3f, 0x9c, 0x70, 0xda, 0x1f, 0x4d, 0xc9, 0x01, 0xcc,
-  0x4e, 0x79, 0x2f, 0xb4, 0xd8, 0x1d, 0x27, 0xff, 0x5a, 0xa9, 0x88, 0xfe,
-  0xb0, 0xf2, 0xab, 0xe7, 0xa2, 0xbf, 0xbc, 0xc6, 0x7d, 0x32, 0x06, 0x41,
-  0xe4, 0xaf, 0x02, 0x0e, 0xce, 0x5e, 0x5c, 0x65, 0xe2, 0x3d, 0x86, 0x49,
-  0x5c, 0x5c, 0xf4, 0x19, 0xa9, 0x5e, 0x57, 0x5f, 0x89, 0xb5, 0xf7, 0x6d,
-  0x56, 0xcb, 0x33, 0x73, 0xc3, 0xf6, 0x62, 0xa7, 0xaf, 0x06, 0xaf, 0x7d,
-  0x11, 0x9f, 0xd4, 0xd8, 0x30, 0x3b, 0x03, 0x37, 0xb8, 0xfb, 0x64, 0x08,
-  0x18, 0x36, 0x78, 0x9e, 0x53, 0x1a, 0xef, 0x99, 0x02, 0xe3, 0x22, 0xfa,
-  0x4d, 0x01, 0x4e, 0x61, 0x52, 0x4a, 0xa5, 0x88, 0x6e, 0x1d, 0x61, 0xf8,
-  0x1c, 0xb5, 0x49, 0x30, 0x63, 0xe9, 0x61, 0x75, 0x84, 0x21, 0x3d, 0x66,
-  0xf5, 0xec, 0xac, 0x9a, 0x65, 0x98, 0x0f, 0x4d, 0x12, 0x55, 0xbe, 0x23,
-  0x3b, 0xcf, 0x1f, 0x5e, 0xdf, 0xbe, 0x70, 0x72, 0xff, 0x94, 0xaf, 0x1f,
-  0x0e, 0xfb, 0xa7, 0xf0, 0xa7, 0xfd, 0xfe, 0xf9, 0xf6, 0x75, 0x89, 0x0b,
-  0x88, 0xfe, 0x68, 0xdb, 0xe2, 0x11, 0x97, 0xca, 0x18, 0xb4, 0xa3, 0x15,
-  0xbc, 0x44, 0x32, 0xb2, 0xae, 0x8e, 0x97, 0x24, 0xf5, 0x18, 0x61, 0x59,
-  0xf1, 0xd9, 0x67, 0x40, 0x11, 0x1d, 0xc2, 0x71, 0x54, 0x88, 0x78, 0x77,
-  0xdc, 0xb7, 0x05, 0x10, 0xcb, 0x9e, 0x7c, 0x00, 0xa7, 0xda, 0x2d, 0x4f,
-  0x5d, 0x0b, 0x9a, 0xc4, 0xb6, 0x9c, 0x83, 0xb5, 0x65, 0xab, 0xd4, 0x2e,
-  0x25, 0xdf, 0xa1, 0xd0, 0xda, 0x21, 0xa1, 0x14, 0x21, 0xba, 0xad, 0xac,
-  0x85, 0xde, 0xa6, 0xba, 0xf6, 0x8e, 0xe7, 0x23, 0x22, 0xe2, 0xf5, 0xdf,
-  0x36, 0x5d, 0xf6, 0x1f, 0xc6, 0x46, 0x31, 0x2f, 0x02, 0x09, 0x00, 0x00
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xbd, 0x58,
+  0x4b, 0x73, 0xdb, 0x36, 0x10, 0xbe, 0xeb, 0x57, 0x20, 0xc8, 0x4c, 0x4c,
+  0xd5, 0x32, 0xeb, 0x34, 0x3d, 0x59, 0x55, 0x32, 0x89, 0xd3, 0xa4, 0x6e,
+  0xd3, 0x24, 0x13, 0xbb, 0x8f, 0x19, 0x8f, 0x0f, 0x10, 0x09, 0x59, 0x88,
+  0x21, 0x42, 0x05, 0x40, 0xab, 0x1a, 0x47, 0xff, 0xbd, 0xbb, 0x78, 0x50,
+  0x20, 0x29, 0xa9, 0xed, 0x25, 0x27, 0x92, 0xc0, 0xbe, 0xf1, 0xed, 0x2e,
+  0x96, 0x9f, 0x8d, 0xaa, 0x5e, 0x33, 0xcb, 0xc8, 0x84, 0xd0, 0x12, 0x9e,
+  0xf9, 0x67, 0x58, 0xa0, 0xe3, 0xc1, 0xac, 0xae, 0x0a, 0x2b, 0x54, 0x45,
+  0xa4, 0x62, 0x65, 0x36, 0x24, 0x0f, 0x83, 0x42, 0x55, 0x46, 0x49, 0x9e,
+  0x4b, 0x75, 0x9b, 0x1d, 0xbd, 0x62, 0x86, 0x17, 0x6c, 0xb1, 0x74, 0xdb,
+  0xbc, 0x3c, 0x1a, 0x8e, 0x07, 0xf8, 0x76, 0xc9, 0x1d, 0x53, 0x06, 0x9f,
+  0x9b, 0x8e, 0x8c, 0xb8, 0x65, 0xfc, 0x13, 0x25, 0xde, 0x33, 0x4d, 0x34,
+  0xff, 0xab, 0xe6, 0xc6, 0x82, 0xfa, 0x8a, 0xaf, 0xc8, 0x9f, 0xbf, 0xbe,
+  0xfb, 0xc9, 0xda, 0xe5, 0x27, 0xbf, 0x88, 0x62, 0x1a, 0x19, 0x56, 0xb3,
+  0xca, 0xcc, 0xb8, 0x3e, 0x57, 0x8b, 0xa5, 0xe4, 0x96, 0x3b, 0x9b, 0xc4,
+  0x8c, 0x64, 0x41, 0x42, 0x6e, 0x2c, 0xb3, 0xb5, 0x21, 0x8f, 0x26, 0xe4,
+  0xbb, 0xd3, 0x53, 0xdc, 0x8c, 0x1c, 0x6f, 0x98, 0x90, 0xbc, 0x44, 0x61,
+  0x9a, 0xdb, 0x5a, 0x57, 0x60, 0x9b, 0x53, 0x5d, 0x7a, 0xb7, 0x7f, 0xbe,
+  0xfc, 0xf0, 0x3e, 0x5f, 0x32, 0x6d, 0x78, 0x66, 0xe7, 0xc2, 0xe4, 0x9a,
+  0x9b, 0x25, 0xb8, 0xca, 0xaf, 0xf8, 0xdf, 0x16, 0x78, 0xa6, 0xb5, 0x90,
+  0xe5, 0xa5, 0x00, 0x85, 0x2e, 0x3c, 0x5c, 0xf2, 0x05, 0xaf, 0xac, 0x81,
+  0x1d, 0x54, 0xee, 0xd6, 0x82, 0x4b, 0x06, 0x95, 0x7a, 0x72, 0xbf, 0x70,
+  0xc5, 0xa6, 0xa6, 0x43, 0x01, 0xba, 0x09, 0x97, 0x86, 0x03, 0xa5, 0x99,
+  0xab, 0x55, 0x37, 0x28, 0x68, 0xda, 0x66, 0x87, 0xd3, 0xc1, 0x05, 0x7e,
+  0x6f, 0x7b, 0x27, 0xf1, 0x4e, 0xa9, 0x3b, 0x43, 0xa4, 0xb8, 0xe3, 0xc4,
+  0xce, 0xb9, 0xe6, 0x64, 0xc5, 0x0c, 0x61, 0x64, 0xa9, 0xd5, 0x14, 0x4c,
+  0xcd, 0xc9, 0xa5, 0x0f, 0xcb, 0xb9, 0x2a, 0xf9, 0x19, 0x39, 0x22, 0xc7,
+  0xa4, 0x1d, 0x2f, 0x50, 0xc9, 0xca, 0xf2, 0x47, 0xef, 0xd5, 0x95, 0x7a,
+  0xad, 0x16, 0x19, 0x9d, 0x3f, 0xa5, 0x23, 0xca, 0xb5, 0x56, 0x1a, 0x9e,
+  0xe7, 0xaa, 0x96, 0x25, 0xa9, 0x94, 0x75, 0xa7, 0x48, 0x40, 0xf7, 0x4c,
+  0xdc, 0xd6, 0x9a, 0xa1, 0x7d, 0x67, 0x84, 0xf6, 0x04, 0x8e, 0xc8, 0x03,
+  0x35, 0x76, 0x2d, 0x39, 0x85, 0xdd, 0x42, 0x49, 0xa5, 0xcf, 0x34, 0x2f,
+  0xe9, 0x26, 0x0d, 0x3f, 0xbe, 0x7a, 0x1e, 0xd4, 0x7d, 0x0f, 0x9a, 0xdf,
+  0x09, 0x63, 0x79, 0xc5, 0x75, 0x46, 0x51, 0x0b, 0x1d, 0xf5, 0x8e, 0x7b,
+  0x78, 0x88, 0x27, 0xd8, 0xda, 0x09, 0x57, 0x38, 0xa2, 0x04, 0x70, 0x51,
+  0x82, 0x5a, 0xf2, 0x2a, 0xa3, 0x6f, 0x7f, 0xbc, 0x02, 0x9e, 0xcf, 0x31,
+  0x01, 0x8e, 0x09, 0x7d, 0x11, 0x68, 0x27, 0xe8, 0x16, 0xaf, 0x0a, 0x88,
+  0xd9, 0x6f, 0x9f, 0x2e, 0xd0, 0x04, 0x55, 0x81, 0xc2, 0x46, 0x54, 0x7a,
+  0x8c, 0x87, 0x64, 0xba, 0xf3, 0x6c, 0xc2, 0xc3, 0xab, 0xb2, 0x9b, 0x18,
+  0x3d, 0xb4, 0xa4, 0x50, 0x4a, 0x8c, 0x37, 0xb9, 0xe4, 0xd5, 0xad, 0x9d,
+  0x93, 0xc9, 0x84, 0x00, 0xb6, 0x63, 0x20, 0x11, 0xc5, 0x33, 0xa1, 0x8d,
+  0x0d, 0x22, 0x00, 0xcd, 0xa5, 0x2a, 0x6a, 0x3c, 0xca, 0xfc, 0x96, 0xdb,
+  0x70, 0xaa, 0xaf, 0xd6, 0x17, 0x65, 0x23, 0xe8, 0xfa, 0xf4, 0x26, 0x17,
+  0x31, 0x34, 0x8f, 0x52, 0xe6, 0xb6, 0x58, 0x0b, 0xd6, 0xa4, 0xe2, 0x0a,
+  0xcd, 0x99, 0xe5, 0x41, 0x62, 0x46, 0x2b, 0x76, 0x4f, 0x41, 0x08, 0x52,
+  0x81, 0x63, 0xf6, 0xa5, 0xb5, 0x5a, 0x4c, 0x6b, 0x48, 0x12, 0x2a, 0xf0,
+  0xf4, 0x68, 0x50, 0x87, 0xfb, 0x48, 0x37, 0x53, 0x9a, 0x64, 0x28, 0x56,
+  0x80, 0xcc, 0xd3, 0x31, 0x3c, 0x7e, 0x20, 0x1d, 0xd7, 0x60, 0xf1, 0xf8,
+  0x38, 0x56, 0x05, 0xe0, 0x3b, 0xa0, 0x1c, 0x14, 0x59, 0x28, 0x52, 0x5e,
+  0x7f, 0x47, 0xbd, 0x5d, 0x2f, 0x39, 0x1a, 0x70, 0x88, 0x06, 0x53, 0xf2,
+  0x24, 0xa8, 0x07, 0xda, 0x26, 0x34, 0x22, 0x84, 0x06, 0x39, 0x2c, 0x64,
+  0xff, 0x39, 0x38, 0x00, 0x0a, 0xc1, 0x92, 0x94, 0xc4, 0x0a, 0x2b, 0xb9,
+  0x27, 0x52, 0x55, 0x21, 0x45, 0x71, 0x07, 0x04, 0xf1, 0x44, 0xb1, 0x2a,
+  0x01, 0xb5, 0x04, 0xfa, 0x98, 0xdb, 0xae, 0xa8, 0xdc, 0xee, 0x37, 0x00,
+  0xd0, 0x44, 0x36, 0x21, 0x94, 0x6c, 0x09, 0x28, 0x2a, 0xcf, 0xe7, 0x80,
+  0x8a, 0x0c, 0x16, 0x1c, 0x7e, 0xd2, 0x33, 0xc2, 0x3a, 0x05, 0x16, 0xbd,
+  0x07, 0x60, 0xe6, 0x02, 0x6a, 0x94, 0xb6, 0xaf, 0x38, 0xc4, 0x96, 0x23,
+  0x31, 0x64, 0x5e, 0xeb, 0x38, 0xc7, 0xbb, 0x2a, 0xcc, 0xf6, 0xfc, 0x37,
+  0x5b, 0x14, 0xb6, 0xed, 0x4d, 0xf2, 0xc5, 0x55, 0xb8, 0xc3, 0x80, 0x1a,
+  0x0e, 0xf7, 0x97, 0xb2, 0x98, 0x22, 0xbb, 0xca, 0xbf, 0xab, 0x74, 0x89,
+  0x09, 0x3b, 0x24, 0x04, 0x2c, 0x44, 0xcb, 0x53, 0x40, 0x40, 0x46, 0xe9,
+  0xf5, 0xa5, 0x33, 0x5b, 0xe9, 0x97, 0x52, 0x66, 0x11, 0x70, 0xd7, 0x2e,
+  0xb4, 0xee, 0x88, 0x6e, 0xfe, 0x2f, 0xf0, 0xd2, 0x43, 0x76, 0x15, 0x2c,
+  0x2f, 0x85, 0x59, 0x4a, 0xb6, 0x06, 0xd6, 0xac, 0x0d, 0x12, 0xcc, 0xc3,
+  0xc6, 0xcc, 0x17, 0x84, 0x52, 0x02, 0xc5, 0xae, 0x82, 0x22, 0x41, 0x63,
+  0x73, 0xe9, 0xe6, 0x4f, 0xdf, 0xe2, 0xc7, 0x49, 0x8e, 0x90, 0x2d, 0x5c,
+  0x77, 0x59, 0xec, 0xb0, 0xd1, 0xb1, 0x16, 0xd7, 0xd0, 0x98, 0x42, 0x32,
+  0x63, 0xde, 0xb3, 0x05, 0x47, 0x2b, 0xe3, 0xe2, 0x21, 0xb8, 0x75, 0x6d,
+  0x67, 0xf0, 0x7a, 0xcf, 0x9d, 0x07, 0xb4, 0x73, 0x2a, 0xb1, 0xd8, 0x37,
+  0xa9, 0x17, 0xba, 0x9f, 0x8b, 0xd6, 0x4a, 0xd8, 0x62, 0x1e, 0x57, 0xf2,
+  0x66, 0x07, 0xfb, 0x13, 0x5c, 0x0e, 0x08, 0x15, 0xd5, 0xb2, 0xb6, 0xf4,
+  0xcc, 0x81, 0x28, 0x52, 0x15, 0x3e, 0xa3, 0x90, 0x5f, 0xb2, 0x29, 0x97,
+  0x17, 0x25, 0xde, 0x3b, 0xdc, 0x2b, 0xf8, 0xed, 0xaa, 0x6e, 0xa0, 0x14,
+  0xe5, 0xd8, 0x93, 0xa0, 0x1f, 0x40, 0xf4, 0x40, 0x28, 0x52, 0x9c, 0x25,
+  0x04, 0x98, 0x35, 0xbd, 0xde, 0xe5, 0x78, 0x20, 0xa9, 0xa3, 0xf8, 0x11,
+  0xe9, 0xe8, 0x0e, 0x5b, 0x28, 0x76, 0xbb, 0xe7, 0xd3, 0x6a, 0x57, 0x2f,
+  0xf4, 0x5e, 0x8c, 0x12, 0xb5, 0x50, 0x5c, 0x92, 0x6f, 0x16, 0xc3, 0x0c,
+  0xe9, 0x47, 0x1f, 0xd3, 0xe3, 0xa0, 0x37, 0x85, 0x7f, 0x57, 0x66, 0x27,
+  0x64, 0x6d, 0xd9, 0x3d, 0x6b, 0x77, 0x29, 0xea, 0x99, 0xbd, 0x19, 0x4c,
+  0xa1, 0x44, 0xde, 0x8d, 0x07, 0x25, 0x9f, 0xb1, 0x5a, 0xda, 0xb3, 0xaf,
+  0xa1, 0x34, 0xa8, 0x6c, 0x21, 0xa6, 0xa3, 0xb6, 0x39, 0xf9, 0x2b, 0x28,
+  0xcb, 0x8d, 0x88, 0x8b, 0xd7, 0xcd, 0xeb, 0xf9, 0x16, 0x10, 0x88, 0xf9,
+  0xb0, 0xda, 0x60, 0x17, 0x53, 0x88, 0xe9, 0x5b, 0x97, 0x42, 0x4d, 0x0f,
+  0x7c, 0x4e, 0x9e, 0x91, 0x27, 0x4f, 0xb6, 0xeb, 0xd7, 0xcf, 0x6e, 0xe0,
+  0xd6, 0x37, 0x21, 0x75, 0x05, 0xde, 0x8b, 0x8a, 0x97, 0x80, 0xea, 0xd6,
+  0xe6, 0x19, 0x79, 0xd8, 0xf8, 0xae, 0xe6, 0x6d, 0x8f, 0x69, 0x98, 0x0a,
+  0xbf, 0xfe, 0xfe, 0x66, 0x9c, 0x9a, 0x70, 0xa0, 0x95, 0x36, 0x5e, 0xc4,
+  0x2e, 0xda, 0x60, 0x7f, 0x07, 0x6f, 0xbb, 0x75, 0x25, 0xd1, 0x08, 0xcc,
+  0xfd, 0x38, 0xc4, 0x38, 0xb7, 0x3b, 0x50, 0x9b, 0x0e, 0xa3, 0x9e, 0x70,
+  0x83, 0x29, 0xcd, 0xf1, 0xec, 0xe8, 0xc6, 0xa9, 0xc1, 0xe9, 0xb6, 0xc9,
+  0xba, 0x68, 0xd8, 0x6e, 0x0d, 0xd3, 0x80, 0xed, 0x2d, 0x64, 0x59, 0x3b,
+  0xa0, 0xce, 0xa7, 0xec, 0x51, 0x40, 0xc8, 0xbf, 0x32, 0xd3, 0xc7, 0x2b,
+  0x8d, 0x1d, 0x4f, 0x63, 0xdd, 0xf3, 0xc4, 0xad, 0x0e, 0x18, 0xe3, 0xda,
+  0x69, 0x56, 0x6d, 0x07, 0x46, 0x04, 0x41, 0xea, 0x2e, 0x4c, 0x50, 0x20,
+  0x5c, 0xe5, 0xbc, 0xe3, 0x6b, 0x22, 0xaa, 0xed, 0x3a, 0x46, 0xca, 0x7d,
+  0x5c, 0xc3, 0xce, 0x8d, 0x8f, 0x71, 0x3b, 0x4e, 0xb0, 0x1e, 0xe4, 0x78,
+  0x12, 0x8f, 0xea, 0x4d, 0xf7, 0xa2, 0x06, 0x53, 0x80, 0xbf, 0xf2, 0x6f,
+  0x7b, 0x13, 0xba, 0xc2, 0xcb, 0x8f, 0xd1, 0xd3, 0xad, 0x4b, 0xe3, 0xd6,
+  0x35, 0xbd, 0xf4, 0xb7, 0xc1, 0x15, 0xf8, 0x15, 0x44, 0x6c, 0xd1, 0x7c,
+  0xda, 0x41, 0xff, 0x5b, 0xad, 0xea, 0x25, 0xc8, 0xba, 0xbe, 0x69, 0x3c,
+  0xf2, 0xbd, 0x00, 0x5b, 0x41, 0xc2, 0x1a, 0x5a, 0x41, 0xec, 0xd3, 0xb0,
+  0x81, 0xa5, 0x3f, 0x06, 0x7d, 0xd2, 0x31, 0x2e, 0x81, 0x96, 0x53, 0x90,
+  0x2f, 0x6b, 0x33, 0x8f, 0x5c, 0x60, 0x9a, 0x9f, 0x53, 0x96, 0x70, 0x9f,
+  0xe1, 0x99, 0x18, 0x3d, 0xed, 0xe4, 0x77, 0xcf, 0x8e, 0x96, 0xa8, 0xd4,
+  0x9e, 0x81, 0x9b, 0x4f, 0x76, 0xb6, 0x0d, 0x47, 0xec, 0xb5, 0x6d, 0xb6,
+  0xd3, 0x53, 0x3b, 0x0e, 0xbd, 0x88, 0x3a, 0x0b, 0x4f, 0xa3, 0x5f, 0xbd,
+  0x83, 0x81, 0x09, 0x03, 0x19, 0xce, 0xd3, 0xb1, 0xc4, 0x8d, 0x86, 0xfb,
+  0xb2, 0x97, 0xfe, 0x21, 0x66, 0x22, 0x92, 0xc3, 0x60, 0x32, 0xcc, 0xef,
+  0x99, 0xac, 0xf9, 0x84, 0x5e, 0xe9, 0x1a, 0xdb, 0x37, 0xba, 0xd9, 0x1a,
+  0x72, 0xc2, 0x74, 0x8c, 0xe3, 0xe9, 0x1b, 0xa5, 0x17, 0xf8, 0x89, 0xd7,
+  0xf8, 0x16, 0x4d, 0x50, 0xd0, 0xea, 0xf8, 0x53, 0x55, 0xae, 0xfb, 0x6d,
+  0xff, 0xe8, 0x1b, 0x7f, 0x45, 0xf1, 0xec, 0x37, 0x47, 0xdd, 0x8e, 0xbf,
+  0x53, 0x6c, 0x8c, 0xd1, 0x09, 0x79, 0x8a, 0x17, 0x82, 0xe7, 0xfe, 0x62,
+  0x70, 0x72, 0x12, 0x81, 0xd3, 0x62, 0xfa, 0x85, 0xaf, 0xf7, 0xc9, 0xd9,
+  0x73, 0x35, 0xf0, 0xb4, 0x74, 0xb8, 0xc3, 0xf9, 0xdf, 0x31, 0x36, 0x87,
+  0xc4, 0xb9, 0xe0, 0xf9, 0x52, 0xb6, 0x97, 0x66, 0xce, 0x4c, 0xa2, 0x12,
+  0xe7, 0x21, 0xe1, 0x22, 0x8f, 0x55, 0x7c, 0x97, 0x36, 0x48, 0x23, 0x8a,
+  0xae, 0x31, 0x09, 0x17, 0xdc, 0x8c, 0x7e, 0x94, 0x1c, 0x2f, 0x14, 0x33,
+  0x21, 0x25, 0x51, 0xb5, 0x25, 0x0c, 0x9e, 0x51, 0x08, 0x71, 0xfa, 0xdd,
+  0x8c, 0xd1, 0x1e, 0xee, 0x0b, 0x60, 0xd2, 0x0c, 0x46, 0xe0, 0x43, 0xc6,
+  0xb7, 0x0d, 0xf3, 0xb1, 0x88, 0x7c, 0x34, 0x14, 0xe8, 0xac, 0x6f, 0x61,
+  0x02, 0x59, 0xf2, 0xe5, 0xcb, 0x56, 0x55, 0xdf, 0x21, 0x38, 0x8b, 0x0e,
+  0xbe, 0x7b, 0xd0, 0x0a, 0x15, 0x2f, 0xeb, 0xf2, 0x8d, 0x76, 0x84, 0x26,
+  0xd4, 0xa5, 0xff, 0xf2, 0xdf, 0xe4, 0x2b, 0x0d, 0xd8, 0xed, 0xe9, 0xf7,
+  0xe3, 0x87, 0x4b, 0x1c, 0x7f, 0xe9, 0xb7, 0xa6, 0x9e, 0x2e, 0xe0, 0x7a,
+  0xd8, 0xe0, 0x2a, 0x2d, 0x85, 0xf4, 0x12, 0xdc, 0x15, 0xd5, 0x6d, 0xdb,
+  0x3f, 0x9a, 0x08, 0x33, 0xbd, 0x78, 0x84, 0x61, 0x7a, 0xdf, 0x7f, 0x91,
+  0x61, 0x83, 0x95, 0x56, 0x1d, 0x00, 0x0d, 0xf1, 0xdf, 0xc5, 0x94, 0x13,
+  0xc3, 0xee, 0x11, 0x74, 0xad, 0x66, 0xd2, 0xff, 0xa9, 0xb4, 0x47, 0x92,
+  0x63, 0x26, 0xa6, 0x2e, 0x0a, 0x6e, 0xcc, 0xac, 0x96, 0x72, 0x9d, 0x93,
+  0x4f, 0x7c, 0xaa, 0x94, 0x05, 0x4f, 0x72, 0xea, 0xc7, 0xfa, 0xcd, 0x60,
+  0x25, 0xaa, 0x52, 0xad, 0x60, 0x2e, 0x74, 0xff, 0x4a, 0xda, 0x63, 0xe1,
+  0xc0, 0xff, 0x49, 0x03, 0xb2, 0x7f, 0x00, 0xc4, 0x61, 0xc5, 0x1b, 0x74,
+  0x13, 0x00, 0x00
 };
 #define index_htm_gz_len 273
 const uint8_t index_htm_gz[] PROGMEM {
@@ -8,10 +8,24 @@ jsonData = "data.json";
 
 function load() {
 	console.log('Basecamp loaded');
+	loadSection();
+};
+
+// Loads the elements of a section or - without "section" - the section list and the first section
+function loadSection(section) {
 	var request = new XMLHttpRequest();
 	function transferComplete() {
-			        var data = JSON.parse(this.responseText);
-				buildSite(data.elements);
+			if (request.status != 200) {
+				transferFailed();
+				return;
+			}
+			var data = JSON.parse(this.responseText);
+			buildSite(data.elements);
+			if (data.sections) {
+				buildSectionTabs(data.sections);
+			} else {
+				showSection(section);
+			}
 		};
 	function transferFailed(evt) {
 			console.log('Looks like there was a problem. Status Code: ' + request.status);
@@ -20,11 +34,53 @@ function load() {
 		};
 	request.addEventListener("load", transferComplete);
 	request.addEventListener("error", transferFailed);
-	request.open("GET", jsonData);
+	if (section) {
+		request.open("GET", jsonData + "?section=" + encodeURIComponent(section));
+	} else {
+		request.open("GET", jsonData);
+	}
 	request.send();
-
 };
 
+// Adds a tab for each section in front of the first one, which is already loaded
+function buildSectionTabs(sections) {
+	if (sections.length == 0) return;
+	var firstSection = document.getElementById(sections[0].id);
+	if (!firstSection) return;
+	var tabs = document.createElement("nav");
+	tabs.setAttribute("id", "sectiontabs");
+	for (var i = 0; i < sections.length; i++) {
+		var tab = document.createElement("button");
+		tab.setAttribute("type", "button");
+		tab.setAttribute("data-section", sections[i].id);
+		tab.textContent = sections[i].title;
+		tab.onclick = function() { selectSection(this.getAttribute("data-section")); };
+		tabs.appendChild(tab);
+	}
+	firstSection.parentNode.insertBefore(tabs, firstSection);
+	showSection(sections[0].id);
+}
+
+// Shows the section with the id "section" and fetches it if it has not been loaded yet
+function selectSection(section) {
+	if (document.getElementById(section)) {
+		showSection(section);
+	} else {
+		loadSection(section);
+	}
+}
+
+function showSection(section) {
+	var sections = document.querySelectorAll("section[data-title]");
+	for (var i = 0; i < sections.length; i++) {
+		sections[i].style.display = (sections[i].id == section) ? "" : "none";
+	}
+	var tabs = document.querySelectorAll("#sectiontabs button");
+	for (var i = 0; i < tabs.length; i++) {
+		tabs[i].className = (tabs[i].getAttribute("data-section") == section) ? "active" : "";
+	}
+}
+
 function configureElement(element) {
 	switch(element.element)  {
 		case "input":
@@ -102,7 +158,8 @@ function collectConfiguration() {
 			alert("Please fill out all required values");
 			return;
 		}
-		if (configurationValue.length > 0 && configurationKey.length > 0) {
+		var clearable = configurationElements[i].hasAttribute("data-clearable");
+		if ((configurationValue.length > 0 || clearable) && configurationKey.length > 0) {
 			configurationData.append(configurationKey, configurationValue);
 		}
 	}
@@ -57,6 +57,8 @@ void setup() {
   iot.begin();
   // Alternate example: optional initialization with a fixed ap password for setup-mode:
   // iot.begin("yoursecurepassword");
+  // Alternate example: return as soon as WiFi is connecting and set up OTA and the webinterface in the background:
+  // iot.beginAsync([]() { DEBUG_PRINTLN("Basecamp is ready"); });
 
   if (resetPressed) {
     DEBUG_PRINTLN("**** CONFIG HAS BEEN MANUALLY RESET ****");
@@ -68,11 +70,13 @@ void setup() {
   batteryTopic = "stat/" + iot.hostname + "/battery";
   batteryValueTopic = "stat/" + iot.hostname + "/batteryvalue";
 
+  //Subscribe to the delay topic, it is subscribed again on every connect
+  iot.mqttDispatcher.subscribe(delaySleepTopic.c_str(), 0, onDelaySleep);
+
   //Set up the Callbacks for the MQTT instance. Refer to the Async MQTT Client documentation
   // TODO: We should do this actually _before_ connecting the mqtt client...
   iot.mqtt.onConnect(onMqttConnect);
   iot.mqtt.onPublish(suspendESP);
-  iot.mqtt.onMessage(onMqttMessage);
 }
 
 
@@ -80,8 +84,6 @@ void setup() {
 void onMqttConnect(bool sessionPresent) {
   DEBUG_PRINTLN(__func__);
 
-  //Subscribe to the delay topic
-  iot.mqtt.subscribe(delaySleepTopic.c_str(), 0);
   //Trigger the transmission of the current state.
   transmitStatus();
 }
@@ -124,12 +126,12 @@ void transmitStatus() {
   DEBUG_PRINTLN("Data published");
 }
 
-//This topic is called if an MQTT message is received
-void onMqttMessage(char* topic, char* payload, AsyncMqttClientMessageProperties properties, size_t len, size_t index, size_t total) {
+//This function is called if a message is received on the delay topic
+void onDelaySleep(const char* topic, const char* payload, size_t length) {
   DEBUG_PRINTLN(__func__);
 
   //Check if the payload eqals "true" and set delaySleep correspondigly
-  //Since we only subscribed to one topic, we only have to compare the payload
+  //The dispatcher hands over the complete payload followed by a NUL, so it can be compared as a string
   if (strcmp(payload, "true") == 0)  {
     delaySleep = true;
   } else  {
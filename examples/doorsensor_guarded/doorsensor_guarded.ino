@@ -23,12 +23,11 @@ int batteryLimit = 3300;
 //This is used to control if the ESP should enter sleep mode or not
 bool delaySleep = false;
 
-//Variables for the mqtt packages and topics
-uint16_t statusPacketIdSub = 0;
-String delaySleepTopic;
-String statusTopic;
-String batteryTopic;
-String batteryValueTopic;
+//Ids of the mqtt topics in iot.mqttTopics
+MqttTopicRegistry::TopicId delaySleepTopic;
+MqttTopicRegistry::TopicId statusTopic;
+MqttTopicRegistry::TopicId batteryTopic;
+MqttTopicRegistry::TopicId batteryValueTopic;
 
 // Reset the configuration to factory defaults (all empty)
 void resetToFactoryDefaults()
@@ -55,26 +54,26 @@ void setup() {
     resetToFactoryDefaults();
   }
 
-  // Initialize Basecamp
-  iot.begin();
-  // Alternate example: optional initialization with a fixed ap password for setup-mode:
-  // iot.begin("yoursecurepassword");
+  //Set up the Callbacks for the MQTT instance. Refer to the Async MQTT Client documentation
+  //They have to be in place before Basecamp starts, beginFastWake() connects MQTT right away
+  iot.mqtt.onConnect(onMqttConnect);
+
+  //Configure the MQTT topics, Basecamp replaces {hostname} once it is known
+  delaySleepTopic = iot.mqttTopics.add("cmd/{hostname}/delaysleep");
+  statusTopic = iot.mqttTopics.add("stat/{hostname}/status");
+  batteryTopic = iot.mqttTopics.add("stat/{hostname}/battery");
+  batteryValueTopic = iot.mqttTopics.add("stat/{hostname}/batteryvalue");
+
+  // Initialize Basecamp. After a wake from deep sleep only WiFi and MQTT are started with the
+  // configuration kept in RTC memory, otherwise (first boot, power cycle) this calls iot.begin().
+  iot.beginFastWake();
 
   if (resetPressed) {
     DEBUG_PRINTLN("**** CONFIG HAS BEEN MANUALLY RESET ****");
   }
 
-  //Configure the MQTT topics
-  delaySleepTopic = "cmd/" + iot.hostname + "/delaysleep";
-  statusTopic = "stat/" + iot.hostname + "/status";
-  batteryTopic = "stat/" + iot.hostname + "/battery";
-  batteryValueTopic = "stat/" + iot.hostname + "/batteryvalue";
-
-  //Set up the Callbacks for the MQTT instance. Refer to the Async MQTT Client documentation
-  // TODO: We should do this actually _before_ connecting the mqtt client...
-  iot.mqtt.onConnect(onMqttConnect);
-  iot.mqttOnPublish(suspendESP);
-  iot.mqtt.onMessage(onMqttMessage);
+  //Subscribe to the delay topic, it is subscribed again on every connect
+  iot.mqttDispatcher.subscribe(iot.mqttTopics[delaySleepTopic], 0, onDelaySleep);
 }
 
 
@@ -82,8 +81,6 @@ void setup() {
 void onMqttConnect(bool sessionPresent) {
   DEBUG_PRINTLN(__func__);
 
-  //Subscribe to the delay topic
-  iot.mqtt.subscribe(delaySleepTopic.c_str(), 0);
   //Trigger the transmission of the current state.
   transmitStatus();
 }
@@ -93,16 +90,15 @@ void onMqttConnect(bool sessionPresent) {
 void transmitStatus() {
   DEBUG_PRINTLN(__func__);
 
+  const char *doorState;
   if (sensorValue == 0) {
     DEBUG_PRINTLN("Door open");
-    //Transfer the current state of the sensor to the MQTT broker
-    statusPacketIdSub = iot.mqttPublish(statusTopic.c_str(), 1, true, "open" );
+    doorState = "open";
     //Configure the wakeup pin to wake if the door is closed
     esp_sleep_enable_ext0_wakeup((gpio_num_t)SensorPin, 1);
   } else {
     DEBUG_PRINTLN("Door closed");
-    //Transfer the current state of the sensor to the MQTT broker
-    statusPacketIdSub = iot.mqttPublish(statusTopic.c_str(), 1, true, "closed" );
+    doorState = "closed";
     //Configure the wakeup pin to wake if the door is closed
     esp_sleep_enable_ext0_wakeup((gpio_num_t)SensorPin, 0);
   }
@@ -113,25 +109,33 @@ void transmitStatus() {
   char sensorC[6];
   //convert the sensor value to a string
   sprintf(sensorC, "%04i", sensorValue);
-  //Send the sensor value to the MQTT broker
-  iot.mqttPublish(batteryValueTopic.c_str(), 1, true, sensorC);
-  //Check the battery level and publish the state
+  //Check the battery level
+  const char *batteryState;
   if (sensorValue < batteryLimit) {
     DEBUG_PRINTLN("Battery empty");
-    iot.mqttPublish(batteryTopic.c_str(), 1, true, "empty" );
+    batteryState = "empty";
   } else {
     DEBUG_PRINTLN("Battery full");
-    iot.mqttPublish(batteryTopic.c_str(), 1, true, "full" );
+    batteryState = "full";
   }
+
+  //Transfer the current state of the sensor and the battery to the MQTT broker in one go.
+  //suspendESP is called once, when all of them have been acknowledged or one of them timed out
+  //(MQTTAckTimeout in the configuration, 10 seconds by default).
+  iot.mqttPublishBatch({
+    {iot.mqttTopics[statusTopic], doorState, 1, true},
+    {iot.mqttTopics[batteryValueTopic], sensorC, 1, true},
+    {iot.mqttTopics[batteryTopic], batteryState, 1, true},
+  }, suspendESP);
   DEBUG_PRINTLN("Data published");
 }
 
-//This topic is called if an MQTT message is received
-void onMqttMessage(char* topic, char* payload, AsyncMqttClientMessageProperties properties, size_t len, size_t index, size_t total) {
+//This function is called if a message is received on the delay topic
+void onDelaySleep(const char* topic, const char* payload, size_t length) {
   DEBUG_PRINTLN(__func__);
 
   //Check if the payload eqals "true" and set delaySleep correspondigly
-  //Since we only subscribed to one topic, we only have to compare the payload
+  //The dispatcher hands over the complete payload followed by a NUL, so it can be compared as a string
   if (strcmp(payload, "true") == 0)  {
     delaySleep = true;
   } else  {
@@ -139,18 +143,17 @@ void onMqttMessage(char* topic, char* payload, AsyncMqttClientMessageProperties
   }
 }
 
-void suspendESP(uint16_t packetId) {
+void suspendESP(MqttBatchResult result) {
   DEBUG_PRINTLN(__func__);
 
-  if (delaySleep) {
-      DEBUG_PRINTLN("Delaying Sleep for manual keep-alive request");
-      return;
-  }
-
-  if (!iot.mqttAllSent()) {
+  if (result != MqttBatchResult::acknowledged) {
       std::ostringstream debug;
-      debug << "Waiting for " << iot.mqttRemainingPackets() << " mqtt packets to be sent before going to sleep.";
+      debug << "Status has not been acknowledged (" << iot.mqttRemainingPackets() << " mqtt packets left), going to sleep anyway.";
       DEBUG_PRINTLN(debug.str().c_str());
+  }
+
+  if (delaySleep) {
+      DEBUG_PRINTLN("Delaying Sleep for manual keep-alive request");
       return;
   }
 
@@ -163,4 +166,7 @@ void suspendESP(uint16_t packetId) {
 
 void loop()
 {
+  //Runs OTA, replays queued MQTT messages and drops packets past the ack deadline
+  //(the latter is checked periodically by the event dispatcher of Basecamp as well)
+  iot.handle();
 }
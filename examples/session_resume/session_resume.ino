@@ -0,0 +1,123 @@
+//Compares the time until a message is acknowledged with and without MQTTPersistentSession.
+//Wakes from deep sleep every few seconds, publishes one message and measures lastAck - mqttConnecting of the
+//wake timeline. The SUBSCRIBEs are sent on CONNACK, before the message, and the broker answers in order, so this
+//includes them when the session is new and leaves them out when it is resumed. CONNECT to CONNACK alone is the
+//same for both settings and is not reported. Every WakesPerSetting wakes the setting is toggled, so the averages
+//of both settings build up side by side on the serial console.
+
+//Define DEBUG to get the Output from DEBUG_PRINTLN
+#define DEBUG 1
+
+#include <sstream>
+
+//Include Basecamp in this sketch
+#include <Basecamp.hpp>
+#include <Configuration.hpp>
+
+Basecamp iot{Basecamp::SetupModeWifiEncryption::secured, Basecamp::ConfigurationUI::accessPoint};
+
+//Wakes measured before MQTTPersistentSession is toggled
+static const uint32_t WakesPerSetting = 10;
+static const uint64_t SleepUs = 5 * 1000000ull;
+
+//Kept over deep sleep, index 0 is a clean session, 1 a persistent one
+RTC_DATA_ATTR uint64_t ackSumUs[2];
+RTC_DATA_ATTR uint32_t measuredWakes[2];
+RTC_DATA_ATTR uint32_t wakesWithSetting;
+//The first wake after a toggle has no session to resume and no configuration snapshot, it is not counted
+RTC_DATA_ATTR bool settingChanged;
+
+//Set once the message is done, loop() goes to sleep. Saving and sleeping in the callback would block the
+//task of AsyncTCP, and the DISCONNECT would never be sent.
+volatile bool measured = false;
+
+MqttTopicRegistry::TopicId statusTopic;
+MqttTopicRegistry::TopicId commandTopic;
+
+bool persistentSession() {
+  return iot.configuration.get(ConfigurationKey::mqttPersistentSession).equalsIgnoreCase("true");
+}
+
+void setup() {
+  //Register the callback before beginFastWake(), it connects MQTT right away
+  iot.mqtt.onConnect(onMqttConnect);
+  statusTopic = iot.mqttTopics.add("stat/{hostname}/status");
+  commandTopic = iot.mqttTopics.add("cmd/{hostname}/+");
+
+  iot.beginFastWake();
+
+  //A persistent session keeps these at the broker, so resumed sessions skip the SUBSCRIBEs.
+  //WiFi has to connect first, so they are in place before MQTT connects.
+  iot.mqttDispatcher.subscribe(iot.mqttTopics[commandTopic], 1, onCommand);
+  iot.mqttDispatcher.subscribe("broadcast/#", 1, onCommand);
+}
+
+void onMqttConnect(bool sessionPresent) {
+  DEBUG_PRINTLN(sessionPresent ? "Session resumed" : "New session");
+  //The wake is measured once the message has been acknowledged
+  iot.mqttPublishBatch({
+    {iot.mqttTopics[statusTopic], "awake", 1, false},
+  }, onAcknowledged);
+}
+
+//Messages sent while the device slept arrive right after connecting with a persistent session
+void onCommand(const char* topic, const char* payload, size_t length) {
+  DEBUG_PRINT("Command ");
+  DEBUG_PRINTLN(topic);
+}
+
+void onAcknowledged(MqttBatchResult result) {
+  const auto &wake = Basecamp::wakeTimeline.getCurrent();
+  const uint32_t connecting = wake.us[static_cast<size_t>(WakePhase::mqttConnecting)];
+  const uint32_t acknowledged = wake.us[static_cast<size_t>(WakePhase::lastAck)];
+  const size_t setting = persistentSession() ? 1 : 0;
+
+  if (result == MqttBatchResult::acknowledged && !settingChanged && connecting != 0 && acknowledged != 0) {
+    ackSumUs[setting] += acknowledged - connecting;
+    measuredWakes[setting]++;
+  }
+  settingChanged = false;
+  measured = true;
+}
+
+void report() {
+  std::ostringstream report;
+  const char* names[] = {"clean session", "persistent session"};
+  for (size_t i = 0; i < 2; i++) {
+    report << names[i] << ": ";
+    if (measuredWakes[i] == 0) {
+      report << "not measured yet" << std::endl;
+      continue;
+    }
+    report << "acknowledged after " << ackSumUs[i] / measuredWakes[i] << " us (average of "
+      << measuredWakes[i] << " wakes)" << std::endl;
+  }
+  DEBUG_PRINT(report.str().c_str());
+}
+
+void loop()
+{
+  iot.handle();
+  if (!measured) {
+    return;
+  }
+  report();
+
+  //Toggle the setting, the next wake starts with a full begin() because save() invalidates the snapshot
+  if (++wakesWithSetting >= WakesPerSetting) {
+    wakesWithSetting = 0;
+    settingChanged = true;
+    iot.configuration.set(ConfigurationKey::mqttPersistentSession, persistentSession() ? "false" : "true");
+    iot.configuration.save();
+  }
+
+  //Give the DISCONNECT a moment to go out before the radio is switched off
+  DEBUG_PRINTLN("Entering deep sleep");
+  iot.mqtt.disconnect();
+  const unsigned long start = millis();
+  while (iot.mqtt.connected() && millis() - start < 500) {
+    delay(10);
+  }
+  esp_sleep_enable_timer_wakeup(SleepUs);
+  esp_deep_sleep_start();
+}
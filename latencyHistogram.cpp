@@ -0,0 +1,94 @@
+#include "latencyHistogram.hpp"
+
+#include <algorithm>
+
+const constexpr unsigned LatencyHistogram::subBucketBits;
+const constexpr uint32_t LatencyHistogram::subBucketCount;
+const constexpr uint32_t LatencyHistogram::linearLimit;
+const constexpr size_t LatencyHistogram::bucketCount;
+
+void LatencyHistogram::record(uint32_t value)
+{
+    buckets_[bucketIndex(value)]++;
+    count_++;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+    sum_ += value;
+}
+
+uint32_t LatencyHistogram::count() const
+{
+    return count_;
+}
+
+uint32_t LatencyHistogram::min() const
+{
+    return (count_ == 0) ? 0 : min_;
+}
+
+uint32_t LatencyHistogram::max() const
+{
+    return max_;
+}
+
+uint32_t LatencyHistogram::mean() const
+{
+    return (count_ == 0) ? 0 : static_cast<uint32_t>(sum_ / count_);
+}
+
+uint32_t LatencyHistogram::percentile(float percentile) const
+{
+    if (count_ == 0) {
+        return 0;
+    }
+
+    percentile = std::min(std::max(percentile, 0.0f), 100.0f);
+    // Rank of the value looked for, at least the first one
+    const uint32_t rank = std::max<uint32_t>(1, static_cast<uint32_t>(static_cast<double>(count_) * percentile / 100.0 + 0.5));
+    uint32_t seen = 0;
+    for (size_t index = 0; index < bucketCount; index++) {
+        seen += buckets_[index];
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(index), max_);
+        }
+    }
+    return max_;
+}
+
+void LatencyHistogram::reset()
+{
+    buckets_.fill(0);
+    count_ = 0;
+    min_ = UINT32_MAX;
+    max_ = 0;
+    sum_ = 0;
+}
+
+size_t LatencyHistogram::bucketIndex(uint32_t value)
+{
+    if (value < linearLimit) {
+        return value;
+    }
+
+    // Position of the highest set bit, at least subBucketBits + 1 here
+    unsigned exponent = 31;
+    while ((value & (1u << exponent)) == 0) {
+        exponent--;
+    }
+    const unsigned shift = exponent - subBucketBits;
+    // The bits right below the highest one select the sub-bucket
+    const uint32_t subBucket = (value >> shift) & (subBucketCount - 1);
+    return linearLimit + (shift - 1) * subBucketCount + subBucket;
+}
+
+uint32_t LatencyHistogram::bucketUpperBound(size_t index)
+{
+    if (index < linearLimit) {
+        return static_cast<uint32_t>(index);
+    }
+
+    const unsigned shift = static_cast<unsigned>((index - linearLimit) / subBucketCount) + 1;
+    const uint64_t subBucket = (index - linearLimit) % subBucketCount;
+    const uint64_t lowerBound = (subBucketCount + subBucket) << shift;
+    return static_cast<uint32_t>(std::min<uint64_t>(lowerBound + (1ull << shift) - 1, UINT32_MAX));
+}
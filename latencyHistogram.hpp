@@ -0,0 +1,55 @@
+#ifndef BASECAMP_LATENCY_HISTOGRAM_HPP
+#define BASECAMP_LATENCY_HISTOGRAM_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+  Log-linear histogram of durations, in the spirit of HdrHistogram.
+  Values below 16 are counted exactly, larger ones in 8 buckets per power of two, so any value is
+  reported with at most 12.5% error. The whole uint32_t range fits into 240 fixed buckets, recording
+  takes constant time and never allocates.
+*/
+class LatencyHistogram
+{
+public:
+    /// Counts a value, e.g. a latency in ms.
+    void record(uint32_t value);
+
+    /// Number of recorded values.
+    uint32_t count() const;
+    uint32_t min() const;
+    uint32_t max() const;
+    /// Arithmetic mean of the recorded values, 0 if there are none.
+    uint32_t mean() const;
+
+    /**
+        Value below or at which "percentile" percent of the recorded values lie.
+        @param percentile 0 to 100, e.g. 99.9.
+        @return Upper bound of the bucket containing the percentile, never more than max().
+     */
+    uint32_t percentile(float percentile) const;
+
+    /// Forget all recorded values.
+    void reset();
+
+private:
+    static const constexpr unsigned subBucketBits = 3;
+    static const constexpr uint32_t subBucketCount = 1u << subBucketBits;
+    /// Values below this get a bucket of their own
+    static const constexpr uint32_t linearLimit = subBucketCount * 2;
+    static const constexpr size_t bucketCount = linearLimit + (32 - subBucketBits - 1) * subBucketCount;
+
+    static size_t bucketIndex(uint32_t value);
+    /// Largest value counted in bucket "index"
+    static uint32_t bucketUpperBound(size_t index);
+
+    std::array<uint32_t, bucketCount> buckets_ = {};
+    uint32_t count_ = 0;
+    uint32_t min_ = UINT32_MAX;
+    uint32_t max_ = 0;
+    uint64_t sum_ = 0;
+};
+
+#endif // BASECAMP_LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,417 @@
+#include "mqttDispatcher.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+namespace {
+    /// Marks a missing child
+    const constexpr uint32_t noNode = UINT32_MAX;
+    const constexpr size_t defaultMaxMessageSize = 4096;
+    /// Buffers kept for reuse, AsyncMqttClient delivers one message at a time
+    const constexpr size_t maxPooledBuffers = 2;
+    /// FNV-1a
+    const constexpr uint32_t digestOffset = 2166136261u;
+    const constexpr uint32_t digestPrime = 16777619u;
+
+    uint32_t addToDigest(uint32_t digest, const void* data, size_t length)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < length; ++i) {
+            digest = (digest ^ bytes[i]) * digestPrime;
+        }
+        return digest;
+    }
+
+    /// One topic level, not NUL-terminated
+    struct Level
+    {
+        const char* begin;
+        size_t length;
+    };
+
+    /// Splits off the first level of "topic", "rest" is nullptr if it was the last one
+    Level firstLevel(const char* topic, const char*& rest)
+    {
+        const char* end = std::strchr(topic, '/');
+        if (end == nullptr) {
+            rest = nullptr;
+            return Level{topic, std::strlen(topic)};
+        }
+        rest = end + 1;
+        return Level{topic, static_cast<size_t>(end - topic)};
+    }
+
+    bool isLevel(const Level& level, char wildcard)
+    {
+        return level.length == 1 && level.begin[0] == wildcard;
+    }
+}
+
+struct MqttDispatcher::State
+{
+    struct Node
+    {
+        /// Children by topic level, sorted for binary search
+        std::vector<std::pair<std::string, uint32_t>> children;
+        /// Child for "+"
+        uint32_t plus = noNode;
+        /// Child for "#", always a leaf
+        uint32_t hash = noNode;
+        std::vector<std::pair<HandlerId, Handler>> handlers;
+    };
+
+    struct Subscription
+    {
+        std::string filter;
+        uint8_t qos;
+    };
+
+    struct Filter
+    {
+        size_t handlers;
+        uint8_t qos;
+    };
+
+    State()
+        : nodes(1)
+    {
+    }
+
+    /// Returns the child of "node" for the literal "level", creating it if "create" is set
+    uint32_t child(uint32_t node, const Level& level, bool create)
+    {
+        auto& children = nodes[node].children;
+        auto position = std::lower_bound(children.begin(), children.end(), level,
+            [](const std::pair<std::string, uint32_t>& entry, const Level& key) {
+                return entry.first.compare(0, std::string::npos, key.begin, key.length) < 0;
+            });
+        if (position != children.end() && position->first.compare(0, std::string::npos, level.begin, level.length) == 0) {
+            return position->second;
+        }
+        if (!create) {
+            return noNode;
+        }
+
+        const uint32_t created = static_cast<uint32_t>(nodes.size());
+        children.emplace(position, std::string(level.begin, level.length), created);
+        nodes.emplace_back();
+        return created;
+    }
+
+    /// Returns the node of "filter", creating the path if "create" is set
+    uint32_t find(const char* filter, bool create)
+    {
+        uint32_t node = 0;
+        const char* rest = filter;
+        while (rest != nullptr && node != noNode) {
+            const Level level = firstLevel(rest, rest);
+            uint32_t Node::*wildcard = isLevel(level, '+') ? &Node::plus : (isLevel(level, '#') ? &Node::hash : nullptr);
+            if (wildcard == nullptr) {
+                node = child(node, level, create);
+                continue;
+            }
+            if (nodes[node].*wildcard == noNode && create) {
+                nodes[node].*wildcard = static_cast<uint32_t>(nodes.size());
+                nodes.emplace_back();
+            }
+            node = nodes[node].*wildcard;
+        }
+        return node;
+    }
+
+    void addHandlers(uint32_t node)
+    {
+        for (const auto& handler : nodes[node].handlers) {
+            matched.push_back(handler.second);
+        }
+    }
+
+    /// Collects the handlers of all filters below "node" matching "topic" (the remaining levels) in "matched"
+    void collect(uint32_t node, const char* topic, bool firstLevelOfTopic)
+    {
+        const Node& current = nodes[node];
+        if (topic == nullptr) {
+            addHandlers(node);
+            // "a/#" matches "a" as well
+            if (current.hash != noNode) {
+                addHandlers(current.hash);
+            }
+            return;
+        }
+
+        const bool wildcards = !(firstLevelOfTopic && topic[0] == '$');
+        if (wildcards && current.hash != noNode) {
+            addHandlers(current.hash);
+        }
+
+        const char* rest = nullptr;
+        const uint32_t exact = child(node, firstLevel(topic, rest), false);
+        if (exact != noNode) {
+            collect(exact, rest, false);
+        }
+        if (wildcards && current.plus != noNode) {
+            collect(current.plus, rest, false);
+        }
+    }
+
+    /// Digest of the filters and their QoS, never 0
+    uint32_t filterDigest() const
+    {
+        uint32_t digest = digestOffset;
+        for (const auto& filter : filters) {
+            // Including the NUL, so filters cannot run into each other
+            digest = addToDigest(digest, filter.first.c_str(), filter.first.size() + 1);
+            digest = addToDigest(digest, &filter.second.qos, sizeof(filter.second.qos));
+        }
+        return (digest == 0) ? 1 : digest;
+    }
+
+    /// Remembers the filters as subscribed at the broker, returns the callback to call if they changed
+    std::function<void()> updateSession()
+    {
+        const uint32_t digest = filterDigest();
+        if (digest == sessionDigest || !sessionCallback) {
+            sessionDigest = digest;
+            return {};
+        }
+        sessionDigest = digest;
+        return std::bind(sessionCallback, digest);
+    }
+
+    std::vector<char> acquireBuffer()
+    {
+        if (pool.empty()) {
+            return {};
+        }
+        std::vector<char> buffer = std::move(pool.back());
+        pool.pop_back();
+        return buffer;
+    }
+
+    void releaseBuffer(std::vector<char>& buffer)
+    {
+        buffer.clear();
+        // Do not keep buffers of messages which would be dropped now
+        if (pool.size() < maxPooledBuffers && buffer.capacity() <= maxMessageSize + 1) {
+            pool.push_back(std::move(buffer));
+        }
+        buffer = std::vector<char>();
+    }
+
+    /// Guards everything below, messages arrive on the task of AsyncTCP
+    mutable std::mutex mutex;
+    /// nodes[0] is the root, nodes are never removed
+    std::vector<Node> nodes;
+    std::map<HandlerId, Subscription> subscriptions;
+    std::map<std::string, Filter> filters;
+    /// Digest of the filters subscribed at the broker, 0 if unknown
+    uint32_t sessionDigest = 0;
+    SessionCallback sessionCallback;
+    HandlerId nextId = 1;
+    size_t maxMessageSize = defaultMaxMessageSize;
+    std::vector<std::vector<char>> pool;
+    /// Handlers of the message being dispatched, reused
+    std::vector<Handler> matched;
+
+    /// Message being reassembled
+    std::vector<char> message;
+    bool dropping = false;
+};
+
+MqttDispatcher::MqttDispatcher(AsyncMqttClient& mqttClient)
+    : mqttClient_(mqttClient)
+    , state_(std::make_shared<State>())
+{
+}
+
+bool MqttDispatcher::isValidFilter(const char* filter)
+{
+    if (filter == nullptr || filter[0] == '\0') {
+        return false;
+    }
+
+    const char* rest = filter;
+    while (rest != nullptr) {
+        const Level level = firstLevel(rest, rest);
+        const bool plus = isLevel(level, '+');
+        const bool hash = isLevel(level, '#');
+        // Wildcards have to occupy a whole level, "#" has to be the last one
+        if ((!plus && !hash && (std::memchr(level.begin, '+', level.length) || std::memchr(level.begin, '#', level.length))) ||
+            (hash && rest != nullptr)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MqttDispatcher::attach()
+{
+    if (attached_) {
+        return;
+    }
+    attached_ = true;
+
+    // The callbacks keep the state alive until they are gone.
+    auto state = state_;
+    AsyncMqttClient* client = &mqttClient_;
+    mqttClient_.onConnect([state, client](bool sessionPresent) {
+        std::vector<std::pair<std::string, uint8_t>> filters;
+        std::function<void()> sessionChanged;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            // The broker still has every filter
+            if (sessionPresent && state->sessionDigest == state->filterDigest()) {
+                return;
+            }
+            for (const auto& filter : state->filters) {
+                filters.emplace_back(filter.first, filter.second.qos);
+            }
+            sessionChanged = state->updateSession();
+        }
+        for (const auto& filter : filters) {
+            client->subscribe(filter.first.c_str(), filter.second);
+        }
+        if (sessionChanged) {
+            sessionChanged();
+        }
+    });
+
+    mqttClient_.onMessage([state](char* topic, char* payload, AsyncMqttClientMessageProperties /*properties*/,
+            size_t length, size_t index, size_t total) {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        if (index == 0) {
+            state->releaseBuffer(state->message);
+            state->dropping = (total > state->maxMessageSize);
+            if (!state->dropping) {
+                state->message = state->acquireBuffer();
+                state->message.reserve(total + 1);
+            }
+        }
+        // Fragments of one message arrive in order, anything else is a lost start
+        if (state->dropping || index != state->message.size()) {
+            return;
+        }
+        state->message.insert(state->message.end(), payload, payload + length);
+        if (state->message.size() < total) {
+            return;
+        }
+
+        state->collect(0, topic, true);
+        std::vector<Handler> matched;
+        matched.swap(state->matched);
+        std::vector<char> message = std::move(state->message);
+        state->message = std::vector<char>();
+        lock.unlock();
+
+        message.push_back('\0');
+        for (const auto& handler : matched) {
+            handler(topic, message.data(), total);
+        }
+        matched.clear();
+
+        // Keep the buffers for the next message
+        lock.lock();
+        state->releaseBuffer(message);
+        if (state->matched.capacity() < matched.capacity()) {
+            state->matched.swap(matched);
+        }
+    });
+}
+
+MqttDispatcher::HandlerId MqttDispatcher::subscribe(const char* filter, uint8_t qos, Handler handler)
+{
+    if (!isValidFilter(filter) || !handler) {
+        return 0;
+    }
+    attach();
+
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    const HandlerId id = state_->nextId++;
+    const uint32_t node = state_->find(filter, true);
+    state_->nodes[node].handlers.emplace_back(id, std::move(handler));
+    state_->subscriptions[id] = State::Subscription{filter, qos};
+
+    auto inserted = state_->filters.emplace(filter, State::Filter{0, qos});
+    auto& entry = inserted.first->second;
+    ++entry.handlers;
+    const bool subscribeAtBroker = (inserted.second || qos > entry.qos);
+    entry.qos = std::max(entry.qos, qos);
+    const uint8_t brokerQos = entry.qos;
+    const bool connected = subscribeAtBroker && mqttClient_.connected();
+    std::function<void()> sessionChanged;
+    if (connected) {
+        sessionChanged = state_->updateSession();
+    }
+    lock.unlock();
+
+    // Subscribed on connect otherwise
+    if (connected) {
+        mqttClient_.subscribe(filter, brokerQos);
+    }
+    if (sessionChanged) {
+        sessionChanged();
+    }
+    return id;
+}
+
+void MqttDispatcher::unsubscribe(HandlerId id)
+{
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    auto subscription = state_->subscriptions.find(id);
+    if (subscription == state_->subscriptions.end()) {
+        return;
+    }
+    const std::string filter = std::move(subscription->second.filter);
+    state_->subscriptions.erase(subscription);
+
+    auto& handlers = state_->nodes[state_->find(filter.c_str(), false)].handlers;
+    handlers.erase(std::find_if(handlers.begin(), handlers.end(),
+        [id](const std::pair<HandlerId, Handler>& handler) { return handler.first == id; }));
+
+    auto entry = state_->filters.find(filter);
+    if (--entry->second.handlers > 0) {
+        return;
+    }
+    state_->filters.erase(entry);
+    const bool connected = mqttClient_.connected();
+    std::function<void()> sessionChanged;
+    if (connected) {
+        sessionChanged = state_->updateSession();
+    }
+    lock.unlock();
+
+    if (connected) {
+        mqttClient_.unsubscribe(filter.c_str());
+    }
+    if (sessionChanged) {
+        sessionChanged();
+    }
+}
+
+void MqttDispatcher::resumeSession(uint32_t digest, SessionCallback callback)
+{
+    attach();
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->sessionDigest = digest;
+    state_->sessionCallback = std::move(callback);
+}
+
+void MqttDispatcher::setMaxMessageSize(size_t size)
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->maxMessageSize = size;
+}
+
+size_t MqttDispatcher::handlerCount() const
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->subscriptions.size();
+}
+
+size_t MqttDispatcher::filterCount() const
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->filters.size();
+}
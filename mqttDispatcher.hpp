@@ -0,0 +1,83 @@
+#ifndef BASECAMP_MQTT_DISPATCHER_HPP
+#define BASECAMP_MQTT_DISPATCHER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <AsyncMqttClient.h>
+
+/**
+    Dispatches incoming MQTT messages to handlers subscribed by topic filter.
+
+    Filters may contain the wildcards "+" (one level) and "#" (all remaining levels, must be last).
+    Filters are kept in a trie of topic levels, so matching a topic only visits the levels of the topic
+    and the wildcard branches on the way instead of comparing it against every filter. Topics starting
+    with "$" are not matched by wildcards on the first level.
+
+    Messages arriving in fragments are reassembled first. Handlers always get the complete payload,
+    followed by a NUL, so it can be used as a string. Buffers are reused from a small pool.
+
+    The filters are subscribed at the broker when they are added while connected and again on every
+    connect, unless a persistent session with the same filters is resumed, see resumeSession().
+    Like MqttGuardInterface, the callbacks of the client are only registered on first use.
+    Handlers are called from the task of AsyncTCP, they may subscribe and unsubscribe.
+ */
+class MqttDispatcher
+{
+public:
+    /// Payload is NUL-terminated, "length" excludes the NUL
+    using Handler = std::function<void(const char* topic, const char* payload, size_t length)>;
+    using HandlerId = uint32_t;
+    /// Receives the digest of the filters subscribed at the broker whenever it changes
+    using SessionCallback = std::function<void(uint32_t digest)>;
+
+    explicit MqttDispatcher(AsyncMqttClient& mqttClient);
+
+    /**
+        Call "handler" for every message matching "filter".
+        @param qos Maximum QoS the broker should deliver with, the highest one of all handlers of a filter is used.
+        @return Id to unsubscribe the handler, 0 if the filter is not valid.
+     */
+    HandlerId subscribe(const char* filter, uint8_t qos, Handler handler);
+
+    /// Remove a handler. The filter is unsubscribed at the broker once its last handler is gone.
+    void unsubscribe(HandlerId id);
+
+    /**
+        Skip subscribing on connect while the broker keeps a session (cleanSession=false) which has all filters.
+        As long as the broker reports a present session and the filters still have "digest", they are not
+        subscribed again. Otherwise all filters are subscribed and "callback" gets the new digest, keep it
+        (e.g. in RTC memory) for the next resumeSession(). 0 is never a valid digest, pass it if there is none.
+        Filters removed while disconnected stay subscribed at the broker until the session ends.
+     */
+    void resumeSession(uint32_t digest, SessionCallback callback);
+
+    /// Messages larger than "size" bytes are dropped. Default is 4096.
+    void setMaxMessageSize(size_t size);
+
+    /// Returns the amount of subscribed handlers
+    size_t handlerCount() const;
+
+    /// Returns the amount of distinct filters subscribed at the broker
+    size_t filterCount() const;
+
+    /// Returns true if "filter" is a valid MQTT topic filter
+    static bool isValidFilter(const char* filter);
+
+private:
+    /// Trie, message reassembly and buffers, shared with the callbacks of the client.
+    struct State;
+
+    /// Registers the internal callbacks with the client, once.
+    void attach();
+
+    AsyncMqttClient& mqttClient_;
+    std::shared_ptr<State> state_;
+    bool attached_ = false;
+};
+
+#endif // BASECAMP_MQTT_DISPATCHER_HPP
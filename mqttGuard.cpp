@@ -1,11 +1,29 @@
 #include "mqttGuard.hpp"
 
-#include <algorithm>
 #include <sstream>
+#include <utility>
 
-MqttGuard::MqttGuard(basecampLog::LogCallback logCallback)
+const constexpr size_t MqttGuard::maxTrackedPackets;
+const constexpr size_t MqttGuard::tableSize;
+const constexpr size_t MqttGuard::slotMask;
+const constexpr MqttGuard::IdType MqttGuard::emptySlot;
+
+MqttGuard::MqttGuard(basecampLog::LogCallback logCallback, Clock clock)
     : logCallback_(std::move(logCallback))
+    , clock_(std::move(clock))
+{
+    slots_.fill(emptySlot);
+    sentAt_.fill(0);
+}
+
+void MqttGuard::setDeadline(uint32_t deadline, TimeoutCallback callback)
 {
+    deadline_ = deadline;
+    timeoutCallback_ = std::move(callback);
+    if (timeoutCallback_) {
+        // Once, so checkTimeouts() never allocates
+        expired_.reserve(maxTrackedPackets);
+    }
 }
 
 void MqttGuard::registerPacket(IdType packetId)
@@ -15,24 +33,117 @@ void MqttGuard::registerPacket(IdType packetId)
         return;
     }
 
-    packets_.emplace_back(packetId);
+    const uint32_t sentAt = now();
+    if (trackedPackets_ >= maxTrackedPackets) {
+        tryLog(basecampLog::Severity::warning, "Too many MQTT-packets in flight, only counting.", packetId);
+        untrackedPackets_++;
+        untrackedSentAt_ = sentAt;
+        return;
+    }
+
+    // Robin Hood: an entry closer to its home slot makes room for the one being inserted,
+    // this keeps probe sequences short and sorted by distance
+    IdType entry = packetId;
+    uint32_t entrySentAt = sentAt;
+    size_t distance = 0;
+    size_t slot = packetId & slotMask;
+    while (slots_[slot] != emptySlot) {
+        const size_t existingDistance = probeDistance(slot);
+        if (existingDistance < distance) {
+            std::swap(entry, slots_[slot]);
+            std::swap(entrySentAt, sentAt_[slot]);
+            distance = existingDistance;
+        }
+        slot = (slot + 1) & slotMask;
+        distance++;
+    }
+    slots_[slot] = entry;
+    sentAt_[slot] = entrySentAt;
+    trackedPackets_++;
 }
 
 void MqttGuard::unregisterPacket(IdType packetId)
 {
-    auto found = std::find(packets_.begin(), packets_.end(), packetId);
-
-    if (found == packets_.end()) {
+    const size_t slot = findSlot(packetId);
+
+    if (slot == tableSize) {
+        // Most likely one of the packets registered while the table was full
+        if (untrackedPackets_ > 0) {
+            untrackedPackets_--;
+            statistics_.acknowledged++;
+            return;
+        }
         tryLog(basecampLog::Severity::info, "Not unregistering unknown MQTT-packet.", packetId);
         return;
     }
 
-    packets_.erase(found);
+    if (clock_) {
+        latency_.record(now() - sentAt_[slot]);
+    }
+    statistics_.acknowledged++;
+    removeSlot(slot);
+}
+
+size_t MqttGuard::checkTimeouts()
+{
+    if (deadline_ == 0 || !clock_) {
+        return 0;
+    }
+
+    size_t timeouts = 0;
+    const uint32_t currentTime = now();
+    expired_.clear();
+    // A single pass: removing a packet shifts the following ones back by one slot, so the same
+    // slot is looked at again. Entries wrapped around to the start of the table may only be
+    // shifted back to its end, where they are looked at once more.
+    for (size_t slot = 0; slot < tableSize;) {
+        if (slots_[slot] == emptySlot || (currentTime - sentAt_[slot]) < deadline_) {
+            slot++;
+            continue;
+        }
+
+        const IdType packetId = slots_[slot];
+        const uint32_t waited = currentTime - sentAt_[slot];
+        removeSlot(slot);
+        tryLog(basecampLog::Severity::warning, "MQTT-packet has not been acknowledged in time.", packetId);
+        statistics_.timeouts++;
+        timeouts++;
+        if (timeoutCallback_) {
+            expired_.emplace_back(packetId, waited);
+        }
+    }
+
+    if (untrackedPackets_ > 0 && (currentTime - untrackedSentAt_) >= deadline_) {
+        tryLog(basecampLog::Severity::warning, "Untracked MQTT-packets have not been acknowledged in time.");
+        statistics_.timeouts += untrackedPackets_;
+        timeouts += untrackedPackets_;
+        untrackedPackets_ = 0;
+    }
+
+    if (!expired_.empty()) {
+        // Only after the scan, the callback may register new packets or even replace itself
+        const TimeoutCallback callback = timeoutCallback_;
+        for (size_t i = 0; i < expired_.size(); i++) {
+            callback(expired_[i].first, expired_[i].second);
+        }
+        expired_.clear();
+    }
+    return timeouts;
 }
 
 size_t MqttGuard::remainingPacketCount() const
 {
-    return packets_.size();
+    return trackedPackets_ + untrackedPackets_;
+}
+
+bool MqttGuard::isRegistered(IdType packetId) const
+{
+    return (packetId != emptySlot && findSlot(packetId) != tableSize);
+}
+
+size_t MqttGuard::untrackedPacketCount() const
+{
+    return untrackedPackets_;
 }
 
 bool MqttGuard::allSent() const
@@ -43,13 +154,13 @@ bool MqttGuard::allSent() const
 bool MqttGuard::isValidPacketId(IdType packetId) const
 {
     // Generally invalid packet id
-    if (packetId == 0)
+    if (packetId == emptySlot)
     {
         return false;
     }
 
     // Do not allow duplicates
-    if (std::find(packets_.begin(), packets_.end(), packetId) != packets_.end())
+    if (findSlot(packetId) != tableSize)
     {
         return false;
     }
@@ -57,11 +168,60 @@ bool MqttGuard::isValidPacketId(IdType packetId) const
     return true;
 }
 
+size_t MqttGuard::findSlot(IdType packetId) const
+{
+    size_t distance = 0;
+    for (size_t slot = packetId & slotMask; slots_[slot] != emptySlot; slot = (slot + 1) & slotMask) {
+        if (slots_[slot] == packetId) {
+            return slot;
+        }
+        // packetId would have displaced an entry this close to its home slot
+        if (probeDistance(slot) < distance) {
+            break;
+        }
+        distance++;
+    }
+
+    return tableSize;
+}
+
+void MqttGuard::removeSlot(size_t hole)
+{
+    // Backward shift deletion: move the following entries one slot closer to their home slot,
+    // so lookups never have to skip deleted slots. Stops at the first entry already at home.
+    for (size_t next = (hole + 1) & slotMask; slots_[next] != emptySlot && probeDistance(next) != 0; next = (next + 1) & slotMask) {
+        slots_[hole] = slots_[next];
+        sentAt_[hole] = sentAt_[next];
+        hole = next;
+    }
+    slots_[hole] = emptySlot;
+    trackedPackets_--;
+}
+
+uint32_t MqttGuard::now() const
+{
+    return clock_ ? clock_() : 0;
+}
+
 void MqttGuard::reset()
 {
     tryLog(basecampLog::Severity::warning, "MqttGuard has been manually reset.");
 
-    packets_.clear();
+    statistics_.resets++;
+    statistics_.resetPackets += remainingPacketCount();
+    slots_.fill(emptySlot);
+    trackedPackets_ = 0;
+    untrackedPackets_ = 0;
+}
+
+const LatencyHistogram& MqttGuard::getLatencyHistogram() const
+{
+    return latency_;
+}
+
+const MqttGuard::Statistics& MqttGuard::getStatistics() const
+{
+    return statistics_;
 }
 
 void MqttGuard::tryLog(basecampLog::Severity severity, const std::string &message)
@@ -2,14 +2,25 @@
 #define BASECAMP_MQTT_GUARD_HPP
 
 #include "log.hpp"
+#include "latencyHistogram.hpp"
 
+#include <array>
+#include <cstdint>
 #include <functional>
+#include <utility>
 #include <vector>
 
 /**
   Helper to guard outgoing mqtt packets.
   On packet sending, register the packets within this class, unregister them within the onPublish and
   pull the allSent() function to see if everything has been sent completely.
+
+  Packet ids are kept in a fixed-size Robin Hood hash table with backward shift deletion, so
+  registering, unregistering and counting take constant time and never allocate.
+  Packets beyond maxTrackedPackets are only counted.
+
+  With a clock, the time from registering to unregistering a packet is recorded in a latency
+  histogram. Packets not acknowledged within the deadline are dropped by checkTimeouts().
 */
 class MqttGuard
 {
@@ -17,13 +28,47 @@ public:
     /// Typesafety forward of AsyncMqttClients packet_id type
     using IdType = uint16_t;
 
+    /// Packets tracked by id, keeps the load factor of the table at 3/4
+    static const constexpr size_t maxTrackedPackets = 384;
+
+    /// Source of the current time in ms, e.g. millis()
+    using Clock = std::function<uint32_t()>;
+    /// Called for a packet dropped by checkTimeouts(), with the time it has been waited for
+    using TimeoutCallback = std::function<void(IdType packetId, uint32_t waited)>;
+
+    struct Statistics
+    {
+        /// Packets unregistered in time
+        uint32_t acknowledged = 0;
+        /// Packets dropped by checkTimeouts()
+        uint32_t timeouts = 0;
+        /// Calls of reset()
+        uint32_t resets = 0;
+        /// Packets dropped by reset()
+        uint32_t resetPackets = 0;
+    };
+
     /**
         Construct a new guard.
         @param LogCallback Optional log callback.
+        @param clock Optional clock, without it neither latencies nor timeouts are tracked.
      */
-    explicit MqttGuard(basecampLog::LogCallback logCallback = {});
+    explicit MqttGuard(basecampLog::LogCallback logCallback = {}, Clock clock = {});
     ~MqttGuard() = default;
 
+    /**
+        Set how long a packet may wait for its acknowledgement.
+        @param deadline Time in ms, 0 (default) waits forever.
+        @param callback Optional callback for each packet dropped by checkTimeouts().
+     */
+    void setDeadline(uint32_t deadline, TimeoutCallback callback = {});
+
+    /**
+        Drop all packets waiting longer than the deadline, so allSent() does not wait for lost acks.
+        @return The number of dropped packets.
+     */
+    size_t checkTimeouts();
+
     /**
         Register a new packet that is going to sent by mqtt.
         @param packetId Packet-ID returned by AsyncMqttClient::publish()
@@ -39,6 +84,12 @@ public:
     /// Returns the amount of packets waiting to be sent.
     size_t remainingPacketCount() const;
 
+    /// Returns true if packetId is waiting to be sent.
+    bool isRegistered(IdType packetId) const;
+
+    /// Returns the amount of packets registered while the table was full, see maxTrackedPackets.
+    size_t untrackedPacketCount() const;
+
     /// Returns true if all packets have been sent.
     bool allSent() const;
 
@@ -47,7 +98,19 @@ public:
         Maybe necessary if getting disconnected.
      */
     void reset();
+
+    /// Time from registering to unregistering of the acknowledged packets (ms).
+    const LatencyHistogram& getLatencyHistogram() const;
+
+    const Statistics& getStatistics() const;
+
 private:
+    /// Power of two, AsyncMqttClient hands out consecutive ids, so the id itself is a good hash.
+    static const constexpr size_t tableSize = 512;
+    static const constexpr size_t slotMask = tableSize - 1;
+    /// Marks empty slots, 0 is never a valid packet id
+    static const constexpr IdType emptySlot = 0;
+
     /**
         Check a packetId for validity.
         @param packetId Packet-ID to be checked.
@@ -55,6 +118,20 @@ private:
      */
     bool isValidPacketId(IdType packetId) const;
 
+    /// Slot of packetId or tableSize if it is not registered.
+    size_t findSlot(IdType packetId) const;
+
+    /// Remove the entry in slot
+    void removeSlot(size_t slot);
+
+    uint32_t now() const;
+
+    /// Distance of the entry in slot from its home slot
+    size_t probeDistance(size_t slot) const
+    {
+        return (slot - (slots_[slot] & slotMask)) & slotMask;
+    }
+
     /// Try to log message if logCallback_ has been set in ctor.
     void tryLog(basecampLog::Severity severity, const std::string& message);
 
@@ -63,8 +140,23 @@ private:
 
     /// Optional callback for log-messages
     basecampLog::LogCallback logCallback_;
-    /// List of all remaining packets
-    std::vector<IdType> packets_;
+    Clock clock_;
+    uint32_t deadline_ = 0;
+    TimeoutCallback timeoutCallback_;
+    /// Ids of the remaining packets, emptySlot for unused slots
+    std::array<IdType, tableSize> slots_;
+    /// Registration times of the packets in slots_
+    std::array<uint32_t, tableSize> sentAt_;
+    /// Number of ids in slots_
+    size_t trackedPackets_ = 0;
+    /// Packets registered while the table was full, they cannot be told apart anymore
+    size_t untrackedPackets_ = 0;
+    /// Registration time of the latest untracked packet, they time out together
+    uint32_t untrackedSentAt_ = 0;
+    /// Packets dropped by checkTimeouts() and the time waited for them, passed to timeoutCallback_ afterwards
+    std::vector<std::pair<IdType, uint32_t>> expired_;
+    LatencyHistogram latency_;
+    Statistics statistics_;
 };
 
 #endif // #define BASECAMP_MQTT_GUARD_HPP
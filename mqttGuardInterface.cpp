@@ -1,52 +1,724 @@
 #include "mqttGuardInterface.hpp"
 
+#include "debug.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace {
+    struct Batch
+    {
+        uint32_t id;
+        /// Ids of the QoS 1/2 messages not acknowledged yet
+        std::vector<uint16_t> pending;
+        MqttGuardInterface::MqttBatchCallback callback;
+        /// Still being published, cannot be complete yet
+        bool open;
+        /// Outcome so far, reported when an open batch is closed
+        MqttBatchResult result;
+    };
+
+    struct Stream
+    {
+        uint32_t id;
+        std::string topic;
+        uint8_t qos;
+        size_t total;
+        size_t chunkSize;
+        size_t chunkCount;
+        /// Index of the chunk in buffer, all before have been sent
+        size_t chunk = 0;
+        MqttGuardInterface::MqttChunkProducer producer;
+        MqttGuardInterface::MqttBatchCallback callback;
+        /// The current chunk, allocated once for the whole stream
+        std::vector<char> buffer;
+        size_t bufferLength = 0;
+        bool produced = false;
+        /// QoS 1/2 chunk waiting for its acknowledgement
+        uint16_t pendingPacket = 0;
+        /// Being produced or published by a task, which finishes it
+        bool busy = false;
+        MqttBatchResult result = MqttBatchResult::acknowledged;
+    };
+
+    /// Acknowledgements remembered for packets not registered yet, see State::takeEarlyAck()
+    const constexpr size_t maxEarlyAcks = 8;
+    /// Replay credit needed for one message, credit grows by the rate per ms
+    const constexpr uint32_t replayCost = 1000;
+}
+
+struct MqttGuardInterface::State
+{
+    explicit State(AsyncMqttClient& mqttClient)
+        : client(mqttClient)
+        , guard(basecampLog::LogCallback{}, []() -> uint32_t { return millis(); })
+    {
+    }
+
+    void acknowledge(uint16_t packetId)
+    {
+        // The acknowledgement may be processed on the AsyncTCP task before publish() has returned the
+        // id on the publishing task. Remember it until the packet is registered.
+        if (!guard.isRegistered(packetId) && guard.untrackedPacketCount() == 0) {
+            earlyAcks[nextEarlyAck] = packetId;
+            nextEarlyAck = (nextEarlyAck + 1) % maxEarlyAcks;
+            return;
+        }
+
+        guard.unregisterPacket(packetId);
+        forget(packetId);
+        finishBatchOf(packetId, true);
+        finishChunkOf(packetId, true);
+    }
+
+    /// Register a packet that has just been published. Returns false if it has been acknowledged already.
+    bool registerPacket(uint16_t packetId)
+    {
+        guard.registerPacket(packetId);
+        auto earlyAck = std::find(earlyAcks.begin(), earlyAcks.end(), packetId);
+        if (earlyAck == earlyAcks.end()) {
+            return true;
+        }
+
+        *earlyAck = 0;
+        guard.unregisterPacket(packetId);
+        return false;
+    }
+
+    /// Finish the batch waiting for packetId, if any
+    void finishBatchOf(uint16_t packetId, bool acknowledged)
+    {
+        for (auto batch = batches.begin(); batch != batches.end(); ++batch) {
+            auto pending = std::find(batch->pending.begin(), batch->pending.end(), packetId);
+            if (pending == batch->pending.end()) {
+                continue;
+            }
+
+            batch->pending.erase(pending);
+            if (!acknowledged && batch->open) {
+                batch->result = MqttBatchResult::timedOut;
+            } else if (!acknowledged) {
+                notify(batch->callback, MqttBatchResult::timedOut);
+                batches.erase(batch);
+            } else if (!batch->open && batch->pending.empty()) {
+                notify(batch->callback, MqttBatchResult::acknowledged);
+                batches.erase(batch);
+            }
+            return;
+        }
+    }
+
+    /// Continue or fail the stream waiting for packetId, if any
+    void finishChunkOf(uint16_t packetId, bool acknowledged)
+    {
+        for (auto stream = streams.begin(); stream != streams.end(); ++stream) {
+            if ((*stream)->pendingPacket != packetId) {
+                continue;
+            }
+            (*stream)->pendingPacket = 0;
+            if (acknowledged) {
+                nextChunk(**stream);
+            } else {
+                finishStream(stream, MqttBatchResult::timedOut);
+            }
+            return;
+        }
+    }
+
+    static void nextChunk(Stream& stream)
+    {
+        ++stream.chunk;
+        stream.produced = false;
+    }
+
+    /// Report "result" unless the stream is busy, the task working on it reports it then
+    void finishStream(std::vector<std::unique_ptr<Stream>>::iterator stream, MqttBatchResult result)
+    {
+        if ((*stream)->result == MqttBatchResult::acknowledged) {
+            (*stream)->result = result;
+        }
+        if (!(*stream)->busy) {
+            notify((*stream)->callback, (*stream)->result);
+            streams.erase(stream);
+        }
+    }
+
+    std::vector<std::unique_ptr<Stream>>::iterator findStream(uint32_t id)
+    {
+        return std::find_if(streams.begin(), streams.end(),
+            [id](const std::unique_ptr<Stream>& stream) { return stream->id == id; });
+    }
+
+    /// Produce and publish chunks of streams not waiting for an acknowledgement. Unlocks while doing so.
+    size_t pumpStreams(std::unique_lock<std::mutex>& lock)
+    {
+        std::vector<uint32_t> ready;
+        for (const auto& stream : streams) {
+            if (!stream->busy && stream->pendingPacket == 0) {
+                ready.push_back(stream->id);
+            }
+        }
+
+        size_t published = 0;
+        for (const uint32_t id : ready) {
+            auto position = findStream(id);
+            if (position == streams.end() || (*position)->busy) {
+                continue;
+            }
+            // Stays valid while busy, the stream is only erased by the task it is busy with
+            Stream* stream = position->get();
+            stream->busy = true;
+
+            while (stream->result == MqttBatchResult::acknowledged && stream->pendingPacket == 0 &&
+                    stream->chunk < stream->chunkCount) {
+                const size_t offset = stream->chunk * stream->chunkSize;
+                if (!stream->produced) {
+                    const size_t length = std::min(stream->chunkSize, stream->total - offset);
+                    lock.unlock();
+                    const size_t produced = (length == 0) ? 0 : stream->producer(offset, stream->buffer.data(), length);
+                    lock.lock();
+                    if (produced != length) {
+                        DEBUG_PRINTLN("Stream producer failed");
+                        stream->result = MqttBatchResult::failed;
+                        break;
+                    }
+                    stream->bufferLength = length;
+                    stream->produced = true;
+                }
+
+                // "<topic>/<chunk>/<count>"
+                const std::string topic = stream->topic + "/" + std::to_string(stream->chunk) + "/" + std::to_string(stream->chunkCount);
+                lock.unlock();
+                const uint16_t packetId = client.publish(topic.c_str(), stream->qos, false,
+                    (stream->bufferLength == 0) ? nullptr : stream->buffer.data(), stream->bufferLength);
+                lock.lock();
+                if (packetId == 0) {
+                    // No space in the TCP window, retried by the next acknowledgement or mqttContinueStreams()
+                    if (!client.connected()) {
+                        stream->result = MqttBatchResult::failed;
+                    }
+                    break;
+                }
+                ++published;
+                notifySent(packetId);
+                if (stream->qos != 0 && registerPacket(packetId)) {
+                    stream->pendingPacket = packetId;
+                } else {
+                    nextChunk(*stream);
+                }
+            }
+
+            stream->busy = false;
+            if (stream->result != MqttBatchResult::acknowledged || stream->chunk == stream->chunkCount) {
+                notify(stream->callback, stream->result);
+                streams.erase(findStream(id));
+            }
+        }
+        return published;
+    }
+
+    std::vector<Batch>::iterator findBatch(uint32_t id)
+    {
+        return std::find_if(batches.begin(), batches.end(), [id](const Batch& batch) { return batch.id == id; });
+    }
+
+    void notify(const MqttBatchCallback& callback, MqttBatchResult result)
+    {
+        if (callback) {
+            notifications.push_back(std::bind(callback, result));
+        }
+    }
+
+    /// A message has been handed to the client
+    void notifySent(uint16_t packetId)
+    {
+        for (const auto& callback : sentCallbacks) {
+            notifications.push_back(std::bind(callback, packetId));
+        }
+    }
+
+    /// Keep a copy of a QoS 1/2 message until it has been acknowledged, so a disconnect does not lose it
+    void keep(uint16_t packetId, MqttOfflineQueue::Message message)
+    {
+        if (offlineQueue) {
+            inFlight.emplace_back(packetId, std::move(message));
+        }
+    }
+
+    /// The message is acknowledged or given up
+    void forget(uint16_t packetId)
+    {
+        auto kept = std::find_if(inFlight.begin(), inFlight.end(),
+            [packetId](const std::pair<uint16_t, MqttOfflineQueue::Message>& entry) { return entry.first == packetId; });
+        if (kept != inFlight.end()) {
+            inFlight.erase(kept);
+        }
+    }
+
+    /// Send the unacknowledged messages again after reconnecting, ahead of the offline queue.
+    /// They have been sent before anything still waiting in resend.
+    void resendInFlight()
+    {
+        for (auto kept = inFlight.rbegin(); kept != inFlight.rend(); ++kept) {
+            resend.push_front(std::move(kept->second));
+        }
+        inFlight.clear();
+    }
+
+    /// Nothing may overtake the messages waiting to be sent again
+    bool backlog() const
+    {
+        return offlineQueue && (!resend.empty() || !offlineQueue->empty());
+    }
+
+    /// An unresolved topic of MqttTopicRegistry is nullptr
+    static bool isValidTopic(const char* topic)
+    {
+        return topic != nullptr && topic[0] != '\0';
+    }
+
+    /// Queue the message if there is an offline queue and it cannot be sent right now
+    bool enqueue(const char* topic, uint8_t qos, bool retain, const char* payload, size_t length)
+    {
+        if (!offlineQueue) {
+            return false;
+        }
+        if (!offlineQueue->push(topic, qos, retain, payload, length)) {
+            DEBUG_PRINTLN("Offline queue full, message dropped");
+        }
+        return true;
+    }
+
+    /// Send queued messages as far as the replay rate allows. Unlocks while publishing.
+    size_t replay(std::unique_lock<std::mutex>& lock)
+    {
+        if (!offlineQueue || replaying || !client.connected()) {
+            return 0;
+        }
+        replaying = true;
+
+        const uint32_t now = millis();
+        replayCredit = std::min<uint64_t>(replayCredit + uint64_t(now - lastReplay) * replayRate,
+            uint64_t(replayRate) * replayCost);
+        lastReplay = now;
+
+        size_t sent = 0;
+        MqttOfflineQueue::Message message;
+        while (replayCredit >= replayCost && offlineQueue) {
+            // Taken out while publishing, a disconnect in between puts older messages in front of it
+            const bool resending = !resend.empty();
+            if (resending) {
+                message = std::move(resend.front());
+                resend.pop_front();
+            } else if (!offlineQueue->front(message)) {
+                break;
+            }
+            lock.unlock();
+            const uint16_t packetId = client.publish(message.topic.c_str(), message.qos, message.retain,
+                message.payload.empty() ? nullptr : message.payload.data(), message.payload.size());
+            lock.lock();
+            if (packetId == 0 || !offlineQueue) {
+                if (resending && offlineQueue) {
+                    resend.push_front(std::move(message));
+                }
+                break;
+            }
+            if (!resending) {
+                offlineQueue->pop();
+            }
+            notifySent(packetId);
+            if (message.qos != 0 && registerPacket(packetId)) {
+                keep(packetId, std::move(message));
+            }
+            replayCredit -= replayCost;
+            ++sent;
+        }
+
+        replaying = false;
+        return sent;
+    }
+
+    /// Release the lock, then call the collected callbacks, so they may publish again.
+    void flush(std::unique_lock<std::mutex>& lock)
+    {
+        std::vector<std::function<void()>> pending;
+        pending.swap(notifications);
+        lock.unlock();
+        for (const auto& notification : pending) {
+            notification();
+        }
+    }
+
+    AsyncMqttClient& client;
+    /// Guards everything below, acknowledgements arrive on the task of AsyncTCP.
+    /// Never held while calling into the client, which may wait for that task.
+    std::mutex mutex;
+    MqttGuard guard;
+    std::vector<Batch> batches;
+    uint32_t nextBatchId = 0;
+    std::vector<std::unique_ptr<Stream>> streams;
+    uint32_t nextStreamId = 0;
+    std::array<uint16_t, maxEarlyAcks> earlyAcks = {};
+    size_t nextEarlyAck = 0;
+    MqttGuard::TimeoutCallback timeoutCallback;
+    std::vector<MqttSentCallback> sentCallbacks;
+    /// Callbacks to be called once the lock has been released
+    std::vector<std::function<void()>> notifications;
+
+    std::unique_ptr<MqttOfflineQueue> offlineQueue;
+    /// QoS 1/2 messages sent while there is an offline queue, in the order sent, until acknowledged
+    std::vector<std::pair<uint16_t, MqttOfflineQueue::Message>> inFlight;
+    /// Messages which were in flight when the connection was lost, replayed before the offline queue
+    std::deque<MqttOfflineQueue::Message> resend;
+    /// Messages per second
+    uint16_t replayRate = 0;
+    uint64_t replayCredit = 0;
+    uint32_t lastReplay = 0;
+    /// Only one task replays at a time, the message being sent is still at the front of the queue
+    bool replaying = false;
+};
+
 MqttGuardInterface::MqttGuardInterface(AsyncMqttClient& mqttClient)
     : mqttClient_(mqttClient)
-    , mqttGuard_(std::make_shared<MqttGuard>())
+    , state_(std::make_shared<State>(mqttClient))
 {
-    // Default callbacks in case the user does not set one so internally everything is kept fine.
-    mqttOnDisconnect([](AsyncMqttClientDisconnectReason /*reason*/){});
-    mqttOnPublish([](uint16_t /*packetId*/) {});
+}
+
+void MqttGuardInterface::attach()
+{
+    if (attached_) {
+        return;
+    }
+    attached_ = true;
+
+    // Registered before any user callback, so those already see the updated state.
+    // The callbacks keep the state alive until they are gone.
+    auto state = state_;
+    mqttClient_.onConnect([state](bool /*sessionPresent*/) {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->replay(lock);
+        state->flush(lock);
+    });
+    mqttClient_.onPublish([state](uint16_t packetId) {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->acknowledge(packetId);
+        // Streams waiting for this acknowledgement send their next chunk
+        state->pumpStreams(lock);
+        state->flush(lock);
+    });
+    mqttClient_.onDisconnect([state](AsyncMqttClientDisconnectReason /*reason*/) {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        // Make sure that disconnet respects that there could be no more packets be sent.
+        state->guard.reset();
+        // Without an acknowledgement the broker may not have got them
+        state->resendInFlight();
+        state->earlyAcks.fill(0);
+        for (auto& batch : state->batches) {
+            // Open batches fail when they are closed
+            batch.pending.clear();
+            batch.result = MqttBatchResult::failed;
+            if (!batch.open) {
+                state->notify(batch.callback, MqttBatchResult::failed);
+            }
+        }
+        state->batches.erase(std::remove_if(state->batches.begin(), state->batches.end(),
+            [](const Batch& batch) { return !batch.open; }), state->batches.end());
+        for (size_t i = state->streams.size(); i > 0; --i) {
+            state->streams[i - 1]->pendingPacket = 0;
+            state->finishStream(state->streams.begin() + (i - 1), MqttBatchResult::failed);
+        }
+        state->flush(lock);
+    });
 }
 
 uint16_t MqttGuardInterface::mqttPublish(const char* topic, uint8_t qos, bool retain,
         const char* payload, size_t length, bool dup, uint16_t message_id)
 {
-    mqttGuard_->registerPacket(mqttClient_.publish(topic, qos, retain, payload, length, dup, message_id));
+    if (!State::isValidTopic(topic)) {
+        DEBUG_PRINTLN("Cannot publish without topic");
+        return 0;
+    }
+    attach();
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    // Queued messages go first
+    if (state_->offlineQueue && (!mqttClient_.connected() || state_->backlog())) {
+        state_->enqueue(topic, qos, retain, payload, length);
+        return 0;
+    }
+    lock.unlock();
+
+    const uint16_t packetId = mqttClient_.publish(topic, qos, retain, payload, length, dup, message_id);
+    lock.lock();
+    if (packetId == 0) {
+        state_->enqueue(topic, qos, retain, payload, length);
+    } else {
+        state_->notifySent(packetId);
+        // QoS 0 messages are never acknowledged
+        if (qos != 0 && state_->registerPacket(packetId) && state_->offlineQueue) {
+            // Like the client, a payload without length is null-terminated
+            const size_t size = (payload != nullptr && length == 0) ? strlen(payload) : length;
+            MqttOfflineQueue::Message message{topic, std::vector<char>(payload, payload + size), qos, retain};
+            state_->keep(packetId, std::move(message));
+        }
+    }
+    state_->flush(lock);
+    return packetId;
 }
 
-AsyncMqttClient& MqttGuardInterface::mqttOnPublish(AsyncMqttClientInternals::OnPublishUserCallback callback)
+uint16_t MqttGuardInterface::mqttPublishInteger(const char* topic, uint8_t qos, bool retain, long value)
 {
-    // Intercept the onPublish and make sure that mqttGuard is held alive until the callback is fired.
-    auto mqttGuard = mqttGuard_;
-    return mqttClient_.onPublish([mqttGuard, callback](uint16_t packetId){
-        mqttGuard->unregisterPacket(packetId);
-        if (callback) {
-            callback(packetId);
+    const char* payload = mqttPayload::integer(value);
+    return (payload == nullptr) ? 0 : mqttPublish(topic, qos, retain, payload);
+}
+
+uint16_t MqttGuardInterface::mqttPublishNumber(const char* topic, uint8_t qos, bool retain, double value, uint8_t decimals)
+{
+    const char* payload = mqttPayload::number(value, decimals);
+    return (payload == nullptr) ? 0 : mqttPublish(topic, qos, retain, payload);
+}
+
+uint16_t MqttGuardInterface::mqttPublishJson(const char* topic, uint8_t qos, bool retain,
+        std::initializer_list<mqttPayload::JsonField> fields)
+{
+    const char* payload = mqttPayload::json(fields);
+    if (payload == nullptr) {
+        DEBUG_PRINTLN("JSON payload too large");
+        return 0;
+    }
+    return mqttPublish(topic, qos, retain, payload);
+}
+
+bool MqttGuardInterface::mqttPublishBatch(const std::vector<MqttBatchEntry>& entries, MqttBatchCallback callback)
+{
+    attach();
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    // Nothing is sent if any topic is missing
+    for (const auto& entry : entries) {
+        if (!State::isValidTopic(entry.topic)) {
+            DEBUG_PRINTLN("Cannot publish batch without topic");
+            state_->notify(callback, MqttBatchResult::failed);
+            state_->flush(lock);
+            return false;
         }
-    });
+    }
+    // Known before the first message is out, so acknowledgements always find it
+    const uint32_t batchId = state_->nextBatchId++;
+    state_->batches.push_back(Batch{batchId, {}, std::move(callback), true, MqttBatchResult::acknowledged});
+    lock.unlock();
+
+    bool sent = true;
+    for (const auto& entry : entries) {
+        const uint16_t packetId = mqttClient_.publish(entry.topic, entry.qos, entry.retain, entry.payload);
+        if (packetId == 0) {
+            sent = false;
+            break;
+        }
+        lock.lock();
+        state_->notifySent(packetId);
+        if (entry.qos != 0 && state_->registerPacket(packetId)) {
+            state_->findBatch(batchId)->pending.push_back(packetId);
+        }
+        lock.unlock();
+    }
+
+    lock.lock();
+    auto batch = state_->findBatch(batchId);
+    batch->open = false;
+    if (!sent) {
+        // Messages already sent are still tracked on their own
+        state_->notify(batch->callback, MqttBatchResult::failed);
+        state_->batches.erase(batch);
+    } else if (batch->result != MqttBatchResult::acknowledged) {
+        // Timed out or disconnected while publishing
+        state_->notify(batch->callback, batch->result);
+        state_->batches.erase(batch);
+    } else if (batch->pending.empty()) {
+        state_->notify(batch->callback, MqttBatchResult::acknowledged);
+        state_->batches.erase(batch);
+    }
+    state_->flush(lock);
+    return sent;
 }
 
-AsyncMqttClient& MqttGuardInterface::mqttOnDisconnect(AsyncMqttClientInternals::OnDisconnectUserCallback callback)
+bool MqttGuardInterface::mqttPublishStream(const char* topic, uint8_t qos, size_t totalLength,
+        MqttChunkProducer producer, MqttBatchCallback callback, size_t chunkSize)
 {
-    // Intercept the onDisconnect and make sure that mqttGuard is held alive until the callback is fired.
-    auto mqttGuard = mqttGuard_;
-    return mqttClient_.onDisconnect([mqttGuard, callback]
-                            (AsyncMqttClientDisconnectReason reason){
-        // Make sure that disconnet respects that there could be no more packets be sent.
-        mqttGuard->reset();
+    attach();
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    if (!State::isValidTopic(topic) || !producer || chunkSize == 0 || !mqttClient_.connected()) {
+        state_->notify(callback, MqttBatchResult::failed);
+        state_->flush(lock);
+        return false;
+    }
+
+    std::unique_ptr<Stream> stream(new Stream());
+    stream->id = state_->nextStreamId++;
+    stream->topic = topic;
+    stream->qos = qos;
+    stream->total = totalLength;
+    stream->chunkSize = chunkSize;
+    // An empty payload is still sent as one chunk
+    stream->chunkCount = std::max<size_t>((totalLength + chunkSize - 1) / chunkSize, 1);
+    stream->producer = std::move(producer);
+    stream->callback = std::move(callback);
+    stream->buffer.resize(std::min(chunkSize, totalLength));
+    state_->streams.push_back(std::move(stream));
+    state_->pumpStreams(lock);
+    state_->flush(lock);
+    return true;
+}
+
+bool MqttGuardInterface::mqttPublishFile(const char* topic, uint8_t qos, fs::FS& fs, const char* path,
+        MqttBatchCallback callback, size_t chunkSize)
+{
+    // Shared with the producer, closed when the stream is gone
+    auto file = std::make_shared<File>(fs.open(path, "r"));
+    if (!*file || file->isDirectory()) {
+        DEBUG_PRINTLN("Could not open file to publish");
         if (callback) {
-            callback(reason);
+            callback(MqttBatchResult::failed);
         }
-    });
+        return false;
+    }
+
+    return mqttPublishStream(topic, qos, file->size(), [file](size_t offset, char* buffer, size_t length) -> size_t {
+        if (file->position() != offset && !file->seek(offset)) {
+            return 0;
+        }
+        return file->read(reinterpret_cast<uint8_t*>(buffer), length);
+    }, std::move(callback), chunkSize);
+}
+
+size_t MqttGuardInterface::mqttContinueStreams()
+{
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    const size_t published = state_->pumpStreams(lock);
+    state_->flush(lock);
+    return published;
+}
+
+AsyncMqttClient& MqttGuardInterface::mqttOnPublish(AsyncMqttClientInternals::OnPublishUserCallback callback)
+{
+    // The guard is updated by the callback registered in attach()
+    attach();
+    if (!callback) {
+        return mqttClient_;
+    }
+    return mqttClient_.onPublish(std::move(callback));
+}
+
+void MqttGuardInterface::mqttOnSent(MqttSentCallback callback)
+{
+    if (!callback) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->sentCallbacks.push_back(std::move(callback));
+}
+
+AsyncMqttClient& MqttGuardInterface::mqttOnDisconnect(AsyncMqttClientInternals::OnDisconnectUserCallback callback)
+{
+    // The guard is reset by the callback registered in attach()
+    attach();
+    if (!callback) {
+        return mqttClient_;
+    }
+    return mqttClient_.onDisconnect(std::move(callback));
 }
 
 bool MqttGuardInterface::mqttAllSent() const
 {
-    return mqttGuard_->allSent();
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->guard.checkTimeouts();
+    const bool allSent = state_->guard.allSent();
+    state_->flush(lock);
+    return allSent;
 }
 
 size_t MqttGuardInterface::mqttRemainingPackets() const
 {
-    return mqttGuard_->remainingPacketCount();
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->guard.remainingPacketCount();
+}
+
+void MqttGuardInterface::mqttSetAckDeadline(uint32_t deadline, MqttGuard::TimeoutCallback callback)
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->timeoutCallback = std::move(callback);
+    // The guard is part of the state, so it never outlives it
+    State* state = state_.get();
+    state_->guard.setDeadline(deadline, [state](MqttGuard::IdType packetId, uint32_t waited) {
+        if (state->timeoutCallback) {
+            state->notifications.push_back(std::bind(state->timeoutCallback, packetId, waited));
+        }
+        // Reported as lost, not sent again
+        state->forget(packetId);
+        state->finishBatchOf(packetId, false);
+        state->finishChunkOf(packetId, false);
+    });
+}
+
+size_t MqttGuardInterface::mqttCheckTimeouts()
+{
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    const size_t timeouts = state_->guard.checkTimeouts();
+    state_->flush(lock);
+    return timeouts;
+}
+
+LatencyHistogram MqttGuardInterface::mqttAckLatency() const
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->guard.getLatencyHistogram();
+}
+
+MqttGuard::Statistics MqttGuardInterface::mqttStatistics() const
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->guard.getStatistics();
+}
+
+bool MqttGuardInterface::mqttSetOfflineQueue(std::unique_ptr<MqttOfflineQueue> queue, uint16_t messagesPerSecond)
+{
+    // Nothing would ever be replayed
+    if (queue && messagesPerSecond == 0) {
+        DEBUG_PRINTLN("Offline queue needs a replay rate");
+        return false;
+    }
+    attach();
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->offlineQueue = std::move(queue);
+    if (!state_->offlineQueue) {
+        state_->inFlight.clear();
+        state_->resend.clear();
+    }
+    state_->replayRate = messagesPerSecond;
+    state_->replayCredit = uint64_t(messagesPerSecond) * replayCost;
+    state_->lastReplay = millis();
+    return true;
+}
+
+size_t MqttGuardInterface::mqttReplayOfflineQueue()
+{
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    const size_t sent = state_->replay(lock);
+    state_->flush(lock);
+    return sent;
+}
+
+size_t MqttGuardInterface::mqttQueuedMessages() const
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->offlineQueue ? state_->resend.size() + state_->offlineQueue->size() : 0;
+}
+
+bool MqttGuardInterface::mqttPersistOfflineQueue()
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->offlineQueue && state_->offlineQueue->persist();
 }
@@ -2,11 +2,34 @@
 #define BASECAMP_MQTT_GUARD_INTERFACE_HPP
 
 #include "mqttGuard.hpp"
+#include "MqttOfflineQueue.hpp"
+#include "mqttPayload.hpp"
 
 #include <memory>
+#include <vector>
 
 #include <AsyncMqttClient.h>
 
+/// A message of a batch, see MqttGuardInterface::mqttPublishBatch()
+struct MqttBatchEntry
+{
+    const char* topic;
+    /// Null-terminated
+    const char* payload;
+    uint8_t qos;
+    bool retain;
+};
+
+enum class MqttBatchResult
+{
+    /// Every QoS 1/2 message has been acknowledged (QoS 0 ones have been handed to TCP)
+    acknowledged,
+    /// A message has not been acknowledged within the deadline, see mqttSetAckDeadline()
+    timedOut,
+    /// A message could not be sent or the connection has been lost
+    failed,
+};
+
 /**
     Class to interface between AsyncMqttClient and MqttGuard.
     Intercepts outgoing messages and incoming publish acknowledgements to keep track of packets to be sent.
@@ -16,28 +39,132 @@
     Use mqttPublish instead of mqtt.publish()
 
     Use then mqttAllSent() to check if there are remaining packets to be sent.
+    Set a deadline with mqttSetAckDeadline() so a lost acknowledgement does not keep mqttAllSent() false forever.
+    Use mqttPublishBatch() to get a single callback for a group of messages instead.
+    Set an offline queue with mqttSetOfflineQueue() to keep messages published while disconnected.
 
+    The callbacks of the client are only registered by the first call of one of the functions above,
+    so the client does not have to be constructed yet when this class is.
     Its up to the owner of this class to keep mqttClient valid in the lifetime of an instance of this class.
  */
 class MqttGuardInterface
 {
 public:
+    using MqttBatchCallback = std::function<void(MqttBatchResult result)>;
+    /// Writes "length" bytes of the payload starting at "offset" into "buffer", returns the amount written
+    using MqttChunkProducer = std::function<size_t(size_t offset, char* buffer, size_t length)>;
+    /// Packet id as returned by AsyncMqttClient::publish()
+    using MqttSentCallback = std::function<void(uint16_t packetId)>;
+
     explicit MqttGuardInterface(AsyncMqttClient& mqttClient);
 
     AsyncMqttClient& mqttOnPublish(AsyncMqttClientInternals::OnPublishUserCallback callback);
     AsyncMqttClient& mqttOnDisconnect(AsyncMqttClientInternals::OnDisconnectUserCallback callback);    
 
+    /// Call "callback" for every message handed to the client by this interface, including batches,
+    /// replayed messages and chunks of streams. Called from the publishing task.
+    void mqttOnSent(MqttSentCallback callback);
+
+    /// Returns the packet id like AsyncMqttClient::publish(), 0 if the message could not be sent or has been queued.
+    /// A null or empty topic (e.g. unresolved in MqttTopicRegistry) is never sent or queued.
     uint16_t mqttPublish(const char* topic, uint8_t qos, bool retain, const char* payload = nullptr, size_t length = 0, bool dup = false, uint16_t message_id = 0);
 
-    /// Returns true if all mqtt-packets have been sent.
+    /// Publish "value" formatted without heap allocations, see mqttPayload::integer(). 0 if it could not be sent.
+    uint16_t mqttPublishInteger(const char* topic, uint8_t qos, bool retain, long value);
+
+    /// Publish "value" with "decimals" formatted without heap allocations, see mqttPayload::number().
+    uint16_t mqttPublishNumber(const char* topic, uint8_t qos, bool retain, double value, uint8_t decimals = 2);
+
+    /// Publish a flat JSON object formatted without heap allocations, see mqttPayload::json().
+    uint16_t mqttPublishJson(const char* topic, uint8_t qos, bool retain, std::initializer_list<mqttPayload::JsonField> fields);
+
+    /**
+        Publish "entries" back to back, so they share as few TCP segments as possible.
+        @param callback Called once, when the whole batch has been acknowledged, a message timed out or
+            the batch failed. Called from the task acknowledging the last message or from mqttCheckTimeouts(),
+            which Basecamp calls periodically from the dispatcher task of its EventBus. Without a deadline
+            (mqttSetAckDeadline()) a lost acknowledgement keeps the batch waiting until the next reset.
+        @return False if a message could not be sent or has no topic, callback has been called with
+            MqttBatchResult::failed then. Nothing is sent if a topic is null or empty.
+            Batches are never queued, see mqttSetOfflineQueue().
+     */
+    bool mqttPublishBatch(const std::vector<MqttBatchEntry>& entries, MqttBatchCallback callback);
+
+    /**
+        Publish "totalLength" bytes produced chunk by chunk, so the payload never has to be in RAM at once.
+        AsyncMqttClient only sends a message if it fits into the free TCP window as a whole and gives no access
+        to its connection, so the payload is sent as messages of up to chunkSize bytes to "<topic>/<chunk>/<count>"
+        (e.g. "log/0/3", "log/1/3", "log/2/3"). The next chunk is produced once the previous one has been
+        acknowledged (QoS 1/2) or handed to TCP (QoS 0). Each chunk is tracked like any other packet.
+        Chunks are never retained, the broker would keep every "<topic>/<chunk>/<count>" of every stream forever.
+        @param producer Called from the publishing task or the task of AsyncTCP, must return exactly "length".
+        @param callback Called once, when the last chunk has been acknowledged, a chunk timed out or the stream failed.
+        @return False if the stream could not be started (e.g. null or empty topic), callback has been called
+            with MqttBatchResult::failed then.
+     */
+    bool mqttPublishStream(const char* topic, uint8_t qos, size_t totalLength,
+        MqttChunkProducer producer, MqttBatchCallback callback, size_t chunkSize = 1024);
+
+    /// Publish the file at "path" as stream, see mqttPublishStream()
+    bool mqttPublishFile(const char* topic, uint8_t qos, fs::FS& fs, const char* path,
+        MqttBatchCallback callback, size_t chunkSize = 1024);
+
+    /// Retries chunks refused because the TCP window was full, returns the amount sent. Called by Basecamp::handle().
+    size_t mqttContinueStreams();
+
+    /// Returns true if all mqtt-packets have been sent. Drops packets past the deadline first.
     bool mqttAllSent() const;
 
     /// Returns the remaining to-be-transmitted packet count.
     size_t mqttRemainingPackets() const;
 
+    /**
+        Set how long a packet may wait for its acknowledgement.
+        @param deadline Time in ms, 0 waits forever.
+        @param callback Optional callback for each dropped packet.
+     */
+    void mqttSetAckDeadline(uint32_t deadline, MqttGuard::TimeoutCallback callback = {});
+
+    /// Drops packets past the deadline, returns their count. Called by mqttAllSent() as well.
+    size_t mqttCheckTimeouts();
+
+    /// Time from publishing to the acknowledgement (ms)
+    LatencyHistogram mqttAckLatency() const;
+
+    /// Counters of acknowledged, timed out and reset packets
+    MqttGuard::Statistics mqttStatistics() const;
+
+    /**
+        Keep messages which cannot be sent and replay them in order after reconnecting.
+        While the queue is not empty, mqttPublish() queues new messages as well to keep them in order.
+        @param queue Call its begin() first to recover messages spilled before a reset.
+        QoS 1/2 messages not acknowledged when the connection is lost are sent again before the queue, they
+        are kept in RAM only. Messages given up by mqttSetAckDeadline() are not.
+        @param queue Call its begin() first to recover messages spilled before a reset. Null removes the queue.
+        @param messagesPerSecond Replay rate. A second's worth is sent on connect, the rest by mqttReplayOfflineQueue().
+        @return false if the rate is 0, the previous queue is kept then.
+     */
+    bool mqttSetOfflineQueue(std::unique_ptr<MqttOfflineQueue> queue, uint16_t messagesPerSecond = 10);
+
+    /// Sends queued messages within the replay rate, returns their count. Called by Basecamp::handle().
+    size_t mqttReplayOfflineQueue();
+
+    /// Messages waiting in the offline queue or to be sent again
+    size_t mqttQueuedMessages() const;
+
+    /// Moves the queued messages from RAM to flash, call it before deep sleep.
+    bool mqttPersistOfflineQueue();
+
 private:
+    /// Guard and batches, shared with the callbacks of the client which may outlive this instance.
+    struct State;
+
+    /// Registers the internal callbacks with the client, once.
+    void attach();
+
     AsyncMqttClient& mqttClient_;
-    std::shared_ptr<MqttGuard> mqttGuard_;
+    std::shared_ptr<State> state_;
+    bool attached_ = false;
 };
 
 #endif // BASECAMP_MQTT_GUARD_INTERFACE_HPP
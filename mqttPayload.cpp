@@ -0,0 +1,260 @@
+#include "mqttPayload.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <pthread.h>
+
+namespace {
+    const constexpr uint64_t powersOfTen[mqttPayload::maxDecimals + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+    pthread_key_t bufferKey;
+    pthread_once_t bufferKeyOnce = PTHREAD_ONCE_INIT;
+
+    void createBufferKey()
+    {
+        // Called with the buffer when a task holding one is deleted
+        pthread_key_create(&bufferKey, [](void* buffer) { delete[] static_cast<char*>(buffer); });
+    }
+
+    /// Appends to the task buffer, remembers if anything did not fit
+    class Writer
+    {
+    public:
+        Writer()
+            : begin_(mqttPayload::taskBuffer())
+            , position_(begin_)
+            // Space for the NUL
+            , end_(begin_ + mqttPayload::bufferSize - 1)
+        {
+        }
+
+        void append(char character)
+        {
+            if (position_ == end_) {
+                overflow_ = true;
+                return;
+            }
+            *position_++ = character;
+        }
+
+        void append(const char* text)
+        {
+            while (*text != '\0') {
+                append(*text++);
+            }
+        }
+
+        void appendUnsigned(uint64_t value, size_t minDigits = 1)
+        {
+            char digits[20];
+            size_t count = 0;
+            while (value > 0 || count < minDigits) {
+                digits[count++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            }
+            while (count > 0) {
+                append(digits[--count]);
+            }
+        }
+
+        void appendInteger(long value)
+        {
+            if (value < 0) {
+                append('-');
+                // Negate as unsigned, -LONG_MIN does not fit into long
+                appendUnsigned(0 - static_cast<uint64_t>(value));
+                return;
+            }
+            appendUnsigned(static_cast<uint64_t>(value));
+        }
+
+        /// Fixed point with "decimals" digits, returns false for values which cannot be represented
+        bool appendReal(double value, uint8_t decimals)
+        {
+            if (decimals > mqttPayload::maxDecimals) {
+                decimals = mqttPayload::maxDecimals;
+            }
+            const double scaled = std::fabs(value) * powersOfTen[decimals] + 0.5;
+            // Also false for NaN
+            if (!(scaled < 1.8e19)) {
+                return false;
+            }
+
+            const uint64_t fixed = static_cast<uint64_t>(scaled);
+            if (value < 0 && fixed > 0) {
+                append('-');
+            }
+            appendUnsigned(fixed / powersOfTen[decimals]);
+            if (decimals > 0) {
+                append('.');
+                appendUnsigned(fixed % powersOfTen[decimals], decimals);
+            }
+            return true;
+        }
+
+        void appendJsonString(const char* text)
+        {
+            append('"');
+            for (; *text != '\0'; ++text) {
+                const char character = *text;
+                if (character == '"' || character == '\\') {
+                    append('\\');
+                    append(character);
+                } else if (static_cast<unsigned char>(character) < 0x20) {
+                    const char hex[] = "0123456789abcdef";
+                    append("\\u00");
+                    append(hex[(character >> 4) & 0x0f]);
+                    append(hex[character & 0x0f]);
+                } else {
+                    append(character);
+                }
+            }
+            append('"');
+        }
+
+        /// Terminates the payload, nullptr if anything did not fit
+        const char* finish()
+        {
+            *position_ = '\0';
+            return overflow_ ? nullptr : begin_;
+        }
+
+    private:
+        char* begin_;
+        char* position_;
+        char* end_;
+        bool overflow_ = false;
+    };
+}
+
+namespace mqttPayload
+{
+    JsonField::JsonField()
+        : JsonField("", 0L)
+    {
+    }
+
+    JsonField::JsonField(const char* key, int value)
+        : JsonField(key, static_cast<long>(value))
+    {
+    }
+
+    JsonField::JsonField(const char* key, unsigned value)
+        : JsonField(key, static_cast<unsigned long>(value))
+    {
+    }
+
+    JsonField::JsonField(const char* key, long value)
+        : key_(key)
+        , type_(Type::integer)
+        , integer_(value)
+    {
+    }
+
+    JsonField::JsonField(const char* key, unsigned long value)
+        : key_(key)
+        , type_(Type::unsignedInteger)
+        , unsignedInteger_(value)
+    {
+    }
+
+    JsonField::JsonField(const char* key, double value, uint8_t decimals)
+        : key_(key)
+        , type_(Type::real)
+        , real_(value)
+        , decimals_(decimals)
+    {
+    }
+
+    JsonField::JsonField(const char* key, bool value)
+        : key_(key)
+        , type_(Type::boolean)
+        , boolean_(value)
+    {
+    }
+
+    JsonField::JsonField(const char* key, const char* value)
+        : key_(key)
+        , type_(Type::string)
+        , string_(value)
+    {
+    }
+
+    char* taskBuffer()
+    {
+        pthread_once(&bufferKeyOnce, createBufferKey);
+        char* buffer = static_cast<char*>(pthread_getspecific(bufferKey));
+        if (buffer == nullptr) {
+            buffer = new char[bufferSize];
+            pthread_setspecific(bufferKey, buffer);
+        }
+        return buffer;
+    }
+
+    const char* integer(long value)
+    {
+        Writer writer;
+        writer.appendInteger(value);
+        return writer.finish();
+    }
+
+    const char* number(double value, uint8_t decimals)
+    {
+        Writer writer;
+        if (writer.appendReal(value, decimals)) {
+            return writer.finish();
+        }
+        // Too large for fixed point, only values which are not numbers are spelled out
+        if (std::isfinite(value)) {
+            return nullptr;
+        }
+        writer.append(std::isnan(value) ? "nan" : (value < 0 ? "-inf" : "inf"));
+        return writer.finish();
+    }
+
+    const char* json(std::initializer_list<JsonField> fields)
+    {
+        return json(fields.begin(), fields.size());
+    }
+
+    const char* json(const JsonField* fields, size_t count)
+    {
+        Writer writer;
+        writer.append('{');
+        for (size_t i = 0; i < count; ++i) {
+            const JsonField& field = fields[i];
+            if (i != 0) {
+                writer.append(',');
+            }
+            writer.appendJsonString(field.key_);
+            writer.append(':');
+
+            switch (field.type_) {
+            case JsonField::Type::integer:
+                writer.appendInteger(field.integer_);
+                break;
+            case JsonField::Type::unsignedInteger:
+                writer.appendUnsigned(field.unsignedInteger_);
+                break;
+            case JsonField::Type::real:
+                // JSON has no NaN or infinity
+                if (!writer.appendReal(field.real_, field.decimals_)) {
+                    writer.append("null");
+                }
+                break;
+            case JsonField::Type::boolean:
+                writer.append(field.boolean_ ? "true" : "false");
+                break;
+            case JsonField::Type::string:
+                if (field.string_ == nullptr) {
+                    writer.append("null");
+                } else {
+                    writer.appendJsonString(field.string_);
+                }
+                break;
+            }
+        }
+        writer.append('}');
+        return writer.finish();
+    }
+}
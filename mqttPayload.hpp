@@ -0,0 +1,81 @@
+#ifndef BASECAMP_MQTT_PAYLOAD_HPP
+#define BASECAMP_MQTT_PAYLOAD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+/**
+    Formatting of numeric and JSON payloads without heap allocations.
+
+    Payloads are written into a buffer owned by the calling task. It is allocated on the first use by a task,
+    released when the task is deleted and reused for every payload formatted by the same task, so a payload
+    is only valid until the task formats the next one. AsyncMqttClient::publish() copies the payload, so it
+    can be handed over directly.
+ */
+namespace mqttPayload
+{
+    /// Size of the buffer of each task, including the NUL
+    const constexpr size_t bufferSize = 256;
+    /// Most decimals printed for floating point values
+    const constexpr uint8_t maxDecimals = 6;
+
+    /// A member of a flat JSON object, see json()
+    class JsonField
+    {
+    public:
+        /// {"":0}, to be assigned later, e.g. in a std::array filled at runtime
+        JsonField();
+        JsonField(const char* key, int value);
+        JsonField(const char* key, unsigned value);
+        JsonField(const char* key, long value);
+        JsonField(const char* key, unsigned long value);
+        JsonField(const char* key, double value, uint8_t decimals = 2);
+        JsonField(const char* key, bool value);
+        /// Escaped as JSON string, nullptr gives null
+        JsonField(const char* key, const char* value);
+
+    private:
+        friend const char* json(const JsonField* fields, size_t count);
+
+        enum class Type
+        {
+            integer,
+            unsignedInteger,
+            real,
+            boolean,
+            string,
+        };
+
+        const char* key_;
+        Type type_;
+        union
+        {
+            long integer_;
+            unsigned long unsignedInteger_;
+            double real_;
+            bool boolean_;
+            const char* string_;
+        };
+        uint8_t decimals_ = 0;
+    };
+
+    /// Returns the buffer of the calling task (bufferSize bytes)
+    char* taskBuffer();
+
+    /// Formats "value", nullptr if it does not fit
+    const char* integer(long value);
+    /**
+        Formats "value" with "decimals" (at most maxDecimals) rounded decimals.
+        NaN and infinity give "nan", "inf" and "-inf".
+        @return nullptr if it does not fit or the fixed point value exceeds 64 bits (e.g. 1e20).
+     */
+    const char* number(double value, uint8_t decimals = 2);
+
+    /// Formats a flat JSON object like {"temperature":21.50,"door":"open"}, nullptr if it does not fit
+    const char* json(std::initializer_list<JsonField> fields);
+    /// Like json() above, for "count" fields built at runtime
+    const char* json(const JsonField* fields, size_t count);
+}
+
+#endif // BASECAMP_MQTT_PAYLOAD_HPP
@@ -0,0 +1,83 @@
+#include "mqttTopics.hpp"
+
+#include <cstring>
+
+namespace {
+    const constexpr char placeholder[] = "{hostname}";
+    const constexpr size_t placeholderLength = sizeof(placeholder) - 1;
+}
+
+MqttTopicRegistry::TopicId MqttTopicRegistry::add(const char* pattern)
+{
+    if (pattern == nullptr || count_ == maxTopics) {
+        return invalidTopic;
+    }
+
+    const TopicId id = static_cast<TopicId>(count_++);
+    patterns_[id] = pattern;
+    offsets_[id] = unresolved;
+    if (hostnameSet_) {
+        resolve(id);
+    }
+    return id;
+}
+
+void MqttTopicRegistry::setHostname(const char* hostname)
+{
+    const size_t length = std::strlen(hostname);
+    hostnameSet_ = (length < arenaSize);
+    if (!hostnameSet_) {
+        // Nothing expanded with the previous hostname stays valid
+        offsets_.fill(unresolved);
+        return;
+    }
+
+    std::memcpy(arena_.data(), hostname, length + 1);
+    hostnameLength_ = length;
+    used_ = length + 1;
+    for (size_t id = 0; id < count_; ++id) {
+        offsets_[id] = unresolved;
+        resolve(static_cast<TopicId>(id));
+    }
+}
+
+void MqttTopicRegistry::resolve(TopicId id)
+{
+    // Measure first, a topic is either expanded completely or not at all
+    size_t length = 0;
+    for (const char* rest = patterns_[id]; *rest != '\0';) {
+        if (std::strncmp(rest, placeholder, placeholderLength) == 0) {
+            length += hostnameLength_;
+            rest += placeholderLength;
+        } else {
+            ++length;
+            ++rest;
+        }
+    }
+    if (used_ + length + 1 > arenaSize) {
+        return;
+    }
+
+    char* topic = arena_.data() + used_;
+    for (const char* rest = patterns_[id]; *rest != '\0';) {
+        if (std::strncmp(rest, placeholder, placeholderLength) == 0) {
+            std::memcpy(topic, arena_.data(), hostnameLength_);
+            topic += hostnameLength_;
+            rest += placeholderLength;
+        } else {
+            *topic++ = *rest++;
+        }
+    }
+    *topic = '\0';
+
+    offsets_[id] = static_cast<uint16_t>(used_);
+    used_ += length + 1;
+}
+
+const char* MqttTopicRegistry::get(TopicId id) const
+{
+    if (id >= count_ || offsets_[id] == unresolved) {
+        return nullptr;
+    }
+    return arena_.data() + offsets_[id];
+}
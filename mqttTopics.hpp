@@ -0,0 +1,72 @@
+#ifndef BASECAMP_MQTT_TOPICS_HPP
+#define BASECAMP_MQTT_TOPICS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+    Registry of the topics of an application, resolved once into a fixed arena.
+
+    Topics are added as patterns like "stat/{hostname}/status". Once the hostname is known, every pattern
+    is expanded into the arena, so publishing only passes a pointer into it instead of concatenating Strings.
+    Add the topics before or after Basecamp::begin(), which sets the hostname.
+    Not thread-safe, add topics and set the hostname before publishing from other tasks.
+ */
+class MqttTopicRegistry
+{
+public:
+    using TopicId = uint8_t;
+
+    static const constexpr size_t maxTopics = 32;
+    /// Bytes for the hostname and all expanded topics, including their NULs
+    static const constexpr size_t arenaSize = 1024;
+    /// Returned by add() if there are too many topics
+    static const constexpr TopicId invalidTopic = UINT8_MAX;
+
+    /**
+        Add a topic.
+        @param pattern Has to stay valid (e.g. a literal), each "{hostname}" is replaced by the hostname.
+        @return Id of the topic or invalidTopic.
+     */
+    TopicId add(const char* pattern);
+
+    /// Expands all topics again with "hostname"
+    void setHostname(const char* hostname);
+
+    /**
+        Returns the expanded topic, nullptr if the id is unknown, the hostname is not set or the arena is full.
+        MqttGuardInterface and MqttDispatcher refuse to publish or subscribe to nullptr.
+     */
+    const char* get(TopicId id) const;
+
+    const char* operator[](TopicId id) const
+    {
+        return get(id);
+    }
+
+    /// Returns the amount of topics
+    size_t size() const
+    {
+        return count_;
+    }
+
+private:
+    /// Marks topics which are not expanded
+    static const constexpr uint16_t unresolved = UINT16_MAX;
+
+    /// Expands pattern id at the end of the arena
+    void resolve(TopicId id);
+
+    std::array<const char*, maxTopics> patterns_ = {};
+    /// Offsets of the expanded topics in the arena
+    std::array<uint16_t, maxTopics> offsets_ = {};
+    std::array<char, arenaSize> arena_ = {};
+    size_t count_ = 0;
+    size_t used_ = 0;
+    /// The hostname is kept at the start of the arena
+    bool hostnameSet_ = false;
+    size_t hostnameLength_ = 0;
+};
+
+#endif // BASECAMP_MQTT_TOPICS_HPP
@@ -0,0 +1,67 @@
+#include "reconnectPolicy.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+ReconnectPolicy::ReconnectPolicy()
+    : ReconnectPolicy(Settings{})
+{
+}
+
+ReconnectPolicy::ReconnectPolicy(Settings settings, RandomSource randomSource)
+    : settings_(settings)
+    , randomSource_(std::move(randomSource))
+{
+    resetBackoff();
+}
+
+void ReconnectPolicy::setSettings(const Settings& settings)
+{
+    settings_ = settings;
+    resetBackoff();
+}
+
+const ReconnectPolicy::Settings& ReconnectPolicy::getSettings() const
+{
+    return settings_;
+}
+
+uint32_t ReconnectPolicy::nextDelay(uint32_t now)
+{
+    // Only a connection that lasted long enough resets the backoff, flapping ones do not
+    if (connected_ && (now - connectedSince_) >= settings_.stablePeriod) {
+        resetBackoff();
+    }
+    connected_ = false;
+
+    const uint32_t ceiling = getCurrentCeiling();
+    attempts_++;
+    // Constant time per attempt, however long the connection has been down
+    ceiling_ = std::min(ceiling_ * std::max(settings_.multiplier, 1.0f), static_cast<double>(settings_.maxDelay));
+
+    const uint32_t random = randomSource_ ? randomSource_() : static_cast<uint32_t>(std::rand());
+    // Full jitter: anything between no delay and the ceiling
+    return (ceiling == UINT32_MAX) ? random : (random % (ceiling + 1));
+}
+
+void ReconnectPolicy::connected(uint32_t now)
+{
+    connected_ = true;
+    connectedSince_ = now;
+}
+
+unsigned ReconnectPolicy::getAttempts() const
+{
+    return attempts_;
+}
+
+uint32_t ReconnectPolicy::getCurrentCeiling() const
+{
+    return static_cast<uint32_t>(ceiling_);
+}
+
+void ReconnectPolicy::resetBackoff()
+{
+    attempts_ = 0;
+    ceiling_ = std::min(settings_.baseDelay, settings_.maxDelay);
+}
@@ -0,0 +1,77 @@
+#ifndef BASECAMP_RECONNECT_POLICY_HPP
+#define BASECAMP_RECONNECT_POLICY_HPP
+
+#include <cstdint>
+#include <functional>
+
+/**
+  Exponential backoff with full jitter for reconnect attempts.
+  Call nextDelay() whenever a connection has been lost or an attempt failed and wait the returned
+  time before the next attempt. Call connected() once connected. The backoff is reset as soon as
+  a connection has been stable for Settings::stablePeriod.
+
+  Time is passed in by the caller (milliseconds, e.g. millis()), so the policy can be driven by any clock.
+*/
+class ReconnectPolicy
+{
+public:
+    struct Settings
+    {
+        /// Upper bound of the first delay (ms)
+        uint32_t baseDelay = 1000;
+        /// Upper bound of any delay (ms)
+        uint32_t maxDelay = 60000;
+        /// Growth of the upper bound per failed attempt
+        float multiplier = 2.0f;
+        /// A connection lasting this long (ms) resets the backoff
+        uint32_t stablePeriod = 30000;
+    };
+
+    /// Source of uniformly distributed random numbers
+    using RandomSource = std::function<uint32_t()>;
+
+    /**
+        Construct a new policy.
+        @param settings Backoff settings.
+        @param randomSource Optional random source, std::rand() if not set.
+     */
+    ReconnectPolicy();
+    explicit ReconnectPolicy(Settings settings, RandomSource randomSource = {});
+    ~ReconnectPolicy() = default;
+
+    /// Replace the settings, this resets the backoff.
+    void setSettings(const Settings& settings);
+    const Settings& getSettings() const;
+
+    /**
+        Register a lost connection or failed attempt.
+        @param now Current time in ms.
+        @return Delay in ms before the next attempt, uniformly distributed in [0, current upper bound].
+     */
+    uint32_t nextDelay(uint32_t now);
+
+    /**
+        Register a successful connection.
+        @param now Current time in ms.
+     */
+    void connected(uint32_t now);
+
+    /// Number of attempts since the last reset.
+    unsigned getAttempts() const;
+
+    /// Upper bound of the next delay.
+    uint32_t getCurrentCeiling() const;
+
+private:
+    void resetBackoff();
+
+    Settings settings_;
+    RandomSource randomSource_;
+    unsigned attempts_ = 0;
+    /// Upper bound of the next delay, grown once per attempt until it reaches maxDelay
+    double ceiling_ = 0;
+    bool connected_ = false;
+    uint32_t connectedSince_ = 0;
+};
+
+#endif // BASECAMP_RECONNECT_POLICY_HPP
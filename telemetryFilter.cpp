@@ -0,0 +1,49 @@
+#include "telemetryFilter.hpp"
+
+#include <cstdlib>
+
+const constexpr uint32_t TelemetryFilter::maxSuppressed;
+const constexpr uint32_t TelemetryFilter::heapThreshold;
+const constexpr int32_t TelemetryFilter::rssiThreshold;
+
+namespace {
+    bool differs(uint32_t a, uint32_t b, uint32_t threshold)
+    {
+        return ((a > b) ? a - b : b - a) >= threshold;
+    }
+}
+
+bool TelemetryFilter::hasChanged(const TelemetryRecord& record, const TelemetryRecord& last)
+{
+    return differs(record.freeHeap, last.freeHeap, heapThreshold) ||
+        differs(record.minFreeHeap, last.minFreeHeap, heapThreshold) ||
+        differs(record.largestFreeBlock, last.largestFreeBlock, heapThreshold) ||
+        std::abs(record.rssi - last.rssi) >= rssiThreshold ||
+        record.resetReason != last.resetReason ||
+        record.wifiDisconnects != last.wifiDisconnects ||
+        record.mqttDisconnects != last.mqttDisconnects ||
+        record.minFreeStack != last.minFreeStack ||
+        record.mqtt.timeouts != last.mqtt.timeouts ||
+        record.mqtt.resets != last.mqtt.resets;
+}
+
+bool TelemetryFilter::shouldPublish(const TelemetryRecord& record, bool force)
+{
+    if (!force && published_ && suppressed_ < maxSuppressed && !hasChanged(record, last_)) {
+        suppressed_++;
+        return false;
+    }
+    return true;
+}
+
+void TelemetryFilter::published(const TelemetryRecord& record)
+{
+    last_ = record;
+    published_ = true;
+    suppressed_ = 0;
+}
+
+uint32_t TelemetryFilter::getSuppressed() const
+{
+    return suppressed_;
+}
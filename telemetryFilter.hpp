@@ -0,0 +1,69 @@
+#ifndef BASECAMP_TELEMETRY_FILTER_HPP
+#define BASECAMP_TELEMETRY_FILTER_HPP
+
+#include "mqttGuard.hpp"
+
+#include <cstdint>
+
+/// Health of the device at one point in time
+struct TelemetryRecord
+{
+    /// Seconds since reset
+    uint32_t uptime;
+    uint32_t freeHeap;
+    /// Lowest free heap since reset
+    uint32_t minFreeHeap;
+    uint32_t largestFreeBlock;
+    /// dBm, 0 if not connected
+    int32_t rssi;
+    /// rtc_get_reset_reason()
+    uint32_t resetReason;
+    /// Connections lost since the telemetry has been started
+    uint32_t wifiDisconnects;
+    uint32_t mqttDisconnects;
+    /// Smallest stack high-water mark of all running tasks of Basecamp, in bytes
+    uint32_t minFreeStack;
+    MqttGuard::Statistics mqtt;
+    /// Packets waiting for their acknowledgement
+    uint32_t pendingPackets;
+};
+
+/**
+  Decides which telemetry records are published.
+  A record which differs only slightly from the last published one is suppressed, but at most
+  maxSuppressed times in a row, so a quiet device still sends a heartbeat. Uptime and acknowledged
+  packets change all the time and are not compared. Not thread safe.
+*/
+class TelemetryFilter
+{
+public:
+    /// Records suppressed in a row before one is published anyway
+    static const constexpr uint32_t maxSuppressed = 9;
+    /// Smaller changes of the heap values (bytes) do not count
+    static const constexpr uint32_t heapThreshold = 1024;
+    /// Smaller changes of the RSSI (dB) do not count
+    static const constexpr int32_t rssiThreshold = 5;
+
+    /// True if "record" is worth publishing after "last"
+    static bool hasChanged(const TelemetryRecord& record, const TelemetryRecord& last);
+
+    /**
+        Decide about "record", counting it as suppressed if it is not worth publishing.
+        @param force Publish it in any case.
+        @return True if it should be published, call published() once it has been.
+     */
+    bool shouldPublish(const TelemetryRecord& record, bool force);
+
+    /// Compare the next records against "record" and restart the count of suppressed ones
+    void published(const TelemetryRecord& record);
+
+    /// Records suppressed since the last published one
+    uint32_t getSuppressed() const;
+
+private:
+    TelemetryRecord last_ = {};
+    bool published_ = false;
+    uint32_t suppressed_ = 0;
+};
+
+#endif // BASECAMP_TELEMETRY_FILTER_HPP
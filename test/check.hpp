@@ -0,0 +1,43 @@
+// Tiny assertion helpers for the host tests, each test is a program of its own run by CTest
+
+#ifndef HOST_CHECK_HPP
+#define HOST_CHECK_HPP
+
+#include <cstdio>
+#include <cstring>
+
+namespace check {
+    inline int& failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail(const char *file, int line, const char *expression)
+    {
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        failures()++;
+    }
+
+    // Exit code of main()
+    inline int result()
+    {
+        if (failures() != 0) {
+            fprintf(stderr, "%d checks failed\n", failures());
+            return 1;
+        }
+        return 0;
+    }
+}
+
+#define CHECK(expression) \
+    do { \
+        if (!(expression)) { \
+            check::fail(__FILE__, __LINE__, #expression); \
+        } \
+    } while (0)
+
+#define CHECK_EQUAL(actual, expected) CHECK((actual) == (expected))
+#define CHECK_STRING(actual, expected) CHECK((actual) != nullptr && strcmp((actual), (expected)) == 0)
+
+#endif
@@ -0,0 +1,396 @@
+// FirmwareUpload and GzipFirmwareWriter against a FileFirmwareWriter on an in-memory file system
+
+#include "FirmwareUpdate.hpp"
+#include "check.hpp"
+
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+namespace {
+    const char *imagePath = "/firmware.bin";
+
+    std::vector<uint8_t> makeImage(size_t size)
+    {
+        // Compressible, but not trivially
+        std::vector<uint8_t> image(size);
+        uint32_t value = 1;
+        for (size_t i = 0; i < size; i++) {
+            value = value * 1103515245 + 12345;
+            image[i] = static_cast<uint8_t>((i % 7 == 0) ? (value >> 16) : (i / 64));
+        }
+        return image;
+    }
+
+    String md5Of(const std::vector<uint8_t> &data)
+    {
+        MD5Builder md5;
+        md5.begin();
+        for (size_t offset = 0; offset < data.size(); offset += 1000) {
+            md5.add(const_cast<uint8_t *>(data.data() + offset), static_cast<uint16_t>(std::min<size_t>(1000, data.size() - offset)));
+        }
+        md5.calculate();
+        return md5.toString();
+    }
+
+    std::vector<uint8_t> gzip(const std::vector<uint8_t> &data, const char *name = nullptr)
+    {
+        z_stream stream = {};
+        deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        gz_header header = {};
+        header.name = reinterpret_cast<Bytef *>(const_cast<char *>(name));
+        header.hcrc = (name != nullptr);
+        deflateSetHeader(&stream, &header);
+
+        std::vector<uint8_t> compressed(deflateBound(&stream, data.size()) + 64);
+        stream.next_in = const_cast<Bytef *>(data.data());
+        stream.avail_in = static_cast<uInt>(data.size());
+        stream.next_out = compressed.data();
+        stream.avail_out = static_cast<uInt>(compressed.size());
+        deflate(&stream, Z_FINISH);
+        compressed.resize(stream.total_out);
+        deflateEnd(&stream);
+        return compressed;
+    }
+
+    std::string fileContent(fs::FS &fs)
+    {
+        return fs.host.files[imagePath];
+    }
+
+    std::string asString(const std::vector<uint8_t> &data)
+    {
+        return std::string(data.begin(), data.end());
+    }
+
+    // Writes "data" in chunks of "chunkSize" bytes
+    bool writeChunked(FirmwareWriter &writer, const std::vector<uint8_t> &data, size_t chunkSize)
+    {
+        for (size_t offset = 0; offset < data.size(); offset += chunkSize) {
+            const size_t length = std::min(chunkSize, data.size() - offset);
+            if (writer.write(data.data() + offset, length) != length) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void testMd5Builder()
+    {
+        std::vector<uint8_t> abc = {'a', 'b', 'c'};
+        CHECK(md5Of(abc) == "900150983cd24fb0d6963f7d28e17f72");
+        CHECK(md5Of({}) == "d41d8cd98f00b204e9800998ecf8427e");
+    }
+
+    void testFileWriter()
+    {
+        fs::FS fs;
+        FileFirmwareWriter writer(fs, imagePath);
+        const auto image = makeImage(5000);
+
+        CHECK(writer.begin(image.size()));
+        CHECK(writeChunked(writer, image, 333));
+        CHECK(writer.end(md5Of(image)));
+        CHECK(fileContent(fs) == asString(image));
+
+        // Upper case MD5 is accepted as well
+        String upper = md5Of(image);
+        std::string text = upper.c_str();
+        for (auto &c : text) {
+            c = static_cast<char>(toupper(c));
+        }
+        CHECK(writer.begin(0));
+        CHECK(writeChunked(writer, image, 5000));
+        CHECK(writer.end(String(text)));
+
+        CHECK(writer.begin(0));
+        CHECK(writeChunked(writer, image, 5000));
+        CHECK(!writer.end("00000000000000000000000000000000"));
+        CHECK(writer.getError().startsWith("MD5 check failed"));
+        CHECK(!fs.exists(imagePath));
+
+        CHECK(writer.begin(0));
+        CHECK(writeChunked(writer, image, 100));
+        writer.abort();
+        CHECK(!fs.exists(imagePath));
+
+        // Nothing to write to
+        CHECK_EQUAL(writer.write(image.data(), 10), 0u);
+        CHECK(!writer.end(""));
+
+        fs.host.space = 1000;
+        CHECK(writer.begin(0));
+        CHECK_EQUAL(writer.write(image.data(), 1500), 1000u);
+        CHECK(writer.getError().startsWith("Could not write"));
+    }
+
+    void testUploadInOrder()
+    {
+        fs::FS fs;
+        FileFirmwareWriter writer(fs, imagePath);
+        std::vector<FirmwareUpdateProgress> progress;
+        FirmwareUpload upload(writer, [&progress](const FirmwareUpdateProgress &current) {
+            progress.push_back(current);
+        });
+        const auto image = makeImage(4096);
+
+        hostMillis = 1000;
+        CHECK(upload.begin(image.size(), md5Of(image)));
+        CHECK(upload.isActive());
+        for (size_t offset = 0; offset < image.size(); offset += 1024) {
+            hostMillis += 100;
+            CHECK(upload.write(offset, image.data() + offset, 1024));
+        }
+        CHECK(upload.end());
+        CHECK(!upload.isActive());
+        CHECK(upload.getError() == "");
+        CHECK(fileContent(fs) == asString(image));
+
+        CHECK_EQUAL(progress.size(), 4u);
+        CHECK_EQUAL(progress.back().written, image.size());
+        CHECK_EQUAL(progress.back().total, image.size());
+        CHECK_EQUAL(progress.back().elapsedMs, 400u);
+        CHECK_EQUAL(progress.back().bytesPerSecond, 10240u);
+    }
+
+    void testUploadOverlap()
+    {
+        fs::FS fs;
+        FileFirmwareWriter writer(fs, imagePath);
+        FirmwareUpload upload(writer);
+        const auto image = makeImage(3000);
+
+        CHECK(upload.begin(image.size(), md5Of(image)));
+        CHECK(upload.write(0, image.data(), 1000));
+        // Retransmission of the whole first chunk is skipped
+        CHECK(upload.write(0, image.data(), 1000));
+        // A chunk partly covering written data only continues the image
+        CHECK(upload.write(500, image.data() + 500, 1500));
+        CHECK_EQUAL(upload.getProgress().written, 2000u);
+        // Retransmission of a part in the middle
+        CHECK(upload.write(1200, image.data() + 1200, 300));
+        CHECK(upload.write(1999, image.data() + 1999, 1001));
+        CHECK(upload.end());
+        CHECK(fileContent(fs) == asString(image));
+    }
+
+    void testUploadGap()
+    {
+        fs::FS fs;
+        FileFirmwareWriter writer(fs, imagePath);
+        FirmwareUpload upload(writer);
+        const auto image = makeImage(3000);
+
+        CHECK(upload.begin(image.size()));
+        CHECK(upload.write(0, image.data(), 1000));
+        CHECK(!upload.write(1001, image.data() + 1001, 1000));
+        CHECK(!upload.isActive());
+        CHECK(upload.getError() == "Missing data in upload");
+        // The writer has been aborted
+        CHECK(!fs.exists(imagePath));
+        // Everything after a failure is rejected
+        CHECK(!upload.write(1000, image.data() + 1000, 1000));
+        CHECK(!upload.end());
+
+        // A new upload starts from scratch
+        CHECK(upload.begin(image.size()));
+        CHECK(upload.write(0, image.data(), image.size()));
+        CHECK(upload.end());
+        CHECK(fileContent(fs) == asString(image));
+    }
+
+    void testUploadFailures()
+    {
+        fs::FS fs;
+        FileFirmwareWriter writer(fs, imagePath);
+        FirmwareUpload upload(writer);
+        const auto image = makeImage(3000);
+
+        CHECK(upload.begin(0));
+        CHECK(!upload.end());
+        CHECK(upload.getError() == "Empty firmware image");
+
+        CHECK(upload.begin(image.size(), md5Of(makeImage(10))));
+        CHECK(upload.write(0, image.data(), image.size()));
+        CHECK(!upload.end());
+        CHECK(upload.getError().startsWith("Verifying firmware failed: MD5 check failed"));
+        CHECK(!fs.exists(imagePath));
+
+        fs.host.space = 2000;
+        CHECK(upload.begin(image.size()));
+        CHECK(upload.write(0, image.data(), 1000));
+        CHECK(!upload.write(1000, image.data() + 1000, 2000));
+        CHECK(upload.getError().startsWith("Writing firmware failed: Could not write"));
+        CHECK(!upload.isActive());
+        fs.host.space = SIZE_MAX;
+
+        // A new upload supersedes a running one
+        CHECK(upload.begin(image.size()));
+        CHECK(upload.write(0, image.data(), 1000));
+        CHECK(upload.begin(image.size()));
+        CHECK(upload.isActive());
+        CHECK_EQUAL(upload.getProgress().written, 0u);
+        CHECK(upload.write(0, image.data(), image.size()));
+        CHECK(upload.end());
+        CHECK(fileContent(fs) == asString(image));
+    }
+
+    void testGzip()
+    {
+        const auto image = makeImage(100000);
+        const auto compressed = gzip(image);
+        CHECK(compressed.size() < image.size());
+
+        // Chunk sizes splitting the header, the trailer and single bytes
+        for (size_t chunkSize : {1u, 3u, 7u, 10u, 1024u, 65536u, 200000u}) {
+            fs::FS fs;
+            FileFirmwareWriter file(fs, imagePath);
+            GzipFirmwareWriter writer(file);
+            CHECK(writer.begin(compressed.size()));
+            CHECK(writeChunked(writer, compressed, chunkSize));
+            CHECK(writer.isCompressed());
+            CHECK(writer.end(md5Of(image)));
+            CHECK(fileContent(fs) == asString(image));
+        }
+
+        // Optional header fields are skipped
+        {
+            const auto named = gzip(image, "firmware.bin");
+            fs::FS fs;
+            FileFirmwareWriter file(fs, imagePath);
+            GzipFirmwareWriter writer(file);
+            CHECK(writer.begin(0));
+            CHECK(writeChunked(writer, named, 5));
+            CHECK(writer.end(md5Of(image)));
+            CHECK(fileContent(fs) == asString(image));
+        }
+    }
+
+    void testGzipPassThrough()
+    {
+        for (size_t size : {1u, 2u, 5000u}) {
+            const auto image = makeImage(size);
+            fs::FS fs;
+            FileFirmwareWriter file(fs, imagePath);
+            GzipFirmwareWriter writer(file);
+            CHECK(writer.begin(size));
+            CHECK(writeChunked(writer, image, 1));
+            CHECK(!writer.isCompressed());
+            CHECK(writer.end(md5Of(image)));
+            CHECK(fileContent(fs) == asString(image));
+        }
+    }
+
+    void testGzipCorrupt()
+    {
+        const auto image = makeImage(20000);
+
+        // Broken deflate stream
+        {
+            auto compressed = gzip(image);
+            for (size_t i = 20; i < 40; i++) {
+                compressed[i] = 0xff;
+            }
+            fs::FS fs;
+            FileFirmwareWriter file(fs, imagePath);
+            GzipFirmwareWriter writer(file);
+            CHECK(writer.begin(0));
+            CHECK(!writeChunked(writer, compressed, 512));
+            CHECK(writer.getError() == "Compressed firmware image is corrupt");
+            CHECK(!writer.end(""));
+            CHECK(!fs.exists(imagePath));
+        }
+
+        // Truncated
+        {
+            auto compressed = gzip(image);
+            compressed.resize(compressed.size() - 4);
+            fs::FS fs;
+            FileFirmwareWriter file(fs, imagePath);
+            GzipFirmwareWriter writer(file);
+            CHECK(writer.begin(0));
+            CHECK(writeChunked(writer, compressed, 512));
+            CHECK(!writer.end(""));
+            CHECK(writer.getError() == "Compressed firmware image is incomplete");
+            CHECK(!fs.exists(imagePath));
+        }
+
+        // Wrong size in the trailer
+        {
+            auto compressed = gzip(image);
+            compressed[compressed.size() - 4] ^= 1;
+            fs::FS fs;
+            FileFirmwareWriter file(fs, imagePath);
+            GzipFirmwareWriter writer(file);
+            CHECK(writer.begin(0));
+            CHECK(writeChunked(writer, compressed, 512));
+            CHECK(writer.getError() == "Size of the inflated firmware image does not match");
+            CHECK(!writer.end(""));
+        }
+
+        // Wrong CRC in the trailer, caught without an MD5
+        {
+            auto compressed = gzip(image);
+            compressed[compressed.size() - 8] ^= 1;
+            fs::FS fs;
+            FileFirmwareWriter file(fs, imagePath);
+            GzipFirmwareWriter writer(file);
+            CHECK(writer.begin(0));
+            CHECK(writeChunked(writer, compressed, 512));
+            CHECK(writer.getError() == "CRC of the inflated firmware image does not match");
+            CHECK(!writer.end(""));
+            CHECK(!fs.exists(imagePath));
+        }
+
+        // Data after the end of the image
+        {
+            auto compressed = gzip(image);
+            compressed.push_back(0);
+            fs::FS fs;
+            FileFirmwareWriter file(fs, imagePath);
+            GzipFirmwareWriter writer(file);
+            CHECK(writer.begin(0));
+            CHECK(!writeChunked(writer, compressed, 512));
+            CHECK(writer.getError() == "Unexpected data after compressed image");
+        }
+    }
+
+    void testGzipUpload()
+    {
+        const auto image = makeImage(50000);
+        const auto compressed = gzip(image);
+        fs::FS fs;
+        FileFirmwareWriter file(fs, imagePath);
+        GzipFirmwareWriter writer(file);
+        FirmwareUpload upload(writer);
+
+        // The MD5 is the one of the inflated image, offsets are the ones of the upload
+        CHECK(upload.begin(compressed.size(), md5Of(image)));
+        size_t offset = 0;
+        while (offset < compressed.size()) {
+            const size_t length = std::min<size_t>(1460, compressed.size() - offset);
+            CHECK(upload.write(offset, compressed.data() + offset, length));
+            // Every chunk is sent twice
+            CHECK(upload.write(offset, compressed.data() + offset, length));
+            offset += length;
+        }
+        CHECK_EQUAL(upload.getProgress().written, compressed.size());
+        CHECK(upload.end());
+        CHECK(fileContent(fs) == asString(image));
+    }
+}
+
+int main()
+{
+    testMd5Builder();
+    testFileWriter();
+    testUploadInOrder();
+    testUploadOverlap();
+    testUploadGap();
+    testUploadFailures();
+    testGzip();
+    testGzipPassThrough();
+    testGzipCorrupt();
+    testGzipUpload();
+    return check::result();
+}
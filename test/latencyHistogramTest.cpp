@@ -0,0 +1,135 @@
+// LatencyHistogram against the exact values kept in a sorted vector
+
+#include "latencyHistogram.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+    // Exact percentile with the same rank definition as LatencyHistogram
+    uint32_t exactPercentile(std::vector<uint32_t> values, float percentile)
+    {
+        std::sort(values.begin(), values.end());
+        const uint32_t rank = std::max<uint32_t>(1, static_cast<uint32_t>(values.size() * static_cast<double>(percentile) / 100.0 + 0.5));
+        return values[rank - 1];
+    }
+
+    void testEmpty()
+    {
+        LatencyHistogram histogram;
+        CHECK_EQUAL(histogram.count(), 0u);
+        CHECK_EQUAL(histogram.min(), 0u);
+        CHECK_EQUAL(histogram.max(), 0u);
+        CHECK_EQUAL(histogram.mean(), 0u);
+        CHECK_EQUAL(histogram.percentile(50), 0u);
+    }
+
+    void testSmallValuesExact()
+    {
+        LatencyHistogram histogram;
+        for (uint32_t value = 0; value < 16; value++) {
+            histogram.record(value);
+        }
+        CHECK_EQUAL(histogram.count(), 16u);
+        CHECK_EQUAL(histogram.min(), 0u);
+        CHECK_EQUAL(histogram.max(), 15u);
+        CHECK_EQUAL(histogram.mean(), 7u);
+        CHECK_EQUAL(histogram.percentile(0), 0u);
+        CHECK_EQUAL(histogram.percentile(50), 7u);
+        CHECK_EQUAL(histogram.percentile(100), 15u);
+        // Out of range percentiles are clamped
+        CHECK_EQUAL(histogram.percentile(-5), 0u);
+        CHECK_EQUAL(histogram.percentile(250), 15u);
+    }
+
+    // Every value is reported with at most 12.5% error, never above the maximum
+    void testRelativeError()
+    {
+        std::mt19937 random(5);
+        for (int distribution = 0; distribution < 3; distribution++) {
+            LatencyHistogram histogram;
+            std::vector<uint32_t> values;
+            for (int i = 0; i < 20000; i++) {
+                uint32_t value = 0;
+                switch (distribution) {
+                    case 0:
+                        value = random() % 1000;
+                        break;
+                    case 1:
+                        // Long tail, like ack latencies
+                        value = static_cast<uint32_t>(20 * std::exp(std::uniform_real_distribution<double>(0, 8)(random)));
+                        break;
+                    default:
+                        value = static_cast<uint32_t>(random());
+                        break;
+                }
+                values.push_back(value);
+                histogram.record(value);
+            }
+
+            CHECK_EQUAL(histogram.count(), values.size());
+            CHECK_EQUAL(histogram.min(), *std::min_element(values.begin(), values.end()));
+            CHECK_EQUAL(histogram.max(), *std::max_element(values.begin(), values.end()));
+            uint64_t sum = 0;
+            for (const auto value : values) {
+                sum += value;
+            }
+            CHECK_EQUAL(histogram.mean(), static_cast<uint32_t>(sum / values.size()));
+
+            for (float percentile : {0.0f, 1.0f, 25.0f, 50.0f, 90.0f, 99.0f, 99.9f, 100.0f}) {
+                const uint32_t exact = exactPercentile(values, percentile);
+                const uint32_t reported = histogram.percentile(percentile);
+                CHECK(reported >= exact);
+                CHECK(reported - exact <= exact / 8);
+                CHECK(reported <= histogram.max());
+            }
+        }
+    }
+
+    // Bucket boundaries up to the largest value
+    void testBoundaries()
+    {
+        for (unsigned bit = 4; bit < 32; bit++) {
+            const uint32_t power = 1u << bit;
+            for (uint32_t value : {power - 1, power, power + 1, power + (power >> 3) - 1, power + (power >> 3)}) {
+                LatencyHistogram histogram;
+                histogram.record(value);
+                histogram.record(UINT32_MAX);
+                const uint32_t reported = histogram.percentile(50);
+                CHECK(reported >= value);
+                CHECK(reported - value <= value / 8);
+            }
+        }
+
+        LatencyHistogram histogram;
+        histogram.record(UINT32_MAX);
+        CHECK_EQUAL(histogram.percentile(100), UINT32_MAX);
+        CHECK_EQUAL(histogram.mean(), UINT32_MAX);
+    }
+
+    void testReset()
+    {
+        LatencyHistogram histogram;
+        histogram.record(100);
+        histogram.record(5);
+        histogram.reset();
+        CHECK_EQUAL(histogram.count(), 0u);
+        CHECK_EQUAL(histogram.percentile(100), 0u);
+        histogram.record(7);
+        CHECK_EQUAL(histogram.min(), 7u);
+        CHECK_EQUAL(histogram.max(), 7u);
+    }
+}
+
+int main()
+{
+    testEmpty();
+    testSmallValuesExact();
+    testRelativeError();
+    testBoundaries();
+    testReset();
+    return check::result();
+}
@@ -0,0 +1,130 @@
+// Dispatch throughput of the MqttDispatcher trie against a linear scan over all filters.
+// Run with a number of rounds, e.g. "mqttDispatcherBenchmark 100", CTest only runs a few to keep it building.
+
+#include "mqttDispatcher.hpp"
+#include "topicMatcher.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // Like "home/room3/sensor17/temperature"
+    const constexpr size_t levelCount = 4;
+    const constexpr unsigned valuesPerLevel = 24;
+    const constexpr size_t topicsPerRound = 200;
+
+    std::string level(size_t depth, unsigned value)
+    {
+        return "l" + std::to_string(depth) + "v" + std::to_string(value);
+    }
+
+    // Filters of 1 to 4 levels, about every fifth level "+" and every tenth filter ending in "#"
+    std::vector<std::string> makeFilters(size_t count, std::mt19937& random)
+    {
+        std::vector<std::string> filters;
+        for (size_t i = 0; i < count; i++) {
+            const size_t depth = 1 + random() % levelCount;
+            std::string filter;
+            for (size_t j = 0; j < depth; j++) {
+                filter += (j == 0) ? "" : "/";
+                if (j == depth - 1 && depth > 1 && random() % 10 == 0) {
+                    filter += "#";
+                } else {
+                    filter += (random() % 5 == 0) ? "+" : level(j, random() % valuesPerLevel);
+                }
+            }
+            filters.push_back(filter);
+        }
+        return filters;
+    }
+
+    std::vector<std::string> makeTopics(std::mt19937& random)
+    {
+        std::vector<std::string> topics;
+        for (size_t i = 0; i < topicsPerRound; i++) {
+            const size_t depth = 1 + random() % levelCount;
+            std::string topic;
+            for (size_t j = 0; j < depth; j++) {
+                topic += ((j == 0) ? "" : "/") + level(j, random() % valuesPerLevel);
+            }
+            topics.push_back(topic);
+        }
+        return topics;
+    }
+
+    struct Result {
+        double nanosecondsPerMessage;
+        uint64_t calls;
+    };
+
+    // Every filter checked against the split topic, the obvious implementation without a trie
+    Result linearScan(const std::vector<std::string>& filters, const std::vector<std::string>& topics, unsigned rounds)
+    {
+        std::vector<std::vector<std::string>> filterLevels;
+        for (const auto& filter : filters) {
+            filterLevels.push_back(topicMatcher::split(filter));
+        }
+
+        uint64_t calls = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned round = 0; round < rounds; round++) {
+            for (const auto& topic : topics) {
+                const auto topicLevels = topicMatcher::split(topic);
+                for (const auto& levels : filterLevels) {
+                    calls += topicMatcher::matches(levels, topicLevels) ? 1 : 0;
+                }
+            }
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return Result{static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+            (static_cast<double>(rounds) * topics.size()), calls};
+    }
+
+    Result trie(const std::vector<std::string>& filters, const std::vector<std::string>& topics, unsigned rounds)
+    {
+        AsyncMqttClient client;
+        MqttDispatcher dispatcher(client);
+        uint64_t calls = 0;
+        for (const auto& filter : filters) {
+            dispatcher.subscribe(filter.c_str(), 0, [&calls](const char*, const char*, size_t) { calls++; });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned round = 0; round < rounds; round++) {
+            for (const auto& topic : topics) {
+                client.deliver(topic.c_str(), "");
+            }
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return Result{static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+            (static_cast<double>(rounds) * topics.size()), calls};
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const unsigned rounds = (argc > 1) ? static_cast<unsigned>(atoi(argv[1])) : 100;
+
+    printf("%8s %14s %18s %16s\n", "filters", "matches/msg", "linear (ns/msg)", "trie (ns/msg)");
+    for (size_t count : {16u, 256u, 1024u, 4096u}) {
+        std::mt19937 random(count);
+        const auto filters = makeFilters(count, random);
+        const auto topics = makeTopics(random);
+
+        const Result linear = linearScan(filters, topics, rounds);
+        const Result matched = trie(filters, topics, rounds);
+        // Both have to call the same handlers, or the numbers mean nothing
+        if (linear.calls != matched.calls) {
+            fprintf(stderr, "%zu filters: linear scan matched %llu times, the trie %llu times\n", count,
+                static_cast<unsigned long long>(linear.calls), static_cast<unsigned long long>(matched.calls));
+            return 1;
+        }
+        printf("%8zu %14.1f %18.1f %16.1f\n", count, static_cast<double>(linear.calls) / (rounds * topics.size()),
+            linear.nanosecondsPerMessage, matched.nanosecondsPerMessage);
+    }
+    return 0;
+}
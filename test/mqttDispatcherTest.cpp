@@ -0,0 +1,266 @@
+// MqttDispatcher driven through the stand-in client, the trie cross-checked against a plain matcher
+
+#include "mqttDispatcher.hpp"
+#include "check.hpp"
+#include "topicMatcher.hpp"
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    using topicMatcher::matches;
+
+    struct Received {
+        std::string topic;
+        std::string payload;
+    };
+
+    void testWildcards()
+    {
+        AsyncMqttClient client;
+        MqttDispatcher dispatcher(client);
+        std::map<std::string, std::vector<std::string>> received;
+        auto subscribe = [&](const char* filter) {
+            dispatcher.subscribe(filter, 0, [&received, filter](const char* topic, const char*, size_t) {
+                received[filter].push_back(topic);
+            });
+        };
+        subscribe("a/b");
+        subscribe("a/+");
+        subscribe("a/#");
+        subscribe("#");
+        subscribe("+/+/c");
+        subscribe("$SYS/#");
+
+        for (const char* topic : {"a", "a/b", "a/x", "a/b/c", "b", "$SYS/load", "a//c"}) {
+            client.deliver(topic, "");
+        }
+        CHECK(received["a/b"] == std::vector<std::string>{"a/b"});
+        CHECK(received["a/+"] == (std::vector<std::string>{"a/b", "a/x"}));
+        // The parent level is matched by "#" as well
+        CHECK(received["a/#"] == (std::vector<std::string>{"a", "a/b", "a/x", "a/b/c", "a//c"}));
+        CHECK(received["#"] == (std::vector<std::string>{"a", "a/b", "a/x", "a/b/c", "b", "a//c"}));
+        CHECK(received["+/+/c"] == (std::vector<std::string>{"a/b/c", "a//c"}));
+        CHECK(received["$SYS/#"] == std::vector<std::string>{"$SYS/load"});
+    }
+
+    void testValidFilters()
+    {
+        for (const char* filter : {"a", "a/b", "+", "#", "a/+/b", "a/#", "+/+", "/", "a//b", "$SYS/#"}) {
+            CHECK(MqttDispatcher::isValidFilter(filter));
+        }
+        for (const char* filter : {"", "a+", "a/b#", "#/a", "a/#/b", "++", "a/+b"}) {
+            CHECK(!MqttDispatcher::isValidFilter(filter));
+        }
+        CHECK(!MqttDispatcher::isValidFilter(nullptr));
+
+        AsyncMqttClient client;
+        MqttDispatcher dispatcher(client);
+        CHECK_EQUAL(dispatcher.subscribe("a/#/b", 0, [](const char*, const char*, size_t) {}), 0u);
+        CHECK_EQUAL(dispatcher.subscribe("a", 0, MqttDispatcher::Handler()), 0u);
+        CHECK_EQUAL(dispatcher.handlerCount(), 0u);
+    }
+
+    void testAgainstMatcher()
+    {
+        const char* levels[] = {"a", "b", "c", "", "$s"};
+        std::mt19937 random(11);
+        auto level = [&]() { return std::string(levels[random() % 5]); };
+
+        AsyncMqttClient client;
+        MqttDispatcher dispatcher(client);
+        std::vector<std::string> filters;
+        std::map<MqttDispatcher::HandlerId, size_t> filterOf;
+        std::map<size_t, int> calls;
+        for (size_t i = 0; i < 200; i++) {
+            std::string filter;
+            const int count = 1 + random() % 4;
+            for (int j = 0; j < count; j++) {
+                const int kind = random() % 6;
+                filter += (j == 0) ? "" : "/";
+                filter += (kind == 0) ? "+" : ((kind == 1 && j == count - 1) ? "#" : level());
+            }
+            if (filter.empty()) {
+                continue;
+            }
+            filters.push_back(filter);
+            const size_t index = filters.size() - 1;
+            const auto id = dispatcher.subscribe(filter.c_str(), 0, [&calls, index](const char*, const char*, size_t) {
+                calls[index]++;
+            });
+            CHECK(id != 0);
+            filterOf[id] = index;
+        }
+        // Some handlers gone again
+        for (MqttDispatcher::HandlerId id = 1; id <= 200; id += 3) {
+            dispatcher.unsubscribe(id);
+            filterOf.erase(id);
+        }
+
+        for (int i = 0; i < 5000; i++) {
+            std::string topic;
+            const int count = 1 + random() % 4;
+            for (int j = 0; j < count; j++) {
+                topic += (j == 0) ? level() : "/" + level();
+            }
+            if (topic.empty()) {
+                continue;
+            }
+
+            calls.clear();
+            client.deliver(topic.c_str(), "x");
+            for (const auto& entry : filterOf) {
+                const int expected = matches(filters[entry.second], topic) ? 1 : 0;
+                if (calls[entry.second] != expected) {
+                    fprintf(stderr, "filter \"%s\" topic \"%s\"\n", filters[entry.second].c_str(), topic.c_str());
+                }
+                CHECK_EQUAL(calls[entry.second], expected);
+            }
+        }
+    }
+
+    void testReassembly()
+    {
+        AsyncMqttClient client;
+        MqttDispatcher dispatcher(client);
+        dispatcher.setMaxMessageSize(100);
+        std::vector<Received> received;
+        dispatcher.subscribe("t", 0, [&received](const char* topic, const char* payload, size_t length) {
+            // Terminated behind the payload
+            CHECK_EQUAL(payload[length], '\0');
+            received.push_back(Received{topic, std::string(payload, length)});
+        });
+
+        const std::string large(100, 'p');
+        client.deliver("t", large, 7);
+        client.deliver("t", "");
+        // Dropped without affecting the next one
+        client.deliver("t", large + "!", 10);
+        client.deliver("t", "after", 2);
+        CHECK_EQUAL(received.size(), 3u);
+        CHECK(received[0].payload == large);
+        CHECK(received[1].payload.empty());
+        CHECK(received[2].payload == "after");
+
+        // The first fragment got lost, the rest is dropped
+        received.clear();
+        client.deliverFragment("t", "tail", 4, 8);
+        CHECK(received.empty());
+        client.deliver("t", "next");
+        CHECK_EQUAL(received.size(), 1u);
+    }
+
+    void testBrokerSubscriptions()
+    {
+        AsyncMqttClient client;
+        MqttDispatcher dispatcher(client);
+        auto ignore = [](const char*, const char*, size_t) {};
+
+        // Subscribed once connected
+        const auto first = dispatcher.subscribe("a/+", 0, ignore);
+        CHECK(client.subscriptions.empty());
+        client.connect();
+        CHECK_EQUAL(client.subscriptions.size(), 1u);
+
+        // A second handler only subscribes again for a higher QoS
+        const auto second = dispatcher.subscribe("a/+", 0, ignore);
+        CHECK_EQUAL(client.subscriptions.size(), 1u);
+        const auto third = dispatcher.subscribe("a/+", 1, ignore);
+        CHECK_EQUAL(client.subscriptions.size(), 2u);
+        CHECK_EQUAL(client.subscriptions.back().qos, 1);
+        CHECK_EQUAL(dispatcher.handlerCount(), 3u);
+        CHECK_EQUAL(dispatcher.filterCount(), 1u);
+
+        dispatcher.unsubscribe(first);
+        dispatcher.unsubscribe(third);
+        CHECK_EQUAL(client.subscriptions.size(), 2u);
+        dispatcher.unsubscribe(second);
+        CHECK_EQUAL(client.subscriptions.size(), 3u);
+        CHECK_EQUAL(client.subscriptions.back().qos, -1);
+        CHECK(client.subscriptions.back().filter == "a/+");
+        CHECK_EQUAL(dispatcher.filterCount(), 0u);
+        // Unknown ids are ignored
+        dispatcher.unsubscribe(second);
+        CHECK_EQUAL(dispatcher.handlerCount(), 0u);
+    }
+
+    void testUnsubscribeFromHandler()
+    {
+        AsyncMqttClient client;
+        MqttDispatcher dispatcher(client);
+        int calls = 0;
+        MqttDispatcher::HandlerId id = 0;
+        id = dispatcher.subscribe("once", 0, [&](const char*, const char*, size_t) {
+            calls++;
+            dispatcher.unsubscribe(id);
+            dispatcher.subscribe("other", 0, [](const char*, const char*, size_t) {});
+        });
+        client.deliver("once", "1");
+        client.deliver("once", "2");
+        CHECK_EQUAL(calls, 1);
+        CHECK_EQUAL(dispatcher.handlerCount(), 1u);
+    }
+
+    void testResumeSession()
+    {
+        AsyncMqttClient client;
+        MqttDispatcher dispatcher(client);
+        std::vector<uint32_t> digests;
+        dispatcher.resumeSession(0, [&digests](uint32_t digest) { digests.push_back(digest); });
+        dispatcher.subscribe("a", 1, [](const char*, const char*, size_t) {});
+        dispatcher.subscribe("b/#", 0, [](const char*, const char*, size_t) {});
+
+        // No digest known, subscribed even though the broker has a session
+        client.connect(true);
+        CHECK_EQUAL(client.subscriptions.size(), 2u);
+        CHECK_EQUAL(digests.size(), 1u);
+        const uint32_t digest = digests.back();
+        CHECK(digest != 0);
+
+        // After deep sleep: same filters, the session is resumed
+        AsyncMqttClient resumed;
+        MqttDispatcher again(resumed);
+        again.resumeSession(digest, [&digests](uint32_t changed) { digests.push_back(changed); });
+        again.subscribe("b/#", 0, [](const char*, const char*, size_t) {});
+        again.subscribe("a", 1, [](const char*, const char*, size_t) {});
+        resumed.connect(true);
+        CHECK(resumed.subscriptions.empty());
+        CHECK_EQUAL(digests.size(), 1u);
+
+        // The broker lost the session
+        AsyncMqttClient lost;
+        MqttDispatcher third(lost);
+        third.resumeSession(digest, [&digests](uint32_t changed) { digests.push_back(changed); });
+        third.subscribe("a", 1, [](const char*, const char*, size_t) {});
+        third.subscribe("b/#", 0, [](const char*, const char*, size_t) {});
+        lost.connect(false);
+        CHECK_EQUAL(lost.subscriptions.size(), 2u);
+        // Same filters, same digest, nothing to store
+        CHECK_EQUAL(digests.size(), 1u);
+
+        // Another QoS is another session
+        AsyncMqttClient changed;
+        MqttDispatcher fourth(changed);
+        fourth.resumeSession(digest, [&digests](uint32_t newDigest) { digests.push_back(newDigest); });
+        fourth.subscribe("a", 0, [](const char*, const char*, size_t) {});
+        fourth.subscribe("b/#", 0, [](const char*, const char*, size_t) {});
+        changed.connect(true);
+        CHECK_EQUAL(changed.subscriptions.size(), 2u);
+        CHECK_EQUAL(digests.size(), 2u);
+        CHECK(digests.back() != digest);
+    }
+}
+
+int main()
+{
+    testWildcards();
+    testValidFilters();
+    testAgainstMatcher();
+    testReassembly();
+    testBrokerSubscriptions();
+    testUnsubscribeFromHandler();
+    testResumeSession();
+    return check::result();
+}
@@ -0,0 +1,63 @@
+// Register and acknowledge throughput of MqttGuard against the former std::vector implementation.
+// Run with a number of rounds, e.g. "mqttGuardBenchmark 20000", CTest only runs a few to keep it building.
+
+#include "mqttGuard.hpp"
+#include "vectorMqttGuard.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+    // Registers "inFlight" consecutive ids and acknowledges them in random order, "rounds" times
+    template <typename Guard>
+    double nanosecondsPerOperation(size_t inFlight, unsigned rounds)
+    {
+        Guard guard;
+        std::mt19937 random(inFlight);
+        std::vector<uint16_t> packetIds(inFlight);
+        uint16_t next = 1;
+        uint64_t operations = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned round = 0; round < rounds; round++) {
+            for (auto &packetId : packetIds) {
+                packetId = next;
+                next = (next == 65535) ? 1 : next + 1;
+                guard.registerPacket(packetId);
+            }
+            // Acks arrive about in order, with some reordering
+            for (size_t i = 0; i + 1 < packetIds.size(); i++) {
+                if (random() % 4 == 0) {
+                    std::swap(packetIds[i], packetIds[i + 1]);
+                }
+            }
+            for (const auto packetId : packetIds) {
+                guard.unregisterPacket(packetId);
+            }
+            operations += 2 * inFlight;
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        if (!guard.allSent()) {
+            fprintf(stderr, "Packets left over\n");
+            exit(1);
+        }
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / operations;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const unsigned rounds = (argc > 1) ? static_cast<unsigned>(atoi(argv[1])) : 2000;
+
+    printf("%10s %16s %16s\n", "in flight", "vector (ns/op)", "hash (ns/op)");
+    for (size_t inFlight : {1u, 16u, 64u, 128u, 384u}) {
+        const double vector = nanosecondsPerOperation<VectorMqttGuard>(inFlight, rounds);
+        const double hash = nanosecondsPerOperation<MqttGuard>(inFlight, rounds);
+        printf("%10zu %16.1f %16.1f\n", inFlight, vector, hash);
+    }
+    return 0;
+}
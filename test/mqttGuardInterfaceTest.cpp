@@ -0,0 +1,224 @@
+// MqttGuardInterface with an offline queue, driven through the stand-in client
+
+#include "mqttGuardInterface.hpp"
+#include "check.hpp"
+
+#include <string>
+#include <vector>
+
+namespace {
+    std::unique_ptr<MqttOfflineQueue> ramQueue()
+    {
+        return std::unique_ptr<MqttOfflineQueue>(new MqttOfflineQueue(16));
+    }
+
+    std::vector<std::string> topics(const AsyncMqttClient& client, size_t from = 0)
+    {
+        std::vector<std::string> result;
+        for (size_t i = from; i < client.published.size(); i++) {
+            result.push_back(client.published[i].topic);
+        }
+        return result;
+    }
+
+    void testRejectsZeroRate()
+    {
+        AsyncMqttClient client;
+        MqttGuardInterface guard(client);
+        CHECK(guard.mqttSetOfflineQueue(ramQueue(), 5));
+        guard.mqttPublish("kept", 1, false, "1");
+        CHECK_EQUAL(guard.mqttQueuedMessages(), 1u);
+
+        // Would never replay, the queue in use stays
+        CHECK(!guard.mqttSetOfflineQueue(ramQueue(), 0));
+        CHECK_EQUAL(guard.mqttQueuedMessages(), 1u);
+        // Removing the queue needs no rate
+        CHECK(guard.mqttSetOfflineQueue(nullptr, 0));
+        CHECK_EQUAL(guard.mqttQueuedMessages(), 0u);
+    }
+
+    void testResendsUnacknowledged()
+    {
+        AsyncMqttClient client;
+        client.connect();
+        MqttGuardInterface guard(client);
+        guard.mqttSetOfflineQueue(ramQueue(), 100);
+
+        const uint16_t first = guard.mqttPublish("a", 1, false, "1");
+        guard.mqttPublish("b", 1, true, "22");
+        guard.mqttPublish("c", 0, false, "3");
+        guard.mqttPublish("d", 2, false, "4444", 2);
+        client.acknowledge(first);
+
+        client.disconnect();
+        CHECK_EQUAL(guard.mqttRemainingPackets(), 0u);
+        CHECK_EQUAL(guard.mqttQueuedMessages(), 2u);
+        guard.mqttPublish("e", 1, false, "5");
+        CHECK_EQUAL(guard.mqttQueuedMessages(), 3u);
+
+        const size_t sent = client.published.size();
+        client.connect();
+        // Unacknowledged first, in the order sent, then the offline queue. QoS 0 is not sent again.
+        CHECK(topics(client, sent) == (std::vector<std::string>{"b", "d", "e"}));
+        CHECK_EQUAL(client.published[sent].payload, std::string("22"));
+        CHECK(client.published[sent].retain);
+        CHECK_EQUAL(client.published[sent + 1].payload, std::string("44"));
+        CHECK_EQUAL(client.published[sent + 1].qos, 2);
+        CHECK_EQUAL(guard.mqttQueuedMessages(), 0u);
+        CHECK_EQUAL(guard.mqttRemainingPackets(), 3u);
+
+        // Acknowledged after resending, nothing left for the next disconnect
+        for (size_t i = sent; i < client.published.size(); i++) {
+            client.acknowledge(client.published[i].packetId);
+        }
+        CHECK(guard.mqttAllSent());
+        client.disconnect();
+        CHECK_EQUAL(guard.mqttQueuedMessages(), 0u);
+        client.connect();
+        CHECK_EQUAL(client.published.size(), sent + 3);
+    }
+
+    void testResendKeepsOrderAcrossDisconnects()
+    {
+        AsyncMqttClient client;
+        client.connect();
+        MqttGuardInterface guard(client);
+        // One message on connect, one more per second
+        guard.mqttSetOfflineQueue(ramQueue(), 1);
+
+        guard.mqttPublish("a", 1, false, "1");
+        guard.mqttPublish("b", 1, false, "2");
+        guard.mqttPublish("c", 1, false, "3");
+        client.disconnect();
+        CHECK_EQUAL(guard.mqttQueuedMessages(), 3u);
+
+        size_t sent = client.published.size();
+        client.connect();
+        CHECK(topics(client, sent) == std::vector<std::string>{"a"});
+        // Connected, but must not overtake b and c
+        CHECK_EQUAL(guard.mqttPublish("d", 1, false, "4"), 0);
+        CHECK_EQUAL(guard.mqttQueuedMessages(), 3u);
+
+        // a is lost again before its acknowledgement and stays in front
+        client.disconnect();
+        hostMillis += 1000;
+        sent = client.published.size();
+        client.connect();
+        CHECK_EQUAL(guard.mqttReplayOfflineQueue(), 0u);
+        for (int i = 0; i < 3; i++) {
+            hostMillis += 1000;
+            CHECK_EQUAL(guard.mqttReplayOfflineQueue(), 1u);
+        }
+        CHECK(topics(client, sent) == (std::vector<std::string>{"a", "b", "c", "d"}));
+    }
+
+    void testFullWindowKeepsMessage()
+    {
+        AsyncMqttClient client;
+        client.connect();
+        MqttGuardInterface guard(client);
+        guard.mqttSetOfflineQueue(ramQueue(), 100);
+        guard.mqttPublish("a", 1, false, "1");
+        guard.mqttPublish("b", 1, false, "2");
+        client.disconnect();
+
+        client.full = true;
+        client.connect();
+        CHECK_EQUAL(guard.mqttQueuedMessages(), 2u);
+        client.full = false;
+        hostMillis += 1000;
+        const size_t sent = client.published.size();
+        CHECK_EQUAL(guard.mqttReplayOfflineQueue(), 2u);
+        CHECK(topics(client, sent) == (std::vector<std::string>{"a", "b"}));
+    }
+
+    void testTimedOutNotResent()
+    {
+        AsyncMqttClient client;
+        client.connect();
+        MqttGuardInterface guard(client);
+        guard.mqttSetOfflineQueue(ramQueue(), 100);
+        guard.mqttSetAckDeadline(100);
+
+        guard.mqttPublish("lost", 1, false, "1");
+        hostMillis += 200;
+        CHECK_EQUAL(guard.mqttCheckTimeouts(), 1u);
+        client.disconnect();
+        CHECK_EQUAL(guard.mqttQueuedMessages(), 0u);
+        const size_t sent = client.published.size();
+        client.connect();
+        CHECK_EQUAL(client.published.size(), sent);
+    }
+
+    void testNothingKeptWithoutQueue()
+    {
+        AsyncMqttClient client;
+        client.connect();
+        MqttGuardInterface guard(client);
+        guard.mqttPublish("a", 1, false, "1");
+        client.disconnect();
+        const size_t sent = client.published.size();
+        client.connect();
+        CHECK_EQUAL(client.published.size(), sent);
+        CHECK_EQUAL(guard.mqttPublish("b", 1, false, "2") != 0, true);
+    }
+    void testRejectsMissingTopics()
+    {
+        AsyncMqttClient client;
+        client.connect();
+        MqttGuardInterface guard(client);
+        guard.mqttSetOfflineQueue(ramQueue(), 100);
+        // Neither sent nor queued
+        CHECK_EQUAL(guard.mqttPublish(nullptr, 1, false, "1"), 0);
+        CHECK_EQUAL(guard.mqttPublish("", 1, false, "1"), 0);
+        CHECK_EQUAL(guard.mqttQueuedMessages(), 0u);
+
+        std::vector<MqttBatchResult> results;
+        auto record = [&results](MqttBatchResult result) { results.push_back(result); };
+        CHECK(!guard.mqttPublishBatch({{"a", "1", 1, false}, {nullptr, "2", 1, false}}, record));
+        CHECK(!guard.mqttPublishStream("", 1, 4, [](size_t, char*, size_t length) { return length; }, record));
+        CHECK(results == (std::vector<MqttBatchResult>{MqttBatchResult::failed, MqttBatchResult::failed}));
+        CHECK(client.published.empty());
+    }
+
+    void testStreamChunks()
+    {
+        AsyncMqttClient client;
+        client.connect();
+        MqttGuardInterface guard(client);
+        fs::FS fs;
+        fs.host.files["/log"] = "0123456789";
+
+        std::vector<MqttBatchResult> results;
+        CHECK(guard.mqttPublishFile("log", 1, fs, "/log",
+            [&results](MqttBatchResult result) { results.push_back(result); }, 4));
+        // One chunk at a time, the next once the previous one has been acknowledged
+        for (size_t chunk = 0; chunk < 3; chunk++) {
+            CHECK_EQUAL(client.published.size(), chunk + 1);
+            CHECK(results.empty());
+            client.acknowledge(client.published.back().packetId);
+        }
+        CHECK(topics(client) == (std::vector<std::string>{"log/0/3", "log/1/3", "log/2/3"}));
+        CHECK_EQUAL(client.published[0].payload, std::string("0123"));
+        CHECK_EQUAL(client.published[2].payload, std::string("89"));
+        // The broker must not keep the chunks of every stream
+        for (const auto& published : client.published) {
+            CHECK(!published.retain);
+        }
+        CHECK(results == std::vector<MqttBatchResult>{MqttBatchResult::acknowledged});
+        CHECK(guard.mqttAllSent());
+    }
+}
+
+int main()
+{
+    testRejectsZeroRate();
+    testResendsUnacknowledged();
+    testResendKeepsOrderAcrossDisconnects();
+    testFullWindowKeepsMessage();
+    testTimedOutNotResent();
+    testNothingKeptWithoutQueue();
+    testRejectsMissingTopics();
+    testStreamChunks();
+    return check::result();
+}
@@ -0,0 +1,350 @@
+// MqttGuard cross-checked against a std::set of the registered packet ids
+
+#include "mqttGuard.hpp"
+#include "check.hpp"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+    uint32_t clockMs = 0;
+
+    uint32_t virtualClock()
+    {
+        return clockMs;
+    }
+
+    // Random ids, so they collide in the table and wrap around its end
+    void testAgainstSet()
+    {
+        MqttGuard guard;
+        std::set<MqttGuard::IdType> expected;
+        std::mt19937 random(7);
+
+        for (int i = 0; i < 500000; i++) {
+            const auto packetId = static_cast<MqttGuard::IdType>(random());
+            if (random() % 2 != 0 && expected.size() < MqttGuard::maxTrackedPackets) {
+                guard.registerPacket(packetId);
+                // Invalid and duplicate ids are ignored
+                if (packetId != 0) {
+                    expected.insert(packetId);
+                }
+            } else if (!expected.empty()) {
+                auto next = expected.lower_bound(packetId);
+                if (next == expected.end()) {
+                    next = expected.begin();
+                }
+                guard.unregisterPacket(*next);
+                CHECK(!guard.isRegistered(*next));
+                expected.erase(next);
+            }
+            CHECK_EQUAL(guard.remainingPacketCount(), expected.size());
+
+            if (i % 5000 == 0) {
+                for (const auto registered : expected) {
+                    CHECK(guard.isRegistered(registered));
+                }
+                // Ids not registered are not found, and unregistering them changes nothing
+                for (int probe = 0; probe < 100; probe++) {
+                    const auto unknown = static_cast<MqttGuard::IdType>(random());
+                    if (expected.count(unknown) == 0) {
+                        CHECK(!guard.isRegistered(unknown));
+                        guard.unregisterPacket(unknown);
+                    }
+                }
+                CHECK_EQUAL(guard.remainingPacketCount(), expected.size());
+            }
+        }
+
+        for (const auto registered : expected) {
+            guard.unregisterPacket(registered);
+        }
+        CHECK(guard.allSent());
+    }
+
+    // Consecutive ids as handed out by AsyncMqttClient, wrapping from 65535 to 1
+    void testConsecutiveIds()
+    {
+        MqttGuard guard;
+        std::set<MqttGuard::IdType> expected;
+        MqttGuard::IdType next = 65000;
+        std::mt19937 random(1);
+
+        for (int i = 0; i < 200000; i++) {
+            if (expected.size() < 300 && (expected.empty() || random() % 2 != 0)) {
+                guard.registerPacket(next);
+                expected.insert(next);
+                next = (next == 65535) ? 1 : next + 1;
+            } else {
+                auto acknowledged = expected.begin();
+                std::advance(acknowledged, random() % expected.size());
+                guard.unregisterPacket(*acknowledged);
+                expected.erase(acknowledged);
+            }
+            CHECK_EQUAL(guard.remainingPacketCount(), expected.size());
+        }
+    }
+
+    void testInvalidIds()
+    {
+        MqttGuard guard;
+        guard.registerPacket(0);
+        CHECK(guard.allSent());
+        CHECK(!guard.isRegistered(0));
+
+        guard.registerPacket(42);
+        guard.registerPacket(42);
+        CHECK_EQUAL(guard.remainingPacketCount(), 1u);
+        guard.unregisterPacket(43);
+        CHECK_EQUAL(guard.remainingPacketCount(), 1u);
+        guard.unregisterPacket(42);
+        CHECK(guard.allSent());
+        CHECK_EQUAL(guard.getStatistics().acknowledged, 1u);
+    }
+
+    void testUntracked()
+    {
+        MqttGuard guard;
+        for (MqttGuard::IdType packetId = 1; packetId <= MqttGuard::maxTrackedPackets + 10; packetId++) {
+            guard.registerPacket(packetId);
+        }
+        CHECK_EQUAL(guard.remainingPacketCount(), MqttGuard::maxTrackedPackets + 10);
+        CHECK_EQUAL(guard.untrackedPacketCount(), 10u);
+        CHECK(!guard.isRegistered(MqttGuard::maxTrackedPackets + 1));
+
+        // Acks of untracked packets can only be counted
+        for (MqttGuard::IdType packetId = MqttGuard::maxTrackedPackets + 1; packetId <= MqttGuard::maxTrackedPackets + 10; packetId++) {
+            guard.unregisterPacket(packetId);
+        }
+        CHECK_EQUAL(guard.untrackedPacketCount(), 0u);
+        CHECK_EQUAL(guard.remainingPacketCount(), MqttGuard::maxTrackedPackets);
+
+        // Further unknown ids do not count anymore
+        guard.unregisterPacket(60000);
+        CHECK_EQUAL(guard.remainingPacketCount(), MqttGuard::maxTrackedPackets);
+
+        guard.reset();
+        CHECK(guard.allSent());
+        CHECK_EQUAL(guard.getStatistics().resets, 1u);
+        CHECK_EQUAL(guard.getStatistics().resetPackets, MqttGuard::maxTrackedPackets);
+        CHECK_EQUAL(guard.getStatistics().acknowledged, 10u);
+        for (MqttGuard::IdType packetId = 1; packetId <= MqttGuard::maxTrackedPackets; packetId++) {
+            CHECK(!guard.isRegistered(packetId));
+        }
+    }
+
+    void testTimeouts()
+    {
+        clockMs = 1000;
+        MqttGuard guard({}, virtualClock);
+        std::vector<std::pair<MqttGuard::IdType, uint32_t>> dropped;
+
+        // No deadline, nothing times out
+        guard.registerPacket(1);
+        clockMs += 100000;
+        CHECK_EQUAL(guard.checkTimeouts(), 0u);
+
+        guard.setDeadline(500, [&dropped](MqttGuard::IdType packetId, uint32_t waited) {
+            dropped.emplace_back(packetId, waited);
+        });
+        guard.reset();
+        guard.registerPacket(1);
+        clockMs += 200;
+        guard.registerPacket(2);
+        clockMs += 200;
+        guard.registerPacket(3);
+        clockMs += 99;
+        CHECK_EQUAL(guard.checkTimeouts(), 0u);
+        clockMs += 1;
+        CHECK_EQUAL(guard.checkTimeouts(), 1u);
+        CHECK_EQUAL(dropped.size(), 1u);
+        CHECK_EQUAL(dropped[0].first, 1u);
+        CHECK_EQUAL(dropped[0].second, 500u);
+        CHECK(!guard.isRegistered(1));
+
+        // Acknowledged in time
+        clockMs += 50;
+        guard.unregisterPacket(2);
+        CHECK_EQUAL(guard.getLatencyHistogram().count(), 1u);
+        CHECK_EQUAL(guard.getLatencyHistogram().max(), 350u);
+
+        clockMs += 1000;
+        CHECK_EQUAL(guard.checkTimeouts(), 1u);
+        CHECK_EQUAL(dropped.back().first, 3u);
+        CHECK_EQUAL(dropped.back().second, 1150u);
+        CHECK(guard.allSent());
+        CHECK_EQUAL(guard.getStatistics().timeouts, 2u);
+        CHECK_EQUAL(guard.getStatistics().acknowledged, 1u);
+
+        // Without a clock there are no timeouts
+        MqttGuard withoutClock;
+        withoutClock.setDeadline(1);
+        withoutClock.registerPacket(1);
+        CHECK_EQUAL(withoutClock.checkTimeouts(), 0u);
+    }
+
+    // Ids with the same home slot at the end of the table wrap around to its start
+    void testTimeoutsWrapped()
+    {
+        clockMs = 0;
+        MqttGuard guard({}, virtualClock);
+        std::vector<MqttGuard::IdType> dropped;
+        guard.setDeadline(100, [&dropped](MqttGuard::IdType packetId, uint32_t) {
+            dropped.push_back(packetId);
+        });
+
+        // Home slots 511, 511, 0, 511, 1, 511
+        const std::vector<MqttGuard::IdType> packetIds = {511, 1023, 512, 1535, 513, 2047};
+        for (size_t i = 0; i < packetIds.size(); i++) {
+            clockMs = (i % 2 == 0) ? 0 : 50;
+            guard.registerPacket(packetIds[i]);
+        }
+
+        clockMs = 100;
+        CHECK_EQUAL(guard.checkTimeouts(), 3u);
+        std::sort(dropped.begin(), dropped.end());
+        CHECK((dropped == std::vector<MqttGuard::IdType>{511, 512, 513}));
+        CHECK(guard.isRegistered(1023));
+        CHECK(guard.isRegistered(1535));
+        CHECK(guard.isRegistered(2047));
+
+        clockMs = 150;
+        CHECK_EQUAL(guard.checkTimeouts(), 3u);
+        CHECK(guard.allSent());
+    }
+
+    // Random ids registered at random times, against a map of id to registration time
+    void testTimeoutsAgainstMap()
+    {
+        clockMs = 0;
+        MqttGuard guard({}, virtualClock);
+        const uint32_t deadline = 1000;
+        std::map<MqttGuard::IdType, uint32_t> expected;
+        size_t droppedCount = 0;
+        guard.setDeadline(deadline, [&](MqttGuard::IdType packetId, uint32_t waited) {
+            droppedCount++;
+            CHECK(expected.count(packetId) == 1);
+            CHECK_EQUAL(waited, clockMs - expected[packetId]);
+            CHECK(waited >= deadline);
+            expected.erase(packetId);
+        });
+        std::mt19937 random(3);
+
+        for (int i = 0; i < 200000; i++) {
+            clockMs += random() % 20;
+            const auto packetId = static_cast<MqttGuard::IdType>(random());
+            if (random() % 4 != 0) {
+                if (packetId != 0 && expected.size() < MqttGuard::maxTrackedPackets && expected.count(packetId) == 0) {
+                    guard.registerPacket(packetId);
+                    expected[packetId] = clockMs;
+                }
+            } else if (!expected.empty()) {
+                auto acknowledged = expected.lower_bound(packetId);
+                if (acknowledged == expected.end()) {
+                    acknowledged = expected.begin();
+                }
+                guard.unregisterPacket(acknowledged->first);
+                expected.erase(acknowledged);
+            }
+
+            if (i % 50 == 0) {
+                size_t expectedTimeouts = 0;
+                for (const auto &packet : expected) {
+                    expectedTimeouts += (clockMs - packet.second >= deadline) ? 1 : 0;
+                }
+                const size_t before = droppedCount;
+                CHECK_EQUAL(guard.checkTimeouts(), expectedTimeouts);
+                CHECK_EQUAL(droppedCount - before, expectedTimeouts);
+                CHECK_EQUAL(guard.remainingPacketCount(), expected.size());
+                for (const auto &packet : expected) {
+                    CHECK(guard.isRegistered(packet.first));
+                }
+            }
+        }
+        CHECK(droppedCount > 0);
+    }
+
+    void testTimeoutCallbackChangesGuard()
+    {
+        clockMs = 0;
+        MqttGuard guard({}, virtualClock);
+        MqttGuard::IdType nextId = 100;
+        int calls = 0;
+        // Each dropped packet is sent again, the new one must not time out in the same check
+        guard.setDeadline(10, [&](MqttGuard::IdType, uint32_t) {
+            calls++;
+            guard.registerPacket(nextId++);
+        });
+        for (MqttGuard::IdType packetId = 1; packetId <= 20; packetId++) {
+            guard.registerPacket(packetId);
+        }
+        clockMs = 10;
+        CHECK_EQUAL(guard.checkTimeouts(), 20u);
+        CHECK_EQUAL(calls, 20);
+        CHECK_EQUAL(guard.remainingPacketCount(), 20u);
+        CHECK(guard.isRegistered(100));
+
+        // Replacing the callback from within itself
+        int replaced = 0;
+        guard.setDeadline(10, [&](MqttGuard::IdType, uint32_t) {
+            guard.setDeadline(10, [&replaced](MqttGuard::IdType, uint32_t) {
+                replaced++;
+            });
+        });
+        clockMs = 20;
+        CHECK_EQUAL(guard.checkTimeouts(), 20u);
+        guard.registerPacket(1);
+        clockMs = 30;
+        CHECK_EQUAL(guard.checkTimeouts(), 1u);
+        CHECK_EQUAL(replaced, 1);
+    }
+
+    void testUntrackedTimeouts()
+    {
+        clockMs = 0;
+        MqttGuard guard({}, virtualClock);
+        guard.setDeadline(100);
+        for (MqttGuard::IdType packetId = 1; packetId <= MqttGuard::maxTrackedPackets + 5; packetId++) {
+            guard.registerPacket(packetId);
+            clockMs++;
+        }
+        // All but the last tracked one, registered at 383
+        clockMs = 482;
+        CHECK_EQUAL(guard.checkTimeouts(), MqttGuard::maxTrackedPackets - 1);
+        // The untracked ones time out with the latest of them, registered at 388
+        CHECK_EQUAL(guard.untrackedPacketCount(), 5u);
+        clockMs = 488;
+        CHECK_EQUAL(guard.checkTimeouts(), 6u);
+        CHECK(guard.allSent());
+    }
+
+    void testLog()
+    {
+        std::vector<std::string> messages;
+        MqttGuard guard([&messages](basecampLog::Severity, const std::string &message) {
+            messages.push_back(message);
+        });
+        guard.registerPacket(0);
+        guard.unregisterPacket(7);
+        CHECK_EQUAL(messages.size(), 2u);
+        CHECK(messages.back() == "Not unregistering unknown MQTT-packet. - Packet-ID: 7");
+    }
+}
+
+int main()
+{
+    testAgainstSet();
+    testConsecutiveIds();
+    testInvalidIds();
+    testUntracked();
+    testTimeouts();
+    testTimeoutsWrapped();
+    testTimeoutsAgainstMap();
+    testTimeoutCallbackChangesGuard();
+    testUntrackedTimeouts();
+    testLog();
+    return check::result();
+}
@@ -0,0 +1,205 @@
+// MqttOfflineQueue spilling to segment files of the in-memory file system
+
+#include "MqttOfflineQueue.hpp"
+#include "check.hpp"
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+    // 12 bytes of header, "t" and "p000": 17 bytes per record, 3 fit into a segment of 64 bytes
+    const constexpr size_t segmentSize = 64;
+
+    std::string payload(int i)
+    {
+        char text[8];
+        snprintf(text, sizeof(text), "p%03d", i);
+        return text;
+    }
+
+    void pushRange(MqttOfflineQueue& queue, int from, int to)
+    {
+        for (int i = from; i < to; i++) {
+            CHECK(queue.push("t", 1, (i % 2) == 0, payload(i).c_str(), 0));
+        }
+    }
+
+    // Pops everything, returns the numbers of the payloads
+    std::vector<int> drain(MqttOfflineQueue& queue)
+    {
+        std::vector<int> numbers;
+        MqttOfflineQueue::Message message;
+        while (queue.front(message)) {
+            CHECK(message.topic == "t");
+            CHECK_EQUAL(message.qos, 1);
+            const int number = atoi(std::string(message.payload.begin() + 1, message.payload.end()).c_str());
+            CHECK_EQUAL(message.retain, (number % 2) == 0);
+            numbers.push_back(number);
+            queue.pop();
+        }
+        return numbers;
+    }
+
+    std::vector<int> range(int from, int to)
+    {
+        std::vector<int> numbers;
+        for (int i = from; i < to; i++) {
+            numbers.push_back(i);
+        }
+        return numbers;
+    }
+
+    void testSpillInOrder()
+    {
+        fs::FS fs;
+        MqttOfflineQueue queue(4, fs, "/q", segmentSize, 8);
+        CHECK(queue.begin());
+        pushRange(queue, 0, 20);
+        CHECK_EQUAL(queue.size(), 20u);
+        // 16 spilled, 3 per segment
+        CHECK(fs.exists("/q.0"));
+        CHECK(fs.exists("/q.5"));
+        CHECK(!fs.exists("/q.6"));
+        CHECK(fs.exists("/q.idx"));
+
+        // Pushing while popping keeps the order across RAM and files
+        MqttOfflineQueue::Message message;
+        CHECK(queue.front(message));
+        queue.pop();
+        pushRange(queue, 20, 25);
+        const auto numbers = drain(queue);
+        CHECK(numbers == range(1, 25));
+        CHECK(queue.empty());
+        CHECK_EQUAL(queue.dropped(), 0u);
+        // Nothing left behind
+        CHECK(fs.host.files.empty());
+    }
+
+    void testRecovery()
+    {
+        fs::FS fs;
+        {
+            MqttOfflineQueue queue(4, fs, "/q", segmentSize, 8);
+            CHECK(queue.begin());
+            pushRange(queue, 0, 20);
+            MqttOfflineQueue::Message message;
+            for (int i = 0; i < 4; i++) {
+                queue.front(message);
+                queue.pop();
+            }
+            // Before deep sleep
+            CHECK(queue.persist());
+        }
+
+        MqttOfflineQueue recovered(4, fs, "/q", segmentSize, 8);
+        CHECK(recovered.begin());
+        CHECK_EQUAL(recovered.size(), 16u);
+        CHECK(drain(recovered) == range(4, 20));
+
+        // A reset without persist(): what is in RAM is gone, the spilled messages are found even in
+        // segments added after the index has been written
+        {
+            MqttOfflineQueue queue(2, fs, "/q", segmentSize, 8);
+            CHECK(queue.begin());
+            pushRange(queue, 0, 20);
+        }
+        MqttOfflineQueue afterReset(2, fs, "/q", segmentSize, 8);
+        CHECK(afterReset.begin());
+        CHECK(drain(afterReset) == range(0, 18));
+    }
+
+    void testTornRecord()
+    {
+        fs::FS fs;
+        {
+            MqttOfflineQueue queue(1, fs, "/q", segmentSize, 8);
+            CHECK(queue.begin());
+            pushRange(queue, 0, 8);
+        }
+        // 7 spilled into /q.0 - /q.2, a reset tears the last record of /q.2
+        auto& last = fs.host.files["/q.2"];
+        last.resize(last.size() - 3);
+
+        MqttOfflineQueue queue(1, fs, "/q", segmentSize, 8);
+        CHECK(queue.begin());
+        CHECK_EQUAL(queue.size(), 6u);
+        // Never appended behind the torn record
+        pushRange(queue, 100, 104);
+        CHECK(drain(queue) == (std::vector<int>{0, 1, 2, 3, 4, 5, 100, 101, 102, 103}));
+    }
+
+    void testCorruptRecord()
+    {
+        fs::FS fs;
+        MqttOfflineQueue queue(1, fs, "/q", segmentSize, 8);
+        CHECK(queue.begin());
+        pushRange(queue, 0, 10);
+        // The payload of the first record of /q.1, so the rest of the segment is lost
+        fs.host.files["/q.1"][15] ^= 1;
+        CHECK(drain(queue) == (std::vector<int>{0, 1, 2, 6, 7, 8, 9}));
+        CHECK(queue.dropped() >= 1u);
+    }
+
+    void testGarbageHeader()
+    {
+        fs::FS fs;
+        {
+            MqttOfflineQueue queue(1, fs, "/q", segmentSize, 8);
+            CHECK(queue.begin());
+            pushRange(queue, 0, 3);
+        }
+        // The magic, but lengths of almost 128 KB
+        auto& segment = fs.host.files["/q.0"];
+        segment[4] = segment[5] = segment[6] = segment[7] = static_cast<char>(0xff);
+
+        MqttOfflineQueue queue(1, fs, "/q", segmentSize, 8);
+        CHECK(queue.begin());
+        CHECK(drain(queue).empty());
+        CHECK(fs.host.files.empty());
+    }
+
+    void testDropNewest()
+    {
+        fs::FS fs;
+        // 2 in RAM and 2 segments of 3
+        MqttOfflineQueue queue(2, fs, "/q", segmentSize, 2, MqttOfflineQueue::OverflowPolicy::dropNewest);
+        CHECK(queue.begin());
+        int accepted = 0;
+        for (int i = 0; i < 20; i++) {
+            accepted += queue.push("t", 1, (i % 2) == 0, payload(i).c_str(), 0) ? 1 : 0;
+        }
+        CHECK_EQUAL(accepted, 8);
+        CHECK_EQUAL(queue.dropped(), 12u);
+        CHECK(!fs.exists("/q.2"));
+        CHECK(drain(queue) == range(0, 8));
+    }
+
+    void testDropOldest()
+    {
+        fs::FS fs;
+        MqttOfflineQueue queue(2, fs, "/q", segmentSize, 2, MqttOfflineQueue::OverflowPolicy::dropOldest);
+        CHECK(queue.begin());
+        pushRange(queue, 0, 20);
+        // Whole segments are dropped, the newest messages are kept
+        CHECK(queue.size() <= 8u);
+        CHECK_EQUAL(queue.size() + queue.dropped(), 20u);
+        const auto numbers = drain(queue);
+        CHECK(numbers == range(20 - static_cast<int>(numbers.size()), 20));
+        CHECK(numbers.size() >= 5u);
+        // At most the segments allowed
+        CHECK(fs.host.files.size() <= 3u);
+    }
+}
+
+int main()
+{
+    testSpillInOrder();
+    testRecovery();
+    testTornRecord();
+    testCorruptRecord();
+    testGarbageHeader();
+    testDropNewest();
+    testDropOldest();
+    return check::result();
+}
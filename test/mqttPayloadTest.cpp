@@ -0,0 +1,115 @@
+// Payload formatting compared with printf
+
+#include "mqttPayload.hpp"
+#include "check.hpp"
+
+#include <array>
+#include <climits>
+#include <cmath>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace {
+    void testInteger()
+    {
+        CHECK_STRING(mqttPayload::integer(0), "0");
+        CHECK_STRING(mqttPayload::integer(-42), "-42");
+        CHECK_STRING(mqttPayload::integer(LONG_MAX), std::to_string(LONG_MAX).c_str());
+        CHECK_STRING(mqttPayload::integer(LONG_MIN), std::to_string(LONG_MIN).c_str());
+    }
+
+    void testNumber()
+    {
+        CHECK_STRING(mqttPayload::number(21.5), "21.50");
+        CHECK_STRING(mqttPayload::number(-0.004), "0.00");
+        CHECK_STRING(mqttPayload::number(-0.005), "-0.01");
+        CHECK_STRING(mqttPayload::number(2.5, 0), "3");
+        CHECK_STRING(mqttPayload::number(0.0000015, 6), "0.000002");
+        // At most maxDecimals
+        CHECK_STRING(mqttPayload::number(1.0, 9), "1.000000");
+
+        CHECK_STRING(mqttPayload::number(NAN), "nan");
+        CHECK_STRING(mqttPayload::number(INFINITY), "inf");
+        CHECK_STRING(mqttPayload::number(-INFINITY), "-inf");
+        // Finite, but beyond fixed point: an error, not infinity
+        CHECK(mqttPayload::number(1e20) == nullptr);
+        CHECK(mqttPayload::number(-1e20) == nullptr);
+        CHECK(mqttPayload::number(1e14, 6) == nullptr);
+        CHECK_STRING(mqttPayload::number(1e12, 6), "1000000000000.000000");
+
+        std::mt19937 random(3);
+        std::uniform_real_distribution<double> values(-1e6, 1e6);
+        char expected[64];
+        for (int i = 0; i < 100000; i++) {
+            // Exactly representable, so printf and the fixed point rounding agree
+            const double value = std::round(values(random) * 64) / 64;
+            snprintf(expected, sizeof(expected), "%.6f", value);
+            CHECK_STRING(mqttPayload::number(value, 6), expected);
+        }
+    }
+
+    void testJson()
+    {
+        CHECK_STRING(mqttPayload::json({}), "{}");
+        CHECK_STRING(mqttPayload::json({{"temperature", 21.5}, {"door", "open"}, {"count", 3},
+            {"big", 4000000000ul}, {"low", false}, {"none", static_cast<const char*>(nullptr)}}),
+            "{\"temperature\":21.50,\"door\":\"open\",\"count\":3,\"big\":4000000000,\"low\":false,\"none\":null}");
+        CHECK_STRING(mqttPayload::json({{"q\"\\", "a\nb\x01"}}), "{\"q\\\"\\\\\":\"a\\u000ab\\u0001\"}");
+        // JSON has neither NaN nor infinity
+        CHECK_STRING(mqttPayload::json({{"nan", NAN}, {"huge", 1e20, 0}}), "{\"nan\":null,\"huge\":null}");
+        CHECK_STRING(mqttPayload::json({{"v", 1.23456, 3}}), "{\"v\":1.235}");
+    }
+
+    void testRuntimeFields()
+    {
+        std::array<mqttPayload::JsonField, 4> fields;
+        // Default fields are valid as they are
+        CHECK_STRING(mqttPayload::json(fields.data(), 1), "{\"\":0}");
+        CHECK_STRING(mqttPayload::json(fields.data(), 0), "{}");
+
+        const std::string names[] = {"loop", "mqtt", "web"};
+        const uint32_t stacks[] = {812, 1460, 3012};
+        for (size_t i = 0; i < 3; i++) {
+            fields[i] = {names[i].c_str(), stacks[i]};
+        }
+        CHECK_STRING(mqttPayload::json(fields.data(), 3), "{\"loop\":812,\"mqtt\":1460,\"web\":3012}");
+        CHECK_STRING(mqttPayload::json(fields.data(), 2), "{\"loop\":812,\"mqtt\":1460}");
+    }
+
+    void testOverflow()
+    {
+        const std::string fits(mqttPayload::bufferSize - 9, 'x');
+        CHECK(mqttPayload::json({{"k", fits.c_str()}}) != nullptr);
+        CHECK_EQUAL(strlen(mqttPayload::json({{"k", fits.c_str()}})), mqttPayload::bufferSize - 1);
+        const std::string large(mqttPayload::bufferSize - 8, 'x');
+        CHECK(mqttPayload::json({{"k", large.c_str()}}) == nullptr);
+        // The buffer is fine for the next payload
+        CHECK_STRING(mqttPayload::integer(7), "7");
+    }
+
+    void testTaskBuffers()
+    {
+        const char* mine = mqttPayload::integer(1);
+        const char* other = nullptr;
+        std::thread thread([&other]() {
+            other = mqttPayload::integer(2);
+        });
+        thread.join();
+        // Each task writes into a buffer of its own
+        CHECK(mine != other);
+        CHECK_STRING(mine, "1");
+        CHECK(mqttPayload::taskBuffer() == mine);
+    }
+}
+
+int main()
+{
+    testInteger();
+    testNumber();
+    testJson();
+    testRuntimeFields();
+    testOverflow();
+    testTaskBuffers();
+    return check::result();
+}
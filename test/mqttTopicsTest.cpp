@@ -0,0 +1,84 @@
+// MqttTopicRegistry expansion and its limits
+
+#include "mqttTopics.hpp"
+#include "check.hpp"
+
+#include <string>
+
+namespace {
+    void testExpansion()
+    {
+        MqttTopicRegistry topics;
+        const auto status = topics.add("stat/{hostname}/status");
+        const auto fixed = topics.add("broadcast");
+        // Not resolved before the hostname is known
+        CHECK(topics.get(status) == nullptr);
+        CHECK(topics[fixed] == nullptr);
+
+        topics.setHostname("door");
+        const auto twice = topics.add("{hostname}/{hostname}");
+        CHECK_STRING(topics[status], "stat/door/status");
+        CHECK_STRING(topics[fixed], "broadcast");
+        CHECK_STRING(topics[twice], "door/door");
+        CHECK_EQUAL(topics.size(), 3u);
+
+        // Expanded again, not appended
+        topics.setHostname("window-sensor");
+        CHECK_STRING(topics[status], "stat/window-sensor/status");
+        CHECK_STRING(topics[twice], "window-sensor/window-sensor");
+        for (int i = 0; i < 100; i++) {
+            topics.setHostname("x");
+        }
+        CHECK_STRING(topics[status], "stat/x/status");
+    }
+
+    void testUnknown()
+    {
+        MqttTopicRegistry topics;
+        topics.setHostname("h");
+        CHECK(topics.get(0) == nullptr);
+        CHECK(topics.get(MqttTopicRegistry::invalidTopic) == nullptr);
+        CHECK_EQUAL(topics.add(nullptr), MqttTopicRegistry::invalidTopic);
+    }
+
+    void testLimits()
+    {
+        MqttTopicRegistry topics;
+        for (size_t i = 0; i < MqttTopicRegistry::maxTopics; i++) {
+            CHECK_EQUAL(topics.add("t/{hostname}"), i);
+        }
+        CHECK_EQUAL(topics.add("one/too/many"), MqttTopicRegistry::invalidTopic);
+
+        // 32 topics of 2 + 30 + 1 bytes do not fit next to the hostname, the last ones stay unresolved
+        const std::string hostname(30, 'h');
+        topics.setHostname(hostname.c_str());
+        const std::string expected = "t/" + hostname;
+        size_t resolved = 0;
+        for (size_t i = 0; i < MqttTopicRegistry::maxTopics; i++) {
+            const char* topic = topics[static_cast<MqttTopicRegistry::TopicId>(i)];
+            if (topic == nullptr) {
+                continue;
+            }
+            CHECK_STRING(topic, expected.c_str());
+            resolved++;
+        }
+        CHECK_EQUAL(resolved, (MqttTopicRegistry::arenaSize - hostname.size() - 1) / (expected.size() + 1));
+
+        // A shorter hostname makes space again
+        topics.setHostname("h");
+        CHECK_STRING(topics[MqttTopicRegistry::maxTopics - 1], "t/h");
+
+        // Too long to be kept at all
+        const std::string huge(MqttTopicRegistry::arenaSize, 'h');
+        topics.setHostname(huge.c_str());
+        CHECK(topics[0] == nullptr);
+    }
+}
+
+int main()
+{
+    testExpansion();
+    testUnknown();
+    testLimits();
+    return check::result();
+}
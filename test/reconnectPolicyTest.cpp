@@ -0,0 +1,195 @@
+// ReconnectPolicy driven by a virtual clock and a scripted random source
+
+#include "reconnectPolicy.hpp"
+#include "check.hpp"
+
+#include <vector>
+
+namespace {
+    struct VirtualClock {
+        uint32_t now = 0;
+
+        void advance(uint32_t ms)
+        {
+            now += ms;
+        }
+    };
+
+    ReconnectPolicy::Settings makeSettings(uint32_t baseDelay, uint32_t maxDelay, float multiplier, uint32_t stablePeriod)
+    {
+        ReconnectPolicy::Settings settings;
+        settings.baseDelay = baseDelay;
+        settings.maxDelay = maxDelay;
+        settings.multiplier = multiplier;
+        settings.stablePeriod = stablePeriod;
+        return settings;
+    }
+
+    void testCeilingGrowth()
+    {
+        VirtualClock clock;
+        // The largest possible random number always gives the ceiling itself
+        ReconnectPolicy policy(makeSettings(1000, 60000, 2.0f, 30000), [] { return UINT32_MAX - 1; });
+
+        CHECK_EQUAL(policy.getCurrentCeiling(), 1000u);
+        const std::vector<uint32_t> expected = {1000, 2000, 4000, 8000, 16000, 32000, 60000, 60000, 60000};
+        for (size_t i = 0; i < expected.size(); i++) {
+            CHECK_EQUAL(policy.getCurrentCeiling(), expected[i]);
+            const uint32_t delay = policy.nextDelay(clock.now);
+            CHECK(delay <= expected[i]);
+            CHECK_EQUAL(policy.getAttempts(), i + 1);
+            clock.advance(delay);
+        }
+    }
+
+    void testMaxClamp()
+    {
+        VirtualClock clock;
+        // The base delay above the maximum is clamped right away
+        ReconnectPolicy policy(makeSettings(5000, 3000, 3.0f, 1000), [] { return 3000u; });
+        CHECK_EQUAL(policy.getCurrentCeiling(), 3000u);
+        CHECK_EQUAL(policy.nextDelay(clock.now), 3000u);
+        CHECK_EQUAL(policy.getCurrentCeiling(), 3000u);
+
+        // No overflow with the largest possible maximum
+        ReconnectPolicy huge(makeSettings(UINT32_MAX / 2, UINT32_MAX, 10.0f, 1000), [] { return UINT32_MAX; });
+        CHECK_EQUAL(huge.nextDelay(clock.now), UINT32_MAX / 2);
+        CHECK_EQUAL(huge.getCurrentCeiling(), UINT32_MAX);
+        CHECK_EQUAL(huge.nextDelay(clock.now), UINT32_MAX);
+        CHECK_EQUAL(huge.getCurrentCeiling(), UINT32_MAX);
+    }
+
+    void testConstantMultiplier()
+    {
+        VirtualClock clock;
+        unsigned draws = 0;
+        ReconnectPolicy policy(makeSettings(1000, 60000, 1.0f, 30000), [&draws] {
+            draws++;
+            return 0u;
+        });
+
+        // The ceiling is kept between attempts instead of being recomputed from the attempt count,
+        // so it stays exact however many attempts there have been
+        for (unsigned i = 0; i < 1000000; i++) {
+            clock.advance(1000);
+            policy.nextDelay(clock.now);
+            CHECK_EQUAL(policy.getCurrentCeiling(), 1000u);
+        }
+        CHECK_EQUAL(policy.getAttempts(), 1000000u);
+        // One random draw per attempt, nothing else
+        CHECK_EQUAL(draws, 1000000u);
+
+        // A shrinking multiplier counts as 1
+        ReconnectPolicy shrinking(makeSettings(1000, 60000, 0.5f, 30000), [] { return 0u; });
+        shrinking.nextDelay(clock.now);
+        shrinking.nextDelay(clock.now);
+        CHECK_EQUAL(shrinking.getCurrentCeiling(), 1000u);
+    }
+
+    void testJitterBounds()
+    {
+        VirtualClock clock;
+        uint32_t state = 12345;
+        ReconnectPolicy policy(makeSettings(100, 1600, 2.0f, 30000), [&state] {
+            state = state * 1664525 + 1013904223;
+            return state;
+        });
+
+        // Full jitter: every value from 0 up to the ceiling is possible, nothing above
+        for (int attempt = 0; attempt < 6; attempt++) {
+            policy.setSettings(makeSettings(100, 1600, 2.0f, 30000));
+            for (int i = 0; i < attempt; i++) {
+                policy.nextDelay(clock.now);
+            }
+            const uint32_t ceiling = policy.getCurrentCeiling();
+            uint32_t minimum = UINT32_MAX;
+            uint32_t maximum = 0;
+            for (int sample = 0; sample < 20000; sample++) {
+                policy.setSettings(makeSettings(100, 1600, 2.0f, 30000));
+                for (int i = 0; i < attempt; i++) {
+                    policy.nextDelay(clock.now);
+                }
+                const uint32_t delay = policy.nextDelay(clock.now);
+                minimum = std::min(minimum, delay);
+                maximum = std::max(maximum, delay);
+            }
+            CHECK_EQUAL(minimum, 0u);
+            CHECK_EQUAL(maximum, ceiling);
+        }
+
+        // Without a random source std::rand() is used, the bounds are the same
+        ReconnectPolicy standard(makeSettings(10, 10, 2.0f, 30000));
+        for (int sample = 0; sample < 1000; sample++) {
+            CHECK(standard.nextDelay(clock.now) <= 10);
+        }
+    }
+
+    void testStablePeriod()
+    {
+        VirtualClock clock;
+        ReconnectPolicy policy(makeSettings(1000, 60000, 2.0f, 30000), [] { return 0u; });
+        for (int i = 0; i < 4; i++) {
+            policy.nextDelay(clock.now);
+        }
+        CHECK_EQUAL(policy.getCurrentCeiling(), 16000u);
+
+        // Flapping: connected, but lost again before the stable period is over
+        policy.connected(clock.now);
+        clock.advance(29999);
+        policy.nextDelay(clock.now);
+        CHECK_EQUAL(policy.getAttempts(), 5u);
+        CHECK_EQUAL(policy.getCurrentCeiling(), 32000u);
+
+        // Connected is only taken into account until the next loss
+        clock.advance(60000);
+        policy.nextDelay(clock.now);
+        CHECK_EQUAL(policy.getAttempts(), 6u);
+
+        // Stable long enough: back to the base delay
+        policy.connected(clock.now);
+        clock.advance(30000);
+        CHECK_EQUAL(policy.getCurrentCeiling(), 60000u);
+        policy.nextDelay(clock.now);
+        CHECK_EQUAL(policy.getAttempts(), 1u);
+        CHECK_EQUAL(policy.getCurrentCeiling(), 2000u);
+
+        // Across the wrap-around of the clock
+        clock.now = UINT32_MAX - 10000;
+        policy.nextDelay(clock.now);
+        policy.connected(clock.now);
+        clock.advance(20000);
+        policy.nextDelay(clock.now);
+        CHECK_EQUAL(policy.getAttempts(), 3u);
+        policy.connected(clock.now);
+        clock.advance(30000);
+        policy.nextDelay(clock.now);
+        CHECK_EQUAL(policy.getAttempts(), 1u);
+    }
+
+    void testSetSettings()
+    {
+        VirtualClock clock;
+        ReconnectPolicy policy(makeSettings(1000, 60000, 2.0f, 30000), [] { return 0u; });
+        policy.nextDelay(clock.now);
+        policy.nextDelay(clock.now);
+        CHECK_EQUAL(policy.getCurrentCeiling(), 4000u);
+
+        policy.setSettings(makeSettings(500, 1000, 3.0f, 100));
+        CHECK_EQUAL(policy.getAttempts(), 0u);
+        CHECK_EQUAL(policy.getCurrentCeiling(), 500u);
+        CHECK_EQUAL(policy.getSettings().stablePeriod, 100u);
+        policy.nextDelay(clock.now);
+        CHECK_EQUAL(policy.getCurrentCeiling(), 1000u);
+    }
+}
+
+int main()
+{
+    testCeilingGrowth();
+    testMaxClamp();
+    testConstantMultiplier();
+    testJitterBounds();
+    testStablePeriod();
+    testSetSettings();
+    return check::result();
+}
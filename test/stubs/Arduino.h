@@ -0,0 +1,108 @@
+// Minimal stand-in for the Arduino core, just enough to build the portable parts of Basecamp on the host
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <cctype>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+class String {
+    public:
+        String() = default;
+        String(const char *text) : text_((text != nullptr) ? text : "") {}
+        String(const std::string &text) : text_(text) {}
+        explicit String(char c) : text_(1, c) {}
+        explicit String(int value) : text_(std::to_string(value)) {}
+        explicit String(unsigned value) : text_(std::to_string(value)) {}
+        explicit String(long value) : text_(std::to_string(value)) {}
+        explicit String(unsigned long value) : text_(std::to_string(value)) {}
+
+        const char* c_str() const { return text_.c_str(); }
+        unsigned length() const { return static_cast<unsigned>(text_.size()); }
+        void reserve(unsigned size) { text_.reserve(size); }
+        char operator[](unsigned index) const { return text_[index]; }
+
+        bool operator==(const String &other) const { return text_ == other.text_; }
+        bool operator!=(const String &other) const { return text_ != other.text_; }
+        bool operator==(const char *other) const { return text_ == other; }
+        bool operator!=(const char *other) const { return text_ != other; }
+        bool operator<(const String &other) const { return text_ < other.text_; }
+
+        String& operator+=(const String &other) { text_ += other.text_; return *this; }
+        String& operator+=(const char *other) { text_ += other; return *this; }
+        String& operator+=(char c) { text_ += c; return *this; }
+        friend String operator+(const String &a, const String &b) { return String(a.text_ + b.text_); }
+        friend String operator+(const String &a, const char *b) { return String(a.text_ + b); }
+        friend String operator+(const char *a, const String &b) { return String(a + b.text_); }
+
+        bool equalsIgnoreCase(const String &other) const
+        {
+            if (text_.size() != other.text_.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < text_.size(); i++) {
+                if (tolower(text_[i]) != tolower(other.text_[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        bool startsWith(const String &prefix) const { return text_.compare(0, prefix.text_.size(), prefix.text_) == 0; }
+        bool endsWith(const String &suffix) const
+        {
+            return text_.size() >= suffix.text_.size() &&
+                text_.compare(text_.size() - suffix.text_.size(), suffix.text_.size(), suffix.text_) == 0;
+        }
+        int indexOf(char c, unsigned from = 0) const
+        {
+            const auto position = text_.find(c, from);
+            return (position == std::string::npos) ? -1 : static_cast<int>(position);
+        }
+        String substring(unsigned from) const { return String(text_.substr(from)); }
+        String substring(unsigned from, unsigned to) const { return String(text_.substr(from, to - from)); }
+        long toInt() const { return atol(text_.c_str()); }
+        float toFloat() const { return static_cast<float>(atof(text_.c_str())); }
+
+    private:
+        std::string text_;
+};
+
+// RTC memory is plain memory on the host, a test run is one wake
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+
+// The host clock of the tests, only advanced by the tests themselves
+extern unsigned long hostMillis;
+
+inline unsigned long millis()
+{
+    return hostMillis;
+}
+
+inline void delay(unsigned long ms)
+{
+    hostMillis += ms;
+}
+
+struct HostSerial {
+    void print(const char *text) { fputs(text, stdout); }
+    void print(const String &text) { fputs(text.c_str(), stdout); }
+    void println(const char *text = "") { puts(text); }
+    void println(const String &text) { puts(text.c_str()); }
+    void printf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        va_list arguments;
+        va_start(arguments, format);
+        vprintf(format, arguments);
+        va_end(arguments);
+    }
+};
+
+extern HostSerial Serial;
+
+#endif
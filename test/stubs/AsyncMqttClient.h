@@ -0,0 +1,160 @@
+// Stand-in for the MQTT client, the tests connect, acknowledge and disconnect it by hand
+
+#ifndef HOST_ASYNC_MQTT_CLIENT_H
+#define HOST_ASYNC_MQTT_CLIENT_H
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+enum class AsyncMqttClientDisconnectReason : int8_t {
+    TCP_DISCONNECTED = 0,
+};
+
+struct AsyncMqttClientMessageProperties {
+    uint8_t qos;
+    bool dup;
+    bool retain;
+};
+
+namespace AsyncMqttClientInternals {
+    typedef std::function<void(bool sessionPresent)> OnConnectUserCallback;
+    typedef std::function<void(AsyncMqttClientDisconnectReason reason)> OnDisconnectUserCallback;
+    typedef std::function<void(uint16_t packetId)> OnPublishUserCallback;
+    typedef std::function<void(char *topic, char *payload, AsyncMqttClientMessageProperties properties,
+        size_t length, size_t index, size_t total)> OnMessageUserCallback;
+}
+
+class AsyncMqttClient {
+    public:
+        struct Published {
+            std::string topic;
+            std::string payload;
+            uint8_t qos;
+            bool retain;
+            uint16_t packetId;
+        };
+
+        struct Subscription {
+            std::string filter;
+            // -1 for an unsubscribe
+            int qos;
+        };
+
+        AsyncMqttClient& onConnect(AsyncMqttClientInternals::OnConnectUserCallback callback)
+        {
+            connectCallbacks_.push_back(callback);
+            return *this;
+        }
+
+        AsyncMqttClient& onDisconnect(AsyncMqttClientInternals::OnDisconnectUserCallback callback)
+        {
+            disconnectCallbacks_.push_back(callback);
+            return *this;
+        }
+
+        AsyncMqttClient& onPublish(AsyncMqttClientInternals::OnPublishUserCallback callback)
+        {
+            publishCallbacks_.push_back(callback);
+            return *this;
+        }
+
+        AsyncMqttClient& onMessage(AsyncMqttClientInternals::OnMessageUserCallback callback)
+        {
+            messageCallbacks_.push_back(callback);
+            return *this;
+        }
+
+        bool connected() const { return connected_; }
+
+        uint16_t subscribe(const char *filter, uint8_t qos)
+        {
+            subscriptions.push_back(Subscription{filter, qos});
+            return nextPacketId_++;
+        }
+
+        uint16_t unsubscribe(const char *filter)
+        {
+            subscriptions.push_back(Subscription{filter, -1});
+            return nextPacketId_++;
+        }
+
+        // Returns 0 while disconnected or full, 1 for QoS 0 messages like the real client
+        uint16_t publish(const char *topic, uint8_t qos, bool retain, const char *payload = nullptr,
+            size_t length = 0, bool /*dup*/ = false, uint16_t /*messageId*/ = 0)
+        {
+            if (!connected_ || full) {
+                return 0;
+            }
+            if (payload != nullptr && length == 0) {
+                length = strlen(payload);
+            }
+            const uint16_t packetId = (qos == 0) ? 1 : nextPacketId_++;
+            published.push_back(Published{topic, std::string(payload, payload + length), qos, retain, packetId});
+            return packetId;
+        }
+
+        void connect(bool sessionPresent = false)
+        {
+            connected_ = true;
+            for (const auto &callback : connectCallbacks_) {
+                callback(sessionPresent);
+            }
+        }
+
+        void disconnect()
+        {
+            connected_ = false;
+            for (const auto &callback : disconnectCallbacks_) {
+                callback(AsyncMqttClientDisconnectReason::TCP_DISCONNECTED);
+            }
+        }
+
+        // The broker acknowledges "packetId"
+        void acknowledge(uint16_t packetId)
+        {
+            for (const auto &callback : publishCallbacks_) {
+                callback(packetId);
+            }
+        }
+
+        // The broker delivers a message in fragments of at most "fragment" bytes
+        void deliver(const char *topic, const std::string &payload, size_t fragment = SIZE_MAX)
+        {
+            size_t index = 0;
+            do {
+                const size_t length = std::min(fragment, payload.size() - index);
+                deliverFragment(topic, payload.substr(index, length), index, payload.size());
+                index += length;
+            } while (index < payload.size());
+        }
+
+        // A single fragment at "index" of a message of "total" bytes
+        void deliverFragment(const char *topic, std::string fragment, size_t index, size_t total)
+        {
+            std::string topicBuffer(topic);
+            for (const auto &callback : messageCallbacks_) {
+                callback(&topicBuffer[0], &fragment[0], AsyncMqttClientMessageProperties{0, false, false},
+                    fragment.size(), index, total);
+            }
+        }
+
+        std::vector<Published> published;
+        std::vector<Subscription> subscriptions;
+        // No space in the TCP window
+        bool full = false;
+
+    private:
+        std::vector<AsyncMqttClientInternals::OnConnectUserCallback> connectCallbacks_;
+        std::vector<AsyncMqttClientInternals::OnDisconnectUserCallback> disconnectCallbacks_;
+        std::vector<AsyncMqttClientInternals::OnPublishUserCallback> publishCallbacks_;
+        std::vector<AsyncMqttClientInternals::OnMessageUserCallback> messageCallbacks_;
+        bool connected_ = false;
+        uint16_t nextPacketId_ = 1;
+};
+
+#endif
@@ -0,0 +1,89 @@
+// In-memory file system with the part of the Arduino FS API Basecamp uses
+
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include <Arduino.h>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace fs {
+    struct HostFiles {
+        std::map<std::string, std::string> files;
+        // Bytes which can still be written before writes start to fail
+        size_t space = SIZE_MAX;
+    };
+
+    class File {
+        public:
+            File() = default;
+            File(HostFiles *files, const std::string &name) : files_(files), name_(name) {}
+
+            explicit operator bool() const { return files_ != nullptr; }
+
+            size_t read(uint8_t *buffer, size_t length)
+            {
+                const std::string &data = files_->files[name_];
+                const size_t count = std::min(length, (position_ < data.size()) ? data.size() - position_ : 0);
+                memcpy(buffer, data.data() + position_, count);
+                position_ += count;
+                return count;
+            }
+
+            size_t write(const uint8_t *data, size_t length)
+            {
+                length = std::min(length, files_->space);
+                if (files_->space != SIZE_MAX) {
+                    files_->space -= length;
+                }
+                files_->files[name_].append(reinterpret_cast<const char *>(data), length);
+                return length;
+            }
+
+            bool seek(size_t position)
+            {
+                if (position > size()) {
+                    return false;
+                }
+                position_ = position;
+                return true;
+            }
+
+            size_t position() const { return position_; }
+            size_t size() const { return files_->files[name_].size(); }
+            bool isDirectory() const { return false; }
+            void close() { files_ = nullptr; }
+
+        private:
+            HostFiles *files_ = nullptr;
+            std::string name_;
+            size_t position_ = 0;
+    };
+
+    class FS {
+        public:
+            File open(const String &path, const char *mode = "r")
+            {
+                const std::string name = path.c_str();
+                if (mode[0] == 'r' && host.files.count(name) == 0) {
+                    return {};
+                }
+                if (mode[0] == 'w') {
+                    host.files[name].clear();
+                }
+                host.files[name];
+                return {&host, name};
+            }
+
+            bool exists(const String &path) const { return host.files.count(path.c_str()) != 0; }
+            bool remove(const String &path) { return host.files.erase(path.c_str()) != 0; }
+
+            HostFiles host;
+    };
+}
+
+using fs::File;
+
+#endif
@@ -0,0 +1,121 @@
+// MD5Builder of the Arduino core with a plain RFC 1321 implementation
+
+#ifndef HOST_MD5BUILDER_H
+#define HOST_MD5BUILDER_H
+
+#include <Arduino.h>
+#include <cstdint>
+#include <cstring>
+
+class MD5Builder {
+    public:
+        void begin()
+        {
+            state_[0] = 0x67452301;
+            state_[1] = 0xefcdab89;
+            state_[2] = 0x98badcfe;
+            state_[3] = 0x10325476;
+            length_ = 0;
+        }
+
+        void add(uint8_t *data, uint16_t length)
+        {
+            for (uint16_t i = 0; i < length; i++) {
+                block_[length_ % 64] = data[i];
+                length_++;
+                if (length_ % 64 == 0) {
+                    transform(block_);
+                }
+            }
+        }
+
+        void calculate()
+        {
+            const uint64_t bits = length_ * 8;
+            uint8_t padding = 0x80;
+            add(&padding, 1);
+            padding = 0;
+            while (length_ % 64 != 56) {
+                add(&padding, 1);
+            }
+            uint8_t size[8];
+            for (int i = 0; i < 8; i++) {
+                size[i] = static_cast<uint8_t>(bits >> (8 * i));
+            }
+            add(size, sizeof(size));
+            for (int i = 0; i < 16; i++) {
+                digest_[i] = static_cast<uint8_t>(state_[i / 4] >> (8 * (i % 4)));
+            }
+        }
+
+        String toString() const
+        {
+            char hex[33];
+            for (int i = 0; i < 16; i++) {
+                snprintf(hex + 2 * i, 3, "%02x", digest_[i]);
+            }
+            return hex;
+        }
+
+    private:
+        static uint32_t rotate(uint32_t value, int bits)
+        {
+            return (value << bits) | (value >> (32 - bits));
+        }
+
+        void transform(const uint8_t *block)
+        {
+            static const uint32_t k[64] = {
+                0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+                0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+                0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+                0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+                0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+                0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+                0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+                0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+            };
+            static const int shifts[16] = {7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21};
+
+            uint32_t words[16];
+            for (int i = 0; i < 16; i++) {
+                words[i] = block[4 * i] | (block[4 * i + 1] << 8) | (block[4 * i + 2] << 16) |
+                    (static_cast<uint32_t>(block[4 * i + 3]) << 24);
+            }
+
+            uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+            for (int i = 0; i < 64; i++) {
+                uint32_t f;
+                int g;
+                if (i < 16) {
+                    f = (b & c) | (~b & d);
+                    g = i;
+                } else if (i < 32) {
+                    f = (d & b) | (~d & c);
+                    g = (5 * i + 1) % 16;
+                } else if (i < 48) {
+                    f = b ^ c ^ d;
+                    g = (3 * i + 5) % 16;
+                } else {
+                    f = c ^ (b | ~d);
+                    g = (7 * i) % 16;
+                }
+                const uint32_t next = d;
+                d = c;
+                c = b;
+                b = b + rotate(a + f + k[i] + words[g], shifts[(i / 16) * 4 + i % 4]);
+                a = next;
+            }
+            state_[0] += a;
+            state_[1] += b;
+            state_[2] += c;
+            state_[3] += d;
+        }
+
+        uint32_t state_[4] = {};
+        uint64_t length_ = 0;
+        uint8_t block_[64] = {};
+        uint8_t digest_[16] = {};
+};
+
+#endif
@@ -0,0 +1,22 @@
+// UpdateFirmwareWriter is not tested on the host, this only satisfies the compiler
+
+#ifndef HOST_UPDATE_H
+#define HOST_UPDATE_H
+
+#include <Arduino.h>
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+#define U_FLASH 0
+
+struct HostUpdate {
+    bool begin(size_t, int) { return false; }
+    size_t write(uint8_t *, size_t) { return 0; }
+    bool setMD5(const char *) { return false; }
+    bool end(bool) { return false; }
+    void abort() {}
+    String errorString() { return "No flash on the host"; }
+};
+
+static HostUpdate Update;
+
+#endif
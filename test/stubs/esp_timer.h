@@ -0,0 +1,15 @@
+// The microsecond clock since reset, set by the tests
+
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <cstdint>
+
+extern int64_t hostMicros;
+
+inline int64_t esp_timer_get_time()
+{
+    return hostMicros;
+}
+
+#endif
@@ -0,0 +1,14 @@
+// The CRC of the ROM, chained like zlib's
+
+#ifndef HOST_ROM_CRC_H
+#define HOST_ROM_CRC_H
+
+#include <cstdint>
+#include <zlib.h>
+
+inline uint32_t crc32_le(uint32_t crc, const uint8_t *buffer, uint32_t length)
+{
+    return static_cast<uint32_t>(crc32(crc, buffer, length));
+}
+
+#endif
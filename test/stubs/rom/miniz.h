@@ -0,0 +1,75 @@
+// The tinfl subset used by GzipFirmwareWriter, backed by zlib
+
+#ifndef HOST_MINIZ_H
+#define HOST_MINIZ_H
+
+#include <cstddef>
+#include <cstring>
+#include <zlib.h>
+
+#define TINFL_LZ_DICT_SIZE 32768
+#define TINFL_FLAG_HAS_MORE_INPUT 2
+
+typedef enum {
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2,
+} tinfl_status;
+
+// The ROM decompressor is released with free(), so zlib has to allocate from a fixed arena inside of it
+struct tinfl_decompressor {
+    z_stream stream;
+    unsigned char arena[64 * 1024];
+    size_t used;
+};
+
+inline voidpf tinflArenaAlloc(voidpf opaque, uInt items, uInt size)
+{
+    auto *decompressor = static_cast<tinfl_decompressor *>(opaque);
+    const size_t length = (static_cast<size_t>(items) * size + 15) & ~static_cast<size_t>(15);
+    if (decompressor->used + length > sizeof(decompressor->arena)) {
+        return Z_NULL;
+    }
+    voidpf block = decompressor->arena + decompressor->used;
+    decompressor->used += length;
+    return block;
+}
+
+inline void tinflArenaFree(voidpf, voidpf)
+{
+}
+
+inline void tinfl_init(tinfl_decompressor *decompressor)
+{
+    memset(&decompressor->stream, 0, sizeof(decompressor->stream));
+    decompressor->used = 0;
+    decompressor->stream.zalloc = tinflArenaAlloc;
+    decompressor->stream.zfree = tinflArenaFree;
+    decompressor->stream.opaque = decompressor;
+    inflateInit2(&decompressor->stream, -15);
+}
+
+// Unlike tinfl, zlib keeps its own window, so "outStart" is not needed
+inline tinfl_status tinfl_decompress(tinfl_decompressor *decompressor, const unsigned char *in, size_t *inSize,
+    unsigned char * /*outStart*/, unsigned char *out, size_t *outSize, int /*flags*/)
+{
+    z_stream &stream = decompressor->stream;
+    stream.next_in = const_cast<Bytef *>(in);
+    stream.avail_in = static_cast<uInt>(*inSize);
+    stream.next_out = out;
+    stream.avail_out = static_cast<uInt>(*outSize);
+    const int result = inflate(&stream, Z_NO_FLUSH);
+    *inSize -= stream.avail_in;
+    *outSize -= stream.avail_out;
+
+    if (result == Z_STREAM_END) {
+        return TINFL_STATUS_DONE;
+    }
+    if (result != Z_OK && result != Z_BUF_ERROR) {
+        return TINFL_STATUS_FAILED;
+    }
+    return (stream.avail_out == 0) ? TINFL_STATUS_HAS_MORE_OUTPUT : TINFL_STATUS_NEEDS_MORE_INPUT;
+}
+
+#endif
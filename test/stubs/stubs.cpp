@@ -0,0 +1,6 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+
+unsigned long hostMillis = 0;
+int64_t hostMicros = 0;
+HostSerial Serial;
@@ -0,0 +1,102 @@
+// TelemetryFilter: which records are published and the heartbeat of a quiet device
+
+#include "telemetryFilter.hpp"
+#include "check.hpp"
+
+namespace {
+    TelemetryRecord makeRecord()
+    {
+        TelemetryRecord record = {};
+        record.uptime = 60;
+        record.freeHeap = 150000;
+        record.minFreeHeap = 120000;
+        record.largestFreeBlock = 110000;
+        record.rssi = -60;
+        record.resetReason = 1;
+        record.minFreeStack = 800;
+        return record;
+    }
+
+    void testHasChanged()
+    {
+        const TelemetryRecord last = makeRecord();
+        CHECK(!TelemetryFilter::hasChanged(last, last));
+
+        // Always changing, never compared
+        TelemetryRecord record = last;
+        record.uptime += 3600;
+        record.mqtt.acknowledged += 100;
+        record.pendingPackets = 3;
+        CHECK(!TelemetryFilter::hasChanged(record, last));
+
+        // Thresholds in both directions
+        record = last;
+        record.freeHeap -= TelemetryFilter::heapThreshold - 1;
+        CHECK(!TelemetryFilter::hasChanged(record, last));
+        record.freeHeap -= 1;
+        CHECK(TelemetryFilter::hasChanged(record, last));
+        record = last;
+        record.largestFreeBlock += TelemetryFilter::heapThreshold;
+        CHECK(TelemetryFilter::hasChanged(record, last));
+        record = last;
+        record.rssi += TelemetryFilter::rssiThreshold - 1;
+        CHECK(!TelemetryFilter::hasChanged(record, last));
+        record.rssi = last.rssi - TelemetryFilter::rssiThreshold;
+        CHECK(TelemetryFilter::hasChanged(record, last));
+
+        // Counters count with every step
+        record = last;
+        record.mqttDisconnects++;
+        CHECK(TelemetryFilter::hasChanged(record, last));
+        record = last;
+        record.mqtt.timeouts++;
+        CHECK(TelemetryFilter::hasChanged(record, last));
+        record = last;
+        record.minFreeStack -= 4;
+        CHECK(TelemetryFilter::hasChanged(record, last));
+    }
+
+    void testHeartbeat()
+    {
+        TelemetryFilter filter;
+        TelemetryRecord record = makeRecord();
+        // Nothing to compare with yet
+        CHECK(filter.shouldPublish(record, false));
+        filter.published(record);
+
+        // A quiet device publishes every maxSuppressed + 1 records
+        for (int heartbeat = 0; heartbeat < 3; heartbeat++) {
+            for (uint32_t i = 0; i < TelemetryFilter::maxSuppressed; i++) {
+                record.uptime += 10;
+                CHECK(!filter.shouldPublish(record, false));
+                CHECK_EQUAL(filter.getSuppressed(), i + 1);
+            }
+            record.uptime += 10;
+            CHECK(filter.shouldPublish(record, false));
+            filter.published(record);
+            CHECK_EQUAL(filter.getSuppressed(), 0u);
+        }
+
+        // A change or force publishes right away
+        record.uptime += 10;
+        CHECK(!filter.shouldPublish(record, false));
+        record.wifiDisconnects++;
+        CHECK(filter.shouldPublish(record, false));
+        filter.published(record);
+        CHECK(filter.shouldPublish(record, true));
+
+        // Not published (e.g. MQTT was busy): still compared against the last published record
+        TelemetryRecord changed = record;
+        changed.resetReason = 5;
+        CHECK(filter.shouldPublish(changed, false));
+        CHECK(filter.shouldPublish(changed, false));
+        CHECK_EQUAL(filter.getSuppressed(), 0u);
+    }
+}
+
+int main()
+{
+    testHasChanged();
+    testHeartbeat();
+    return check::result();
+}
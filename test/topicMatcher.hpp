@@ -0,0 +1,54 @@
+#ifndef BASECAMP_TOPIC_MATCHER_HPP
+#define BASECAMP_TOPIC_MATCHER_HPP
+
+#include <string>
+#include <vector>
+
+/**
+  Topic filter matching straight from the MQTT specification, one level after the other.
+  The reference MqttDispatcher is checked against in mqttDispatcherTest and compared with in
+  mqttDispatcherBenchmark.
+*/
+namespace topicMatcher {
+    inline std::vector<std::string> split(const std::string& topic)
+    {
+        std::vector<std::string> levels;
+        size_t begin = 0;
+        for (;;) {
+            const size_t end = topic.find('/', begin);
+            levels.push_back(topic.substr(begin, end - begin));
+            if (end == std::string::npos) {
+                return levels;
+            }
+            begin = end + 1;
+        }
+    }
+
+    inline bool matches(const std::vector<std::string>& filterLevels, const std::vector<std::string>& topicLevels)
+    {
+        const bool system = (topicLevels[0][0] == '$');
+        for (size_t i = 0; i < filterLevels.size(); i++) {
+            if (filterLevels[i] == "#") {
+                return !(i == 0 && system);
+            }
+            if (i == topicLevels.size()) {
+                return false;
+            }
+            if (filterLevels[i] == "+") {
+                if (i == 0 && system) {
+                    return false;
+                }
+            } else if (filterLevels[i] != topicLevels[i]) {
+                return false;
+            }
+        }
+        return filterLevels.size() == topicLevels.size();
+    }
+
+    inline bool matches(const std::string& filter, const std::string& topic)
+    {
+        return matches(split(filter), split(topic));
+    }
+}
+
+#endif // BASECAMP_TOPIC_MATCHER_HPP
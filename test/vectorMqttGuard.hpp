@@ -0,0 +1,61 @@
+#ifndef BASECAMP_VECTOR_MQTT_GUARD_HPP
+#define BASECAMP_VECTOR_MQTT_GUARD_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+  MqttGuard as it was before the hash table, packet ids kept in a std::vector with linear search.
+  Only kept as the baseline of mqttGuardBenchmark, logging has been left out.
+*/
+class VectorMqttGuard
+{
+public:
+    using IdType = uint16_t;
+
+    void registerPacket(IdType packetId)
+    {
+        if (!isValidPacketId(packetId)) {
+            return;
+        }
+
+        packets_.emplace_back(packetId);
+    }
+
+    void unregisterPacket(IdType packetId)
+    {
+        auto found = std::find(packets_.begin(), packets_.end(), packetId);
+
+        if (found == packets_.end()) {
+            return;
+        }
+
+        packets_.erase(found);
+    }
+
+    size_t remainingPacketCount() const
+    {
+        return packets_.size();
+    }
+
+    bool allSent() const
+    {
+        return (remainingPacketCount() == 0);
+    }
+
+    void reset()
+    {
+        packets_.clear();
+    }
+
+private:
+    bool isValidPacketId(IdType packetId) const
+    {
+        return (packetId != 0 && std::find(packets_.begin(), packets_.end(), packetId) == packets_.end());
+    }
+
+    std::vector<IdType> packets_;
+};
+
+#endif // BASECAMP_VECTOR_MQTT_GUARD_HPP
@@ -0,0 +1,133 @@
+// WakeTimeline over several simulated wakes, RTC memory is plain memory on the host
+
+#include "WakeTimeline.hpp"
+#include "check.hpp"
+
+#include <esp_timer.h>
+
+namespace {
+    uint32_t at(const WakeTimeline::Record& record, WakePhase phase)
+    {
+        return record.us[static_cast<size_t>(phase)];
+    }
+
+    void testBeforeStart()
+    {
+        WakeTimeline timeline;
+        // Nothing recorded into memory which has not been initialized
+        timeline.mark(WakePhase::gotIp, 5);
+        CHECK_EQUAL(at(timeline.getCurrent(), WakePhase::gotIp), 0u);
+        CHECK_EQUAL(timeline.getWakes(), 0u);
+        CHECK_STRING(timeline.toJson().c_str(), "{\"current\":{},\"previous\":{},\"wakes\":0,\"statistics\":{}}");
+    }
+
+    void testFirstWake()
+    {
+        WakeTimeline timeline;
+        hostMicros = 0;
+        timeline.start();
+        // 0 means not reached, so the earliest time is 1
+        CHECK_EQUAL(at(timeline.getCurrent(), WakePhase::begin), 1u);
+
+        hostMicros = 1000;
+        timeline.mark(WakePhase::wifiConnected);
+        hostMicros = 1500;
+        timeline.mark(WakePhase::wifiConnected);
+        timeline.mark(WakePhase::gotIp, 1200);
+        timeline.mark(WakePhase::lastAck, 5000);
+        timeline.mark(WakePhase::lastAck, 7000);
+        // Clamped instead of wrapping
+        timeline.mark(WakePhase::firstPublish, int64_t(1) << 40);
+
+        const auto& current = timeline.getCurrent();
+        CHECK_EQUAL(at(current, WakePhase::wifiConnected), 1000u);
+        CHECK_EQUAL(at(current, WakePhase::gotIp), 1200u);
+        CHECK_EQUAL(at(current, WakePhase::mqttConnected), 0u);
+        CHECK_EQUAL(at(current, WakePhase::firstPublish), UINT32_MAX);
+        // The latest acknowledgement counts
+        CHECK_EQUAL(at(current, WakePhase::lastAck), 7000u);
+        // Only complete wakes are in the statistics
+        CHECK_EQUAL(timeline.getWakes(), 0u);
+        CHECK_EQUAL(timeline.getStatistics(WakePhase::gotIp).count, 0u);
+        CHECK_EQUAL(at(timeline.getPrevious(), WakePhase::begin), 0u);
+    }
+
+    void testStatistics()
+    {
+        WakeTimeline timeline;
+        // Finishes the wake of testFirstWake()
+        hostMicros = 10;
+        timeline.start();
+        CHECK_EQUAL(timeline.getWakes(), 1u);
+        CHECK_EQUAL(at(timeline.getPrevious(), WakePhase::gotIp), 1200u);
+        CHECK_EQUAL(at(timeline.getCurrent(), WakePhase::begin), 10u);
+        CHECK_EQUAL(at(timeline.getCurrent(), WakePhase::gotIp), 0u);
+
+        timeline.resetStatistics();
+        CHECK_EQUAL(timeline.getWakes(), 0u);
+        // The previous wake is kept
+        CHECK_EQUAL(at(timeline.getPrevious(), WakePhase::gotIp), 1200u);
+
+        // Three wakes, the last one without MQTT
+        const uint32_t gotIp[] = {300000, 100000, 200000};
+        for (int wake = 0; wake < 3; wake++) {
+            timeline.mark(WakePhase::gotIp, gotIp[wake]);
+            if (wake < 2) {
+                timeline.mark(WakePhase::mqttConnected, gotIp[wake] + 50000);
+            }
+            timeline.start();
+        }
+
+        CHECK_EQUAL(timeline.getWakes(), 3u);
+        const auto ip = timeline.getStatistics(WakePhase::gotIp);
+        CHECK_EQUAL(ip.count, 3u);
+        CHECK_EQUAL(ip.minUs, 100000u);
+        CHECK_EQUAL(ip.averageUs, 200000u);
+        CHECK_EQUAL(ip.maxUs, 300000u);
+        const auto mqtt = timeline.getStatistics(WakePhase::mqttConnected);
+        CHECK_EQUAL(mqtt.count, 2u);
+        CHECK_EQUAL(mqtt.minUs, 150000u);
+        CHECK_EQUAL(mqtt.averageUs, 250000u);
+        CHECK_EQUAL(mqtt.maxUs, 350000u);
+        CHECK_EQUAL(timeline.getStatistics(WakePhase::lastAck).count, 0u);
+
+        CHECK_STRING(timeline.toJson().c_str(),
+            "{\"current\":{\"begin\":10},\"previous\":{\"begin\":10,\"gotIp\":200000},\"wakes\":3,"
+            "\"statistics\":{\"begin\":{\"count\":3,\"min\":10,\"avg\":10,\"max\":10},"
+            "\"gotIp\":{\"count\":3,\"min\":100000,\"avg\":200000,\"max\":300000},"
+            "\"mqttConnected\":{\"count\":2,\"min\":150000,\"avg\":250000,\"max\":350000}}}");
+    }
+
+    void testLongRun()
+    {
+        WakeTimeline timeline;
+        timeline.resetStatistics();
+        // The sums do not overflow over many wakes near the limit
+        for (int wake = 0; wake < 10000; wake++) {
+            timeline.mark(WakePhase::lastAck, UINT32_MAX - 1);
+            timeline.start();
+        }
+        const auto ack = timeline.getStatistics(WakePhase::lastAck);
+        CHECK_EQUAL(ack.count, 10000u);
+        CHECK_EQUAL(ack.averageUs, UINT32_MAX - 1);
+    }
+
+    void testPhaseNames()
+    {
+        for (size_t i = 0; i < WakeTimeline::phaseCount; i++) {
+            CHECK(WakeTimeline::getPhaseName(static_cast<WakePhase>(i))[0] != '\0');
+        }
+        CHECK_STRING(WakeTimeline::getPhaseName(WakePhase::lastAck), "lastAck");
+    }
+}
+
+int main()
+{
+    // In order, each test continues the wakes of the one before
+    testBeforeStart();
+    testFirstWake();
+    testStatistics();
+    testLongRun();
+    testPhaseNames();
+    return check::result();
+}